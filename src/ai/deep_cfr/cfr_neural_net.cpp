@@ -1,5 +1,13 @@
 #include "cfr_neural_net.hpp"
+#include "weight_file.hpp"
+#include "util/trace.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 MLPImpl::MLPImpl(int input_size, int hidden_size, int output_size) {
     fc1 = register_module("fc1", torch::nn::Linear(input_size, hidden_size));
@@ -42,6 +50,7 @@ NeuralNet::NeuralNet(int input_size, int hidden_size, int output_size, float lea
 }
 
 std::vector<float> NeuralNet::predict(const std::vector<float>& features) {
+    TRACE_SCOPE("NeuralNet::predict");
     // Convert features to tensor
     torch::Tensor input = torch::tensor(features, torch::kFloat32).reshape({1, -1});
     
@@ -64,54 +73,271 @@ std::vector<float> NeuralNet::predict(const std::vector<float>& features) {
     return result;
 }
 
+std::vector<float> NeuralNet::predictBatch(const float* rows, int64_t num_rows) {
+    TRACE_SCOPE("NeuralNet::predictBatch");
+    std::vector<float> result(static_cast<size_t>(num_rows) * output_size);
+    if (num_rows == 0) return result;
+
+    // Wrap the caller's rows without copying; only a non-CPU device needs a transfer
+    torch::Tensor input = torch::from_blob(const_cast<float*>(rows), {num_rows, input_size}, torch::kFloat32);
+    input = input.to(model->parameters().begin()->device());
+
+    torch::NoGradGuard no_grad;
+    torch::Tensor output = model->forward(input).to(torch::kCPU).contiguous();
+    std::memcpy(result.data(), output.data_ptr<float>(), result.size() * sizeof(float));
+
+    return result;
+}
+
 float NeuralNet::train(const std::vector<std::vector<float>>& features_batch, 
                       const std::vector<std::vector<float>>& targets_batch,
                       int batch_size) {
+    TRACE_SCOPE("NeuralNet::train");
     // Get device
-    auto device = model->parameters().begin()->device();
+    auto device = this->device();
     
-    // Convert to tensors
-    std::vector<torch::Tensor> inputs;
-    std::vector<torch::Tensor> targets;
-    
-    for (size_t i = 0; i < features_batch.size(); i++) {
-        inputs.push_back(torch::tensor(features_batch[i], torch::kFloat32));
-        targets.push_back(torch::tensor(targets_batch[i], torch::kFloat32));
+    // Copy the rows straight into two contiguous host tensors rather than stacking per-sample tensors
+    const int64_t num_samples = static_cast<int64_t>(features_batch.size());
+    torch::Tensor inputs_tensor = stagingTensor(num_samples, input_size);
+    torch::Tensor targets_tensor = stagingTensor(num_samples, output_size);
+    float* input_rows = inputs_tensor.data_ptr<float>();
+    float* target_rows = targets_tensor.data_ptr<float>();
+    for (int64_t i = 0; i < num_samples; i++) {
+        std::memcpy(input_rows + i * input_size, features_batch[i].data(), input_size * sizeof(float));
+        std::memcpy(target_rows + i * output_size, targets_batch[i].data(), output_size * sizeof(float));
     }
     
-    torch::Tensor inputs_tensor = torch::stack(inputs);
-    torch::Tensor targets_tensor = torch::stack(targets);
-    
     // Move to device
     inputs_tensor = inputs_tensor.to(device);
     targets_tensor = targets_tensor.to(device);
+    torch::Tensor weights_tensor = torch::ones({num_samples}, torch::TensorOptions().device(device));
     
-    // Training loop
-    float total_loss = 0.0f;
+    // Training loop; unit weights make the weighted loss plain MSE
+    torch::Tensor total_loss = torch::zeros({}, torch::TensorOptions().device(device));
     int num_batches = (features_batch.size() + batch_size - 1) / batch_size;
     
     for (int i = 0; i < num_batches; i++) {
         // Get batch
         int start_idx = i * batch_size;
         int end_idx = std::min(start_idx + batch_size, static_cast<int>(features_batch.size()));
-        torch::Tensor batch_inputs = inputs_tensor.slice(0, start_idx, end_idx);
-        torch::Tensor batch_targets = targets_tensor.slice(0, start_idx, end_idx);
-        
-        // Forward pass
-        optimizer.zero_grad();
-        torch::Tensor outputs = model->forward(batch_inputs);
-        
-        // Compute loss (MSE)
-        torch::Tensor loss = torch::mse_loss(outputs, batch_targets);
-        
-        // Backward pass
-        loss.backward();
-        optimizer.step();
-        
-        total_loss += loss.item<float>();
+        total_loss.add_(step(inputs_tensor.slice(0, start_idx, end_idx),
+                             targets_tensor.slice(0, start_idx, end_idx),
+                             weights_tensor.slice(0, start_idx, end_idx)));
     }
     
-    return total_loss / num_batches;
+    return total_loss.item<float>() / num_batches;
+}
+
+float NeuralNet::train(const torch::Tensor& inputs, const torch::Tensor& targets) {
+    TRACE_SCOPE("NeuralNet::train");
+    auto device = model->parameters().begin()->device();
+
+    // Pinned host memory lets these copies overlap with compute
+    torch::Tensor batch_inputs = inputs.to(device, /*non_blocking=*/true);
+    torch::Tensor batch_targets = targets.to(device, /*non_blocking=*/true);
+
+    // Unit weights make the weighted loss plain MSE
+    torch::Tensor weights = torch::ones({batch_inputs.size(0)}, torch::TensorOptions().device(device));
+    return step(batch_inputs, batch_targets, weights).item<float>();
+}
+
+float NeuralNet::train(const torch::Tensor& inputs, const torch::Tensor& targets, const torch::Tensor& weights) {
+    TRACE_SCOPE("NeuralNet::train");
+    auto device = model->parameters().begin()->device();
+
+    torch::Tensor batch_inputs = inputs.to(device, /*non_blocking=*/true);
+    torch::Tensor batch_targets = targets.to(device, /*non_blocking=*/true);
+    torch::Tensor batch_weights = weights.reshape({-1}).to(device, /*non_blocking=*/true);
+
+    return step(batch_inputs, batch_targets, batch_weights).item<float>();
+}
+
+torch::Tensor NeuralNet::step(const torch::Tensor& inputs, const torch::Tensor& targets, const torch::Tensor& weights) {
+    TRACE_SCOPE("NeuralNet::step");
+    optimizer.zero_grad();
+    torch::Tensor outputs = model->forward(inputs);
+
+    // Normalizing by the weight sum keeps the step size independent of the iteration weight scale
+    torch::Tensor per_sample = (outputs - targets).pow(2).mean(1);
+    torch::Tensor loss = (per_sample * weights).sum() / weights.sum().clamp_min(1e-12);
+    loss.backward();
+    optimizer.step();
+
+    return loss.detach();
+}
+
+TrainStats NeuralNet::trainSteps(BatchSource& source, int batch_size, int steps) {
+    TRACE_SCOPE("NeuralNet::trainSteps");
+    if (source.featureSize() != static_cast<size_t>(input_size) ||
+        source.targetSize() != static_cast<size_t>(output_size)) {
+        throw std::invalid_argument("Batch source shape does not match the network");
+    }
+
+    // Two staging slots: the prefetch thread fills one while the other is training
+    struct Slot {
+        torch::Tensor features;
+        torch::Tensor targets;
+        torch::Tensor weights;
+        size_t rows = 0;
+        bool ready = false;
+    };
+    Slot slots[2];
+    for (auto& slot : slots) {
+        slot.features = stagingTensor(batch_size, input_size);
+        slot.targets = stagingTensor(batch_size, output_size);
+        slot.weights = stagingTensor(batch_size, 1);
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::exception_ptr error;
+
+    std::thread prefetcher([&]() {
+        for (int s = 0; s < steps; s++) {
+            Slot& slot = slots[s % 2];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return stopping || !slot.ready; });
+                if (stopping) return;
+            }
+
+            size_t rows = 0;
+            try {
+                rows = source.nextBatch(static_cast<size_t>(batch_size),
+                                        slot.features.data_ptr<float>(),
+                                        slot.targets.data_ptr<float>(),
+                                        slot.weights.data_ptr<float>());
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.rows = rows;
+                slot.ready = true;
+            }
+            cv.notify_all();
+            if (rows == 0) return;
+        }
+    });
+
+    auto stopPrefetcher = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        prefetcher.join();
+    };
+
+    auto device = this->device();
+    auto start = std::chrono::steady_clock::now();
+    torch::Tensor loss_sum = torch::zeros({}, torch::TensorOptions().device(device));
+    TrainStats stats{0.0f, 0, 0, 0.0};
+
+    try {
+        for (int s = 0; s < steps; s++) {
+            Slot& slot = slots[s % 2];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return slot.ready; });
+            }
+            if (slot.rows == 0) break;  // Source exhausted (or failed)
+
+            // Blocking copies let the slot be refilled once they return; on CPU the step reads it in place
+            const int64_t rows = static_cast<int64_t>(slot.rows);
+            loss_sum.add_(step(slot.features.narrow(0, 0, rows).to(device),
+                               slot.targets.narrow(0, 0, rows).to(device),
+                               slot.weights.narrow(0, 0, rows).reshape({-1}).to(device)));
+            stats.steps++;
+            stats.samples += slot.rows;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.ready = false;
+            }
+            cv.notify_all();
+        }
+    } catch (...) {
+        stopPrefetcher();
+        throw;
+    }
+    stopPrefetcher();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    stats.loss = stats.steps > 0 ? loss_sum.item<float>() / stats.steps : 0.0f;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+TrainStats NeuralNet::trainEpochs(const torch::Tensor& inputs, const torch::Tensor& targets,
+                                  const torch::Tensor& weights, int batch_size, int epochs) {
+    TRACE_SCOPE("NeuralNet::trainEpochs");
+    auto device = this->device();
+    auto start = std::chrono::steady_clock::now();
+
+    // One transfer for the whole dataset; minibatches are then gathered on the device
+    const int64_t num_samples = inputs.size(0);
+    torch::Tensor all_inputs = inputs.to(device);
+    torch::Tensor all_targets = targets.to(device);
+    torch::Tensor all_weights = weights.defined() ? weights.reshape({-1}).to(device)
+                                                  : torch::ones({num_samples}, torch::TensorOptions().device(device));
+
+    torch::Tensor loss_sum = torch::zeros({}, torch::TensorOptions().device(device));
+    TrainStats stats{0.0f, 0, 0, 0.0};
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        torch::Tensor order = torch::randperm(num_samples, torch::TensorOptions().dtype(torch::kLong).device(device));
+        for (int64_t begin = 0; begin < num_samples; begin += batch_size) {
+            torch::Tensor index = order.slice(0, begin, std::min<int64_t>(begin + batch_size, num_samples));
+            loss_sum.add_(step(all_inputs.index_select(0, index),
+                               all_targets.index_select(0, index),
+                               all_weights.index_select(0, index)));
+            stats.steps++;
+            stats.samples += static_cast<size_t>(index.size(0));
+        }
+    }
+
+    stats.loss = stats.steps > 0 ? loss_sum.item<float>() / stats.steps : 0.0f;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+torch::Tensor NeuralNet::stagingTensor(int64_t rows, int64_t cols) const {
+    auto options = torch::TensorOptions().dtype(torch::kFloat32);
+    if (model->parameters().begin()->device().is_cuda()) {
+        options = options.pinned_memory(true);
+    }
+    return torch::empty({rows, cols}, options);
+}
+
+std::vector<DenseLayer> NeuralNet::exportLayers() const {
+    // Parameters come back in registration order: fc1.weight, fc1.bias, fc2.weight, ...
+    std::vector<torch::Tensor> params = model->parameters();
+    std::vector<DenseLayer> layers;
+
+    torch::NoGradGuard no_grad;
+    for (size_t i = 0; i + 1 < params.size(); i += 2) {
+        torch::Tensor weight = params[i].detach().to(torch::kCPU).contiguous();
+        torch::Tensor bias = params[i + 1].detach().to(torch::kCPU).contiguous();
+
+        DenseLayer layer;
+        layer.output_size = static_cast<size_t>(weight.size(0));
+        layer.input_size = static_cast<size_t>(weight.size(1));
+        layer.weight.assign(weight.data_ptr<float>(), weight.data_ptr<float>() + weight.numel());
+        layer.bias.assign(bias.data_ptr<float>(), bias.data_ptr<float>() + bias.numel());
+        layers.push_back(std::move(layer));
+    }
+    return layers;
+}
+
+void NeuralNet::exportWeights(const std::string& path) const {
+    writeWeightFile(path, exportLayers());
 }
 
 void NeuralNet::save(const std::string& path) {
@@ -150,4 +376,13 @@ void NeuralNet::load(const std::string& path) {
     }
     
     model->to(device);
+}
+
+void NeuralNet::saveOptimizer(const std::string& path) {
+    torch::save(optimizer, path);
+}
+
+void NeuralNet::loadOptimizer(const std::string& path) {
+    // State tensors come back on the device they were saved from, which is the model's
+    torch::load(optimizer, path);
 } 
\ No newline at end of file
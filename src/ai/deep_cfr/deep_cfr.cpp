@@ -1,22 +1,86 @@
 #include "deep_cfr.hpp"
+#include "weight_file.hpp"
+#include "util/trace.hpp"
 #include <algorithm>
 #include <numeric>
 #include <iostream>
 #include <filesystem>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
 
-DeepCFR::DeepCFR(int num_players, int num_traversals, float alpha, int num_actions)
-    : strategy_buffer_(1000000),
-    rng_(std::random_device{}()),
+namespace {
+
+// fsync a file or directory, so a rename that follows cannot expose unwritten data
+void syncPath(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        int error = errno;
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error("Failed to sync '" + path.string() + "': " + std::strerror(error));
+    }
+    ::close(fd);
+}
+
+// LibTorch's default generators, which draw the minibatch shuffles of NeuralNet::trainEpochs;
+// the CUDA one only when a GPU is in use
+std::vector<std::pair<std::string, at::Generator>> torchGenerators() {
+    std::vector<std::pair<std::string, at::Generator>> generators = {
+        {"torch_rng_cpu.pt", at::globalContext().defaultGenerator(at::Device(at::kCPU))}};
+    if (torch::cuda::is_available()) {
+        generators.emplace_back("torch_rng_cuda.pt", at::globalContext().defaultGenerator(at::Device(at::kCUDA)));
+    }
+    return generators;
+}
+
+}  // namespace
+
+DeepCFR::DeepCFR(int num_players, int num_traversals, float alpha, int num_actions, ArenaPrecision buffer_precision)
+    : strategy_buffer_(std::make_unique<FeatureReservoirBuffer>(1000000, MAX_FEATURE_SIZE, num_actions, buffer_precision)),
+    seed_((static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}()),
+    completed_iterations_(0),
+    pipelined_(false),
+    concurrent_buffers_(false),
+    sample_sink_(nullptr),
     num_players_(num_players),
     num_traversals_(num_traversals),
-    alpha_(alpha) { // Initialize strategy_buffer with capacity
+    num_actions_(num_actions),
+    buffer_precision_(buffer_precision),
+    alpha_(alpha),
+    train_steps_(1),
+    traversal_scheme_(TraversalScheme::EXTERNAL),
+    exploration_(0.6f),
+    robust_actions_(2),
+    inference_batch_size_(0),
+    inference_delay_(0),
+    fast_inference_(false) { // Initialize strategy_buffer with capacity
+
+    initNetworks();
+
+    // Initialize reservoir buffers
+    const int buffer_size = 1000000;  // 1M samples as in the paper
+    for (int i = 0; i < num_players_; i++) {
+        advantage_buffers_.push_back(std::make_unique<FeatureReservoirBuffer>(
+            buffer_size, MAX_FEATURE_SIZE, num_actions, buffer_precision));
+    }
+    seedBuffers();
 
-    // Initialize neural networks
-    const int input_size = 500;  // Size of the feature vector for poker states
+    setNumThreads(1);
+}
+
+void DeepCFR::initNetworks() {
+    const int input_size = MAX_FEATURE_SIZE;  // Size of the feature vector for poker states
     const int hidden_size = 256;
-    const int output_size = num_actions;   // Number of possible actions in poker
+    const int output_size = num_actions_;   // Number of possible actions in poker
 
     // Create advantage networks for each player
+    advantage_nets_.clear();
     for (int i = 0; i < num_players_; i++) {
         advantage_nets_.push_back(std::make_shared<NeuralNet>(
             input_size, hidden_size, output_size, 0.001)); // Learning rate 0.001
@@ -25,68 +89,794 @@ DeepCFR::DeepCFR(int num_players, int num_traversals, float alpha, int num_actio
     // Create strategy network
     strategy_net_ = std::make_shared<NeuralNet>(
         input_size, hidden_size, output_size, 0.001); // Learning rate 0.001
+}
 
-    // Initialize reservoir buffers
-    const int buffer_size = 1000000;  // 1M samples as in the paper
+void DeepCFR::seedBuffers(uint32_t iteration) {
+    // One reservoir stream per buffer, the strategy buffer taking the slot after the players
     for (int i = 0; i < num_players_; i++) {
-        advantage_buffers_.push_back(ReservoirBuffer<AdvantageMemory>(buffer_size));
+        advantage_buffers_[i]->seed(Philox4x32(seed_, iteration, i, 0, RngPurpose::RESERVOIR).next64());
     }
+    strategy_buffer_->seed(Philox4x32(seed_, iteration, num_players_, 0, RngPurpose::RESERVOIR).next64());
 }
 
-void DeepCFR::train(int iterations, int advantage_batch_size, int strategy_batch_size) {
-    // Initialize iteration weights
-    iteration_weights_.resize(iterations);
-    for (int i = 0; i < iterations; i++) {
-        iteration_weights_[i] = std::pow(i + 1, alpha_);
+void DeepCFR::ensureIterationWeights(size_t iterations) {
+    for (size_t i = iteration_weights_.size(); i < iterations; i++) {
+        iteration_weights_.push_back(std::pow(i + 1, alpha_));
+    }
+}
+
+void DeepCFR::useDiskBuffers(const std::string& directory, size_t capacity) {
+    std::filesystem::create_directories(directory);
+
+    for (int i = 0; i < num_players_; i++) {
+        advantage_buffers_[i] = std::make_unique<MmapReservoirBuffer>(
+            directory + "/advantage_" + std::to_string(i) + ".rsv", capacity, MAX_FEATURE_SIZE, num_actions_);
+        std::cout << "Advantage buffer " << i << " resumed with " << advantage_buffers_[i]->size()
+                  << " samples" << std::endl;
+    }
+    strategy_buffer_ = std::make_unique<MmapReservoirBuffer>(
+        directory + "/strategy.rsv", capacity, MAX_FEATURE_SIZE, num_actions_);
+    seedBuffers();
+}
+
+void DeepCFR::useWeightedStrategyReservoir(size_t capacity) {
+    strategy_buffer_ = std::make_unique<FeatureReservoirBuffer>(
+        capacity, MAX_FEATURE_SIZE, num_actions_, buffer_precision_, ReservoirMode::WEIGHTED);
+    seedBuffers();
+}
+
+void DeepCFR::useConcurrentBuffers(size_t capacity) {
+    for (int i = 0; i < num_players_; i++) {
+        advantage_buffers_[i] = std::make_unique<ConcurrentReservoirBuffer>(capacity, MAX_FEATURE_SIZE, num_actions_);
+    }
+    strategy_buffer_ = std::make_unique<ConcurrentReservoirBuffer>(capacity, MAX_FEATURE_SIZE, num_actions_);
+    concurrent_buffers_ = true;
+    seedBuffers();
+}
+
+void DeepCFR::useSingleDeepCFR(const std::string& directory) {
+    snapshots_ = std::make_unique<SnapshotStore>(directory);
+    std::cout << "SD-CFR snapshots in " << directory << ":";
+    for (int i = 0; i < num_players_; i++) {
+        std::cout << " " << snapshots_->size(i);
+    }
+    std::cout << std::endl;
+}
+
+void DeepCFR::useFastInference(bool enable) {
+    fast_inference_ = enable;
+    if (fast_inference_) {
+        refreshFastNets();
+    } else {
+        fast_advantage_nets_.clear();
+        fast_strategy_net_.reset();
+    }
+}
+
+void DeepCFR::useBatchedInference(size_t max_batch_size, std::chrono::microseconds max_delay) {
+    inference_batch_size_ = max_batch_size;
+    inference_delay_ = max_delay;
+}
+
+void DeepCFR::setNumThreads(size_t num_threads) {
+    num_threads = std::max<size_t>(1, num_threads);
+    pool_ = num_threads > 1 ? std::make_unique<ThreadPool>(num_threads) : nullptr;
+}
+
+void DeepCFR::enableMetrics() {
+    if (!metrics_) {
+        metrics_ = std::make_unique<Metrics>();
+    }
+}
+
+MetricsCounts DeepCFR::metrics() const {
+    return metrics_ ? metrics_->total() : MetricsCounts();
+}
+
+void DeepCFR::setSeed(uint64_t seed) {
+    seed_ = seed;
+    torch::manual_seed(seed);
+    initNetworks();
+    seedBuffers();
+
+    quantized_strategy_net_.reset();
+    if (fast_inference_) {
+        refreshFastNets();
+    }
+}
+
+void DeepCFR::setTrainingSteps(int steps) {
+    if (steps < 1) {
+        throw std::invalid_argument("Training steps must be positive");
+    }
+    train_steps_ = steps;
+}
+
+void DeepCFR::enablePruning(float threshold, float probability, int start_iteration) {
+    // A pruned action must have zero probability under regret matching, or skipping it
+    // would bias the node's value
+    if (threshold >= 0.0f) {
+        throw std::invalid_argument("Pruning threshold must be negative");
+    }
+    if (probability < 0.0f || probability > 1.0f) {
+        throw std::invalid_argument("Pruning probability must be in [0, 1]");
+    }
+    pruning_ = {true, threshold, probability, start_iteration};
+}
+
+void DeepCFR::setTraversalScheme(TraversalScheme scheme, size_t robust_actions, float exploration) {
+    if (robust_actions < 1) {
+        throw std::invalid_argument("Robust sampling must expand at least one action");
+    }
+    // Every action needs a nonzero sampling probability for the importance weights to exist
+    if (exploration <= 0.0f || exploration > 1.0f) {
+        throw std::invalid_argument("Outcome sampling exploration must be in (0, 1]");
+    }
+    traversal_scheme_ = scheme;
+    robust_actions_ = robust_actions;
+    exploration_ = exploration;
+}
+
+void DeepCFR::refreshFastNets() {
+    fast_advantage_nets_.resize(num_players_);
+    for (int i = 0; i < num_players_; i++) {
+        fast_advantage_nets_[i] = std::make_shared<FastMLP>(advantage_nets_[i]->exportLayers());
+    }
+    fast_strategy_net_ = std::make_shared<FastMLP>(strategy_net_->exportLayers());
+}
+
+QuantizationReport DeepCFR::quantizeStrategyNet(QuantizedMLP::Precision precision,
+                                                size_t calibration_rows,
+                                                size_t holdout_rows) {
+    // One distinct draw from the reservoir, split so the held-out rows were never calibrated on
+    size_t requested = calibration_rows + holdout_rows;
+    size_t available = std::min(requested, strategy_buffer_->size());
+    if (available < 2) {
+        throw std::runtime_error("Not enough strategy samples to calibrate quantization");
+    }
+
+    size_t feature_size = strategy_buffer_->featureSize();
+    std::vector<float> features(available * feature_size);
+    std::vector<float> targets(available * strategy_buffer_->targetSize());
+    size_t rows = strategy_buffer_->sample(available, features.data(), targets.data(), nullptr);
+    size_t calibration = std::clamp<size_t>(rows * calibration_rows / requested, 1, rows - 1);
+
+    std::vector<DenseLayer> layers = strategy_net_->exportLayers();
+    auto quantized = std::make_shared<QuantizedMLP>(layers, features.data(), calibration, precision);
+    QuantizationReport report = quantized->evaluate(layers, features.data() + calibration * feature_size,
+                                                    rows - calibration);
+    quantized_strategy_net_ = quantized;
+
+    std::cout << "Quantized strategy network (" << (precision == QuantizedMLP::Precision::INT8 ? "int8" : "fp16")
+              << ") on " << report.samples << " held-out states:" << std::endl;
+    std::cout << "  Mean abs error: " << report.mean_abs_error << " (mean |output| " << report.mean_abs_output << ")" << std::endl;
+    std::cout << "  Max abs error: " << report.max_abs_error << std::endl;
+    std::cout << "  Argmax agreement: " << report.argmax_agreement * 100.0 << "%" << std::endl;
+    std::cout << "  Weights: " << report.quantized_bytes << " bytes (fp32 " << report.fp32_bytes << ")" << std::endl;
+    return report;
+}
+
+void DeepCFR::saveQuantizedStrategyNet(const std::string& path) const {
+    if (!quantized_strategy_net_) {
+        throw std::runtime_error("No quantized strategy network to save; call quantizeStrategyNet first");
     }
+    std::filesystem::create_directories(path);
+    quantized_strategy_net_->save(path + "/strategy_net.qnet");
+}
+
+void DeepCFR::loadQuantizedStrategyNet(const std::string& path) {
+    auto quantized = std::make_shared<QuantizedMLP>(QuantizedMLP::load(path + "/strategy_net.qnet"));
+    if (quantized->inputSize() != MAX_FEATURE_SIZE || quantized->outputSize() != static_cast<size_t>(num_actions_)) {
+        throw std::runtime_error("Quantized strategy network in " + path + " does not match this model's dimensions");
+    }
+    quantized_strategy_net_ = quantized;
+}
 
-    for (int iter = 0; iter < iterations; iter++) {
-        std::cout << "Iteration " << iter + 1 << "/" << iterations << std::endl;
+void DeepCFR::train(int iterations, int advantage_batch_size, int strategy_batch_size) {
+    TRACE_SCOPE("DeepCFR::train");
+    // Iterations are numbered across calls, so repeated and resumed calls continue the
+    // Linear CFR schedule instead of restarting it
+    ensureIterationWeights(completed_iterations_ + iterations);
+
+    std::cout << "Seed: " << seed_ << std::endl;
+
+    for (int i = 0; i < iterations; i++) {
+        TRACE_SCOPE("DeepCFR::iteration");
+        int iter = static_cast<int>(completed_iterations_);
+        std::cout << "Iteration " << iter + 1 << " (" << i + 1 << "/" << iterations << " this call)" << std::endl;
 
         // For each player
         for (int player_id = 0; player_id < num_players_; player_id++) {
             std::cout << "  Traversals for player " << player_id << std::endl;
 
             // Perform CFR traversals
-            for (int t = 0; t < num_traversals_; t++) {
-                if (t % 100 == 0) {
-                    std::cout << "    Traversal " << t << "/" << num_traversals_ << std::endl;
+            runTraversals(player_id, iter, seed_);
+
+            // Update advantage network for this player
+            updateAdvantageNet(player_id, advantage_batch_size);
+
+            // SD-CFR keeps this iteration's network, weighted like a Linear CFR strategy sample
+            if (snapshots_) {
+                snapshots_->add(completed_iterations_ + 1, player_id,
+                                std::pow(completed_iterations_ + 1.0f, alpha_),
+                                advantage_nets_[player_id]->exportLayers());
+            }
+        }
+
+        if (!snapshots_) {
+            // Collect strategy data, traversing for a random player each time
+            runTraversals(-1, iter, seed_);
+
+            // Update strategy network
+            updateStrategyNet(strategy_batch_size);
+        }
+        completed_iterations_++;
+    }
+}
+
+void DeepCFR::trainPipelined(int iterations, int advantage_batch_size, int strategy_batch_size) {
+    // SD-CFR needs each iteration's network, which the learner never settles on
+    if (snapshots_) {
+        throw std::logic_error("SD-CFR snapshots are not supported by pipelined training");
+    }
+
+    ensureIterationWeights(completed_iterations_ + iterations);
+
+    std::cout << "Seed: " << seed_ << std::endl;
+
+    // Actors start from the current networks
+    auto initial = std::make_shared<NetSnapshot>();
+    for (int i = 0; i < num_players_; i++) {
+        initial->advantage_nets.push_back(std::make_shared<const FastMLP>(advantage_nets_[i]->exportLayers()));
+    }
+    std::atomic_store(&snapshot_, std::shared_ptr<const NetSnapshot>(initial));
+    pipelined_ = true;
+
+    std::atomic<bool> stop(false);
+    std::exception_ptr learner_error;
+    size_t rounds = 0;
+    std::thread learner([&]() {
+        Tracer::setThreadName("learner");
+        try {
+            learnerLoop(advantage_batch_size, strategy_batch_size, stop, rounds);
+        } catch (...) {
+            learner_error = std::current_exception();
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::exception_ptr actor_error;
+    try {
+        for (int i = 0; i < iterations && !learner_error; i++) {
+            int iter = static_cast<int>(completed_iterations_);
+            std::cout << "Iteration " << iter + 1 << " (" << i + 1 << "/" << iterations << " this call, pipelined)" << std::endl;
+            for (int player_id = 0; player_id < num_players_; player_id++) {
+                std::cout << "  Traversals for player " << player_id << std::endl;
+                runTraversals(player_id, iter, seed_);
+            }
+            runTraversals(-1, iter, seed_);
+            completed_iterations_++;
+        }
+    } catch (...) {
+        actor_error = std::current_exception();
+    }
+
+    stop.store(true);
+    learner.join();
+    pipelined_ = false;
+    std::atomic_store(&snapshot_, std::shared_ptr<const NetSnapshot>());
+    if (actor_error) std::rethrow_exception(actor_error);
+    if (learner_error) std::rethrow_exception(learner_error);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Learner ran " << rounds << " update rounds in " << seconds << "s alongside the traversals" << std::endl;
+
+    if (fast_inference_) {
+        refreshFastNets();
+    }
+    quantized_strategy_net_.reset();
+}
+
+void DeepCFR::learnerLoop(int advantage_batch_size, int strategy_batch_size, const std::atomic<bool>& stop, size_t& rounds) {
+    auto ready = [this](SampleBuffer& buffer, int batch_size) {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        return buffer.size() >= static_cast<size_t>(batch_size);
+    };
+
+    // Round-robin over the networks, each update drawing fresh minibatches from a buffer the
+    // actors keep filling
+    while (!stop.load()) {
+        bool trained = false;
+        for (int player_id = 0; player_id < num_players_ && !stop.load(); player_id++) {
+            if (!ready(*advantage_buffers_[player_id], advantage_batch_size)) continue;
+            LockedSampleBufferSource source(*advantage_buffers_[player_id], buffer_mutex_);
+            trainNet(*advantage_nets_[player_id], source, advantage_batch_size);
+            publishSnapshot(player_id, advantage_nets_[player_id]->exportLayers());
+            trained = true;
+        }
+        if (!stop.load() && ready(*strategy_buffer_, strategy_batch_size)) {
+            LockedSampleBufferSource source(*strategy_buffer_, buffer_mutex_);
+            trainNet(*strategy_net_, source, strategy_batch_size);
+            trained = true;
+        }
+
+        if (trained) {
+            rounds++;
+        } else {
+            // Nothing to learn from yet; let the actors fill the buffers
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+void DeepCFR::publishSnapshot(int player_id, const std::vector<DenseLayer>& layers) {
+    // Only one thread publishes, so a plain load-copy-store cannot lose an update
+    auto next = std::make_shared<NetSnapshot>(*std::atomic_load(&snapshot_));
+    next->advantage_nets[player_id] = std::make_shared<const FastMLP>(layers);
+    next->version++;
+    std::atomic_store(&snapshot_, std::shared_ptr<const NetSnapshot>(std::move(next)));
+}
+
+void DeepCFR::runTraversals(int player_id, int iteration, uint64_t seed) {
+    TRACE_SCOPE("DeepCFR::runTraversals");
+    // Traversals run in windows of this many per worker. Each stages its samples in its own
+    // context and the window is flushed in traversal order, so the buffers receive the same
+    // sample sequence however the traversals were scheduled.
+    const size_t window_per_thread = 64;
+    const size_t num_threads = pool_ ? pool_->size() : 1;
+    const size_t total = static_cast<size_t>(num_traversals_);
+    const size_t window = window_per_thread * num_threads;
+    contexts_.resize(window);
+
+    // Strategy passes (player_id < 0) are keyed after the per-player advantage passes
+    const uint32_t pass = static_cast<uint32_t>(player_id >= 0 ? player_id : num_players_);
+    auto start = std::chrono::steady_clock::now();
+    size_t nodes = 0;
+    size_t pruned = 0;
+    bool pruning = pruning_.enabled && static_cast<int>(completed_iterations_) >= pruning_.start_iteration;
+
+    // The networks stay fixed until the traversals are done, so brokers can serve them
+    inference_brokers_.clear();
+    if (inference_batch_size_ > 0 && !fast_inference_ && !pipelined_) {
+        for (int i = 0; i < num_players_; i++) {
+            std::shared_ptr<NeuralNet> net = advantage_nets_[i];
+            inference_brokers_.push_back(std::make_unique<InferenceBroker>(
+                [net](const float* rows, int64_t num_rows) { return net->predictBatch(rows, num_rows); },
+                MAX_FEATURE_SIZE, num_actions_, inference_batch_size_, inference_delay_));
+        }
+    }
+
+    for (size_t begin = 0; begin < total; begin += window) {
+        size_t end = std::min(total, begin + window);
+
+        auto traverse = [&](size_t t, size_t) {
+            TRACE_SCOPE("DeepCFR::traversal");
+            TraversalContext& context = contexts_[t - begin];
+            context.metrics = metrics_ ? &context.counts : nullptr;
+            {
+                ScopedTimer timer(context.metrics, Phase::TRAVERSAL);
+                uint32_t index = static_cast<uint32_t>(t);
+                context.rng = Philox4x32(seed, completed_iterations_, pass, index, RngPurpose::ACTION);
+                context.snapshot = pipelined_ ? std::atomic_load(&snapshot_) : nullptr;
+                context.prune = pruning && Philox4x32(seed, completed_iterations_, pass, index,
+                                                      RngPurpose::SAMPLING).uniform() < pruning_.probability;
+
+                int traverser = player_id;
+                if (traverser < 0) {
+                    traverser = static_cast<int>(
+                        Philox4x32(seed, completed_iterations_, pass, index, RngPurpose::TRAVERSER).below(num_players_));
                 }
 
-                // Create a new game instance
-                Game game(num_players_, 1000, 10, 20);  // 6 players, 1000 chips, 10/20 blinds
-                game.startHand();
+                // Create a new game instance, dealt from this traversal's own stream
+                Philox4x32 deal(seed, completed_iterations_, pass, index, RngPurpose::DEAL);
+                Game game(num_players_, 1000, 10, 20);  // 1000 chips, 10/20 blinds
+                game.startHand(Deck(deal));
+                traverseCFR(game, traverser, iteration, 1.0f, context);
+                context.snapshot.reset();
+            }
 
-                // Perform CFR traversal
-                traverseCFR(game, player_id, iter, 1.0);
+            if (concurrent_buffers_ && !sample_sink_) {
+                if (context.metrics) {
+                    context.counts.add(Counter::ADVANTAGE_SAMPLES, context.advantage_samples.size());
+                    context.counts.add(Counter::STRATEGY_SAMPLES, context.strategy_samples.size());
+                }
+                ScopedTimer timer(context.metrics, Phase::BUFFER_INSERT);
+                flushSamples(context);
             }
+        };
 
-            // Update advantage network for this player
-            updateAdvantageNet(player_id, advantage_batch_size);
+        if (pool_) {
+            // Small chunks so stealing can balance traversals of very different depth
+            size_t grain = std::max<size_t>(1, (end - begin) / (num_threads * 16));
+            pool_->parallelFor(begin, end, grain, traverse);
+        } else {
+            for (size_t t = begin; t < end; t++) {
+                traverse(t, 0);
+            }
+        }
+
+        TRACE_SCOPE("DeepCFR::flushWindow");
+        MetricsCounts window_counts;
+        for (size_t t = begin; t < end; t++) {
+            TraversalContext& context = contexts_[t - begin];
+            if (context.metrics) {
+                context.counts.add(Counter::TRAVERSALS);
+                context.counts.add(Counter::NODES, context.nodes_visited);
+                context.counts.add(Counter::ADVANTAGE_SAMPLES, context.advantage_samples.size());
+                context.counts.add(Counter::STRATEGY_SAMPLES, context.strategy_samples.size());
+            }
+            {
+                ScopedTimer timer(context.metrics, Phase::BUFFER_INSERT);
+                flushSamples(context);
+            }
+            nodes += context.nodes_visited;
+            pruned += context.actions_pruned;
+            context.nodes_visited = 0;
+            context.actions_pruned = 0;
+            window_counts += context.counts;
+            context.counts.clear();
+        }
+        if (metrics_) {
+            metrics_->merge(window_counts);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "    " << num_traversals_ << " traversals (" << nodes << " nodes";
+    if (!inference_brokers_.empty()) {
+        size_t batches = 0;
+        size_t requests = 0;
+        for (const auto& broker : inference_brokers_) {
+            batches += broker->batchesRun();
+            requests += broker->requestsServed();
+        }
+        std::cout << ", " << (batches ? static_cast<double>(requests) / batches : 0.0) << " rows per inference batch";
+        inference_brokers_.clear();
+    }
+    if (pruning) {
+        std::cout << ", " << pruned << " actions pruned";
+    }
+    std::cout << ") on " << num_threads
+              << " thread(s), " << static_cast<long long>(seconds > 0.0 ? num_traversals_ / seconds : 0.0)
+              << " traversals/sec" << std::endl;
+}
+
+void DeepCFR::flushSamples(TraversalContext& context) {
+    if (sample_sink_) {
+        // Batch rows up for the learner, tagged with their destination buffer
+        const StagedSamples* staged[2] = {&context.advantage_samples, &context.strategy_samples};
+        for (const StagedSamples* samples : staged) {
+            pending_samples_.features.insert(pending_samples_.features.end(), samples->features.begin(), samples->features.end());
+            pending_samples_.targets.insert(pending_samples_.targets.end(), samples->targets.begin(), samples->targets.end());
+            pending_samples_.weights.insert(pending_samples_.weights.end(), samples->weights.begin(), samples->weights.end());
+            for (size_t i = 0; i < samples->size(); i++) {
+                pending_samples_.buffers.push_back(samples == &context.strategy_samples ? num_players_ : samples->players[i]);
+            }
+        }
+        context.advantage_samples.clear();
+        context.strategy_samples.clear();
+        if (pending_samples_.size() >= 4096) {
+            sendPendingSamples();
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(buffer_mutex_, std::defer_lock);
+    if (!concurrent_buffers_) {
+        lock.lock();
+    }
+
+    const StagedSamples& advantage = context.advantage_samples;
+    for (size_t i = 0; i < advantage.size(); i++) {
+        advantage_buffers_[advantage.players[i]]->add(advantage.features.data() + i * MAX_FEATURE_SIZE,
+                                                      advantage.targets.data() + i * num_actions_,
+                                                      num_actions_, advantage.weights[i]);
+    }
+
+    const StagedSamples& strategy = context.strategy_samples;
+    for (size_t i = 0; i < strategy.size(); i++) {
+        strategy_buffer_->add(strategy.features.data() + i * MAX_FEATURE_SIZE,
+                              strategy.targets.data() + i * num_actions_,
+                              num_actions_, strategy.weights[i]);
+    }
+
+    context.advantage_samples.clear();
+    context.strategy_samples.clear();
+}
+
+void DeepCFR::sendPendingSamples() {
+    if (pending_samples_.size() == 0) return;
+    pending_samples_.feature_size = MAX_FEATURE_SIZE;
+    pending_samples_.target_size = num_actions_;
+    sample_sink_->send(MessageType::SAMPLES, encodeSamples(pending_samples_));
+    pending_samples_.clear();
+}
+
+void DeepCFR::runLearner(const std::string& endpoint, int iterations, int advantage_batch_size, int strategy_batch_size) {
+    if (snapshots_) {
+        throw std::logic_error("SD-CFR snapshots are not supported by distributed training");
+    }
+
+    Listener listener(endpoint);
+    std::cout << "Learner listening on " << listener.endpoint() << std::endl;
+
+    std::mutex workers_mutex;
+    std::vector<std::shared_ptr<Connection>> workers;   // Admitted; weight updates go to these
+    std::vector<std::shared_ptr<Connection>> accepted;  // Every connection, admitted or not
+    std::vector<std::thread> readers;
+    std::vector<std::vector<uint8_t>> latest_weights(num_players_);  // Sent to workers as they join
+
+    // Samples received per buffer since the last training round, the strategy buffer last;
+    // guarded by buffer_mutex_ like the buffers themselves
+    std::vector<size_t> fresh(num_players_ + 1, 0);
+    std::condition_variable samples_arrived;
+    size_t live_workers = 0;  // Readers still streaming, guarded by buffer_mutex_
+    std::atomic<bool> stopping(false);
+    std::atomic<size_t> rows_received(0);
+
+    for (int i = 0; i < num_players_; i++) {
+        latest_weights[i] = encodeWeights({static_cast<uint32_t>(completed_iterations_), i, advantage_nets_[i]->exportLayers()});
+    }
+
+    // One thread per connection. The HELLO handshake runs here rather than on the acceptor,
+    // so a client that connects and stays silent holds up nobody but itself.
+    std::atomic<uint32_t> next_id(0);
+    auto serve = [&](std::shared_ptr<Connection> worker) {
+        uint32_t id;
+        try {
+            MessageType type;
+            std::vector<uint8_t> payload;
+            if (!worker->receive(type, payload) || type != MessageType::HELLO) {
+                worker->shutdown();
+                return;
+            }
+
+            id = next_id++;
+            std::vector<uint8_t> welcome(sizeof(id));
+            std::memcpy(welcome.data(), &id, sizeof(id));
+            worker->send(MessageType::WELCOME, welcome);
+
+            std::lock_guard<std::mutex> lock(workers_mutex);
+            for (const auto& weights : latest_weights) {
+                worker->send(MessageType::WEIGHTS, weights);
+            }
+            workers.push_back(worker);
+            {
+                std::lock_guard<std::mutex> lock(buffer_mutex_);
+                live_workers++;
+            }
+        } catch (const std::exception& e) {
+            if (!stopping) {
+                std::cerr << "Failed to admit worker: " << e.what() << std::endl;
+            }
+            worker->shutdown();
+            return;
+        }
+        samples_arrived.notify_all();
+        std::cout << "Worker " << id << " joined" << std::endl;
+
+        try {
+            MessageType type;
+            std::vector<uint8_t> payload;
+            while (worker->receive(type, payload)) {
+                if (type != MessageType::SAMPLES) continue;
+                SampleBatch batch = decodeSamples(payload, MAX_FEATURE_SIZE, static_cast<size_t>(num_actions_));
+                // Reject the whole batch before any of it reaches the buffers
+                for (int32_t target : batch.buffers) {
+                    if (target < 0 || target > num_players_) {
+                        throw std::runtime_error("Worker sample for unknown buffer " + std::to_string(target));
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(buffer_mutex_);
+                    for (size_t row = 0; row < batch.size(); row++) {
+                        int32_t target = batch.buffers[row];
+                        SampleBuffer& buffer = target == num_players_ ? *strategy_buffer_ : *advantage_buffers_[target];
+                        buffer.add(batch.features.data() + row * batch.feature_size,
+                                   batch.targets.data() + row * batch.target_size,
+                                   batch.target_size, batch.weights[row]);
+                        fresh[target]++;
+                    }
+                }
+                rows_received += batch.size();
+                samples_arrived.notify_all();
+            }
+        } catch (const std::exception& e) {
+            if (!stopping) {
+                std::cerr << "Dropping worker: " << e.what() << std::endl;
+            }
+        }
+        worker->shutdown();
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            live_workers--;
+        }
+        samples_arrived.notify_all();
+    };
+
+    std::thread acceptor([&]() {
+        while (!stopping) {
+            std::shared_ptr<Connection> worker;
+            try {
+                worker = std::make_shared<Connection>(listener.accept());
+            } catch (const std::exception&) {
+                return;  // Listener closed
+            }
+            std::lock_guard<std::mutex> lock(workers_mutex);
+            accepted.push_back(worker);
+            readers.emplace_back(serve, worker);
         }
+    });
+
+    auto broadcast = [&](int player_id) {
+        std::vector<uint8_t> payload = encodeWeights(
+            {static_cast<uint32_t>(completed_iterations_), player_id, advantage_nets_[player_id]->exportLayers()});
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        latest_weights[player_id] = payload;
+        for (const auto& worker : workers) {
+            try {
+                worker->send(MessageType::WEIGHTS, payload);
+            } catch (const std::exception&) {
+                worker->shutdown();  // Its reader reports and retires it
+            }
+        }
+    };
+
+    std::exception_ptr error;
+    try {
+        // A round waits until every buffer has a fresh batch's worth of samples per SGD step
+        const size_t round_rows = static_cast<size_t>(std::max(advantage_batch_size, strategy_batch_size)) * train_steps_;
+        // With no worker connected the round can only complete if one joins in time
+        const auto worker_wait = std::chrono::seconds(120);
+        for (int iter = 0; iter < iterations; iter++) {
+            {
+                std::unique_lock<std::mutex> lock(buffer_mutex_);
+                auto round_ready = [&]() {
+                    return std::all_of(fresh.begin(), fresh.end(), [&](size_t rows) { return rows >= round_rows; });
+                };
+                while (!round_ready()) {
+                    if (live_workers > 0) {
+                        samples_arrived.wait(lock);
+                    } else if (!samples_arrived.wait_for(lock, worker_wait, [&]() { return round_ready() || live_workers > 0; })) {
+                        throw std::runtime_error("No worker connected for " + std::to_string(worker_wait.count()) +
+                                                 " s while waiting for samples");
+                    }
+                }
+                std::fill(fresh.begin(), fresh.end(), 0);
+            }
 
-        // Collect strategy data
-        for (int t = 0; t < num_traversals_; t++) {
-            // Create a new game instance
-            Game game(num_players_, 1000, 10, 20);
-            game.startHand();
+            std::cout << "Iteration " << iter + 1 << "/" << iterations << " (" << rows_received.load()
+                      << " samples received)" << std::endl;
+            completed_iterations_++;
+            for (int player_id = 0; player_id < num_players_; player_id++) {
+                LockedSampleBufferSource source(*advantage_buffers_[player_id], buffer_mutex_);
+                TrainStats stats = trainNet(*advantage_nets_[player_id], source, advantage_batch_size);
+                std::cout << "  Advantage network " << player_id << " loss: " << stats.loss << std::endl;
+                broadcast(player_id);
+            }
+            LockedSampleBufferSource source(*strategy_buffer_, buffer_mutex_);
+            TrainStats stats = trainNet(*strategy_net_, source, strategy_batch_size);
+            std::cout << "  Strategy network loss: " << stats.loss << std::endl;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
 
-            // Random player for this traversal
-            int player_id = std::uniform_int_distribution<>(0, num_players_ - 1)(rng_);
-            traverseCFR(game, player_id, iter, 1.0);
+    // Stop admitting workers, tell the others to finish, then wait for their streams to end;
+    // connections still in their handshake are closed too
+    stopping = true;
+    listener.close();
+    acceptor.join();
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        for (const auto& worker : workers) {
+            try {
+                worker->send(MessageType::SHUTDOWN, {});
+            } catch (const std::exception&) {
+            }
+        }
+        for (const auto& connection : accepted) {
+            connection->shutdown();
         }
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    if (error) std::rethrow_exception(error);
+
+    if (fast_inference_) {
+        refreshFastNets();
+    }
+    quantized_strategy_net_.reset();
+}
+
+void DeepCFR::runWorker(const std::string& endpoint) {
+    if (snapshots_) {
+        throw std::logic_error("SD-CFR snapshots are not supported by distributed training");
+    }
+
+    Connection learner = Connection::connect(endpoint);
+    learner.send(MessageType::HELLO, {});
+
+    MessageType type;
+    std::vector<uint8_t> payload;
+    uint32_t worker_id;
+    if (!learner.receive(type, payload) || type != MessageType::WELCOME || payload.size() != sizeof(worker_id)) {
+        throw std::runtime_error("Learner at " + endpoint + " did not admit this worker");
+    }
+    std::memcpy(&worker_id, payload.data(), sizeof(worker_id));
+    // This worker's own streams; seed_ stays the run's seed
+    uint64_t worker_seed = Philox4x32(seed_, 0, worker_id, 0, RngPurpose::SAMPLING).next64();
+    std::cout << "Joined learner at " << endpoint << " as worker " << worker_id << std::endl;
 
-        // Update strategy network
-        updateStrategyNet(strategy_batch_size);
+    // Traversals need every advantage network, so wait for the full set first
+    auto initial = std::make_shared<NetSnapshot>();
+    initial->advantage_nets.resize(num_players_);
+    std::atomic<uint32_t> learner_iteration(0);
+    int missing = num_players_;
+    while (missing > 0) {
+        if (!learner.receive(type, payload) || type == MessageType::SHUTDOWN) return;
+        if (type != MessageType::WEIGHTS) continue;
+        WeightsMessage weights = decodeWeights(payload);
+        if (weights.net < 0 || weights.net >= num_players_) continue;
+        if (!initial->advantage_nets[weights.net]) missing--;
+        initial->advantage_nets[weights.net] = std::make_shared<const FastMLP>(weights.layers);
+        learner_iteration = weights.iteration;
+    }
+    std::atomic_store(&snapshot_, std::shared_ptr<const NetSnapshot>(initial));
 
-        // Save models periodically
-        if ((iter + 1) % 10 == 0 || iter == iterations - 1) {
-            saveModels("models/iter_" + std::to_string(iter + 1));
+    std::atomic<bool> stop(false);
+    std::thread receiver([&]() {
+        try {
+            MessageType message_type;
+            std::vector<uint8_t> message;
+            while (learner.receive(message_type, message) && message_type != MessageType::SHUTDOWN) {
+                if (message_type != MessageType::WEIGHTS) continue;
+                WeightsMessage weights = decodeWeights(message);
+                if (weights.net >= 0 && weights.net < num_players_) {
+                    publishSnapshot(weights.net, weights.layers);
+                }
+                learner_iteration = weights.iteration;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Lost the learner: " << e.what() << std::endl;
+        }
+        stop = true;
+    });
+
+    pipelined_ = true;
+    sample_sink_ = &learner;
+    std::exception_ptr error;
+    try {
+        while (!stop) {
+            // Strategy samples carry the learner's current Linear CFR weight
+            uint32_t iteration = learner_iteration.load();
+            ensureIterationWeights(iteration + 1);
+            for (int player_id = 0; player_id < num_players_ && !stop; player_id++) {
+                runTraversals(player_id, iteration, worker_seed);
+            }
+            if (!stop) {
+                runTraversals(-1, iteration, worker_seed);
+            }
+            completed_iterations_++;  // Fresh streams for the next round whatever the learner does
         }
+    } catch (...) {
+        // A send failing after the learner shut us down is the normal way out
+        if (!stop) error = std::current_exception();
     }
+
+    learner.shutdown();
+    receiver.join();
+    pipelined_ = false;
+    sample_sink_ = nullptr;
+    pending_samples_.clear();
+    std::atomic_store(&snapshot_, std::shared_ptr<const NetSnapshot>());
+    if (error) std::rethrow_exception(error);
+    std::cout << "Worker " << worker_id << " done" << std::endl;
 }
 
-float DeepCFR::traverseCFR(Game& game, int traversing_player, int iteration, float reach_prob) {
+float DeepCFR::traverseCFR(Game& game, int traversing_player, int iteration, float reach_prob, TraversalContext& context) {
+    TRACE_SCOPE("DeepCFR::traverseCFR");
     // If the game is over, return the utility for the player
     if (game.isHandComplete()) {
         float payoff = game.getPayoff(traversing_player);
@@ -98,17 +888,22 @@ float DeepCFR::traverseCFR(Game& game, int traversing_player, int iteration, flo
 
     // Get current player
     int current_player = game.getCurrentPlayer();
+    context.nodes_visited++;
 
-    // Create info state for the current player
+    // Create info state for the current player and encode it once for this node
+    ScopedTimer encode_timer(context.metrics, Phase::ENCODING);
     InfoState info_state = InfoState::fromGame(game, current_player);
     std::vector<Action> legal_actions = info_state.getLegalActions();
+    std::vector<float> features = info_state.toFeatureVector();
+    encode_timer.stop();
 
     // If it's not the traversing player's turn, use current strategy to sample an action
     if (current_player != traversing_player) {
-        std::vector<float> strategy = computeStrategy(info_state, current_player);
+        std::vector<float> strategy = regretMatching(predictAdvantages(features, current_player, context),
+                                                     legal_actions.size());
 
         // Sample an action according to the strategy
-        float r = std::uniform_real_distribution<float>(0, 1)(rng_);
+        float r = context.rng.uniform();
         float cumulative_prob = 0.0f;
         Action chosen_action = legal_actions[0];
 
@@ -123,65 +918,152 @@ float DeepCFR::traverseCFR(Game& game, int traversing_player, int iteration, flo
         // Apply the chosen action and continue
         Game next_state = game;
         next_state.takeAction(chosen_action);
-        return traverseCFR(next_state, traversing_player, iteration, reach_prob);
+        return traverseCFR(next_state, traversing_player, iteration, reach_prob, context);
     }
 
     // If it's the traversing player's turn, compute counterfactual values for each action
     std::vector<float> cf_values(legal_actions.size(), 0.0f);
 
     // Compute strategy from regrets (using advantage network)
-    std::vector<float> strategy = computeStrategy(info_state, traversing_player);
+    std::vector<float> advantages = predictAdvantages(features, traversing_player, context);
+    std::vector<float> strategy = regretMatching(advantages, legal_actions.size());
+
+    // Record the strategy in the strategy buffer with iteration weight (SD-CFR recovers it
+    // from the snapshots instead)
+    if (!snapshots_) {
+        context.strategy_samples.add(features, strategy, num_actions_, iteration_weights_[iteration], traversing_player);
+    }
 
-    // Record the strategy in the strategy buffer with iteration weight
-    strategy_buffer_.add(StrategyMemory(info_state, strategy, iteration_weights_[iteration]));
+    // Pruning leaves river subtrees alone, and needs a non-uniform strategy so that every
+    // action below the (negative) threshold has zero probability
+    bool prune = traversal_scheme_ == TraversalScheme::EXTERNAL && context.prune &&
+                 info_state.getPhase() != HandPhase::Phase::RIVER &&
+                 std::any_of(advantages.begin(), advantages.begin() + legal_actions.size(),
+                             [](float advantage) { return advantage > 0.0f; });
+    std::vector<bool> pruned(legal_actions.size(), false);
 
-    // Compute counterfactual values for each action
+    // Compute counterfactual values for the expanded actions, importance weighted by the
+    // probability they were chosen with; the rest count as zero
+    std::vector<float> sample_probs = chooseActions(strategy, context);
     float cf_value_sum = 0.0f;
     for (size_t i = 0; i < legal_actions.size(); i++) {
+        if (sample_probs[i] == 0.0f) {
+            continue;
+        }
+        if (prune && advantages[i] < pruning_.threshold &&
+            legal_actions[i].getActionType() != ActionType::ALL_IN) {
+            pruned[i] = true;
+            context.actions_pruned++;
+            continue;
+        }
         Game next_state = game;
         next_state.takeAction(legal_actions[i]);
-        cf_values[i] = traverseCFR(next_state, traversing_player, iteration, reach_prob);
+        cf_values[i] = traverseCFR(next_state, traversing_player, iteration, reach_prob, context) / sample_probs[i];
         cf_value_sum += strategy[i] * cf_values[i];
     }
 
     // Compute regrets
     std::vector<float> regrets(legal_actions.size(), 0.0f);
     for (size_t i = 0; i < legal_actions.size(); i++) {
-        regrets[i] = cf_values[i] - cf_value_sum;
+        // A pruned action keeps its predicted advantage rather than being pulled toward zero
+        regrets[i] = pruned[i] ? advantages[i] : cf_values[i] - cf_value_sum;
     }
 
     // Add to advantage buffer with reach probability as weight
-    advantage_buffers_[traversing_player].add(AdvantageMemory(info_state, regrets, reach_prob));
+    context.advantage_samples.add(features, regrets, num_actions_, reach_prob, traversing_player);
 
     return cf_value_sum;
 }
 
+std::vector<float> DeepCFR::chooseActions(const std::vector<float>& strategy, TraversalContext& context) const {
+    // Probability each action was chosen with, 0 for actions left unexpanded
+    size_t n = strategy.size();
+    std::vector<float> probs(n, 0.0f);
+
+    switch (traversal_scheme_) {
+        case TraversalScheme::EXTERNAL:
+            std::fill(probs.begin(), probs.end(), 1.0f);
+            break;
+
+        case TraversalScheme::OUTCOME: {
+            // One action from exploration * uniform + (1 - exploration) * strategy
+            float r = context.rng.uniform();
+            float cumulative_prob = 0.0f;
+            size_t chosen = n - 1;
+            for (size_t i = 0; i < n; i++) {
+                cumulative_prob += exploration_ / n + (1.0f - exploration_) * strategy[i];
+                if (r < cumulative_prob) {
+                    chosen = i;
+                    break;
+                }
+            }
+            probs[chosen] = exploration_ / n + (1.0f - exploration_) * strategy[chosen];
+            break;
+        }
+
+        case TraversalScheme::ROBUST: {
+            // k distinct actions by a partial Fisher-Yates shuffle
+            size_t k = std::min(n, robust_actions_);
+            std::vector<size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            for (size_t j = 0; j < k; j++) {
+                std::swap(order[j], order[j + context.rng.below(static_cast<uint32_t>(n - j))]);
+                probs[order[j]] = static_cast<float>(k) / n;
+            }
+            break;
+        }
+    }
+    return probs;
+}
+
 std::vector<float> DeepCFR::computeStrategy(const InfoState& info_state, int player_id) {
-    // Convert info state to feature vector
-    std::vector<float> features = info_state.toFeatureVector();
+    return computeStrategy(info_state.toFeatureVector(), info_state.getLegalActions().size(), player_id);
+}
 
-    // Get advantages from advantage network
-    std::vector<float> advantages = advantage_nets_[player_id]->predict(features);
-    std::vector<Action> legal_actions = info_state.getLegalActions();
+std::vector<float> DeepCFR::computeStrategy(const std::vector<float>& features, size_t num_legal_actions, int player_id) {
+    return regretMatching(predictAdvantages(features, player_id), num_legal_actions);
+}
+
+std::vector<float> DeepCFR::predictAdvantages(const std::vector<float>& features, int player_id) {
+    return fast_inference_ ? fast_advantage_nets_[player_id]->predict(features)
+                           : advantage_nets_[player_id]->predict(features);
+}
+
+std::vector<float> DeepCFR::predictAdvantages(const std::vector<float>& features, int player_id,
+                                             const TraversalContext& context) {
+    TRACE_SCOPE("DeepCFR::predictAdvantages");
+    ScopedTimer timer(context.metrics, Phase::INFERENCE);
+    if (context.metrics) {
+        context.metrics->add(Counter::INFERENCE_CALLS);
+    }
+    if (context.snapshot) {
+        return context.snapshot->advantage_nets[player_id]->predict(features);
+    }
+    if (!inference_brokers_.empty()) {
+        return inference_brokers_[player_id]->predict(features);
+    }
+    return predictAdvantages(features, player_id);
+}
 
+std::vector<float> DeepCFR::regretMatching(const std::vector<float>& advantages, size_t num_legal_actions) {
     // Convert advantages to strategy using regret matching
-    std::vector<float> strategy(legal_actions.size(), 0.0f);
+    std::vector<float> strategy(num_legal_actions, 0.0f);
     float regret_sum = 0.0f;
 
     // Sum positive regrets
-    for (size_t i = 0; i < legal_actions.size(); i++) {
-        advantages[i] = std::max(advantages[i], 0.0f);
-        regret_sum += advantages[i];
+    for (size_t i = 0; i < num_legal_actions; i++) {
+        strategy[i] = std::max(advantages[i], 0.0f);
+        regret_sum += strategy[i];
     }
 
     // Normalize to get strategy
     if (regret_sum > 0.0f) {
-        for (size_t i = 0; i < legal_actions.size(); i++) {
-            strategy[i] = advantages[i] / regret_sum;
+        for (size_t i = 0; i < num_legal_actions; i++) {
+            strategy[i] /= regret_sum;
         }
     } else {
         // Uniform strategy if all advantages are negative or zero
-        float uniform_prob = 1.0f / legal_actions.size();
+        float uniform_prob = 1.0f / num_legal_actions;
         std::fill(strategy.begin(), strategy.end(), uniform_prob);
     }
 
@@ -189,70 +1071,152 @@ std::vector<float> DeepCFR::computeStrategy(const InfoState& info_state, int pla
 }
 
 void DeepCFR::updateAdvantageNet(int player_id, int batch_size) {
-    if (advantage_buffers_[player_id].size() < static_cast<size_t>(batch_size)) {
+    if (advantage_buffers_[player_id]->size() < static_cast<size_t>(batch_size)) {
         std::cout << "Not enough samples to train advantage net for player " << player_id << std::endl;
         return;
     }
 
     std::cout << "Training advantage network for player " << player_id << std::endl;
 
-    // Sample batch from buffer
-    auto batch = advantage_buffers_[player_id].sample(static_cast<size_t>(batch_size));
-
-    // Prepare features and targets
-    std::vector<std::vector<float>> features_batch;
-    std::vector<std::vector<float>> targets_batch;
+    float loss = trainOnBuffer(*advantage_nets_[player_id], *advantage_buffers_[player_id], batch_size);
+    std::cout << "  Loss: " << loss << std::endl;
 
-    for (const auto& memory : batch) {
-        features_batch.push_back(memory.info_state.toFeatureVector());
-        std::vector<float> padded_advantages = memory.advantages;
-        // Pad advantages to fixed size
-        while (padded_advantages.size() < num_actions_) {
-            padded_advantages.push_back(0.0f);
-        }
-        targets_batch.push_back(padded_advantages);
+    if (fast_inference_) {
+        fast_advantage_nets_[player_id] = std::make_shared<FastMLP>(advantage_nets_[player_id]->exportLayers());
     }
-
-    // Train the network
-    float loss = advantage_nets_[player_id]->train(features_batch, targets_batch, batch_size);
-    std::cout << "  Loss: " << loss << std::endl;
 }
 
 void DeepCFR::updateStrategyNet(int batch_size) {
-    if (strategy_buffer_.size() < static_cast<size_t>(batch_size)) {
+    if (strategy_buffer_->size() < static_cast<size_t>(batch_size)) {
         std::cout << "Not enough samples to train strategy net" << std::endl;
         return;
     }
 
     std::cout << "Training strategy network" << std::endl;
 
-    // Sample batch from buffer
-    auto batch = strategy_buffer_.sample(static_cast<size_t>(batch_size));
+    float loss = trainOnBuffer(*strategy_net_, *strategy_buffer_, batch_size);
+    std::cout << "  Loss: " << loss << std::endl;
 
-    // Prepare features and targets
-    std::vector<std::vector<float>> features_batch;
-    std::vector<std::vector<float>> targets_batch;
+    if (fast_inference_) {
+        fast_strategy_net_ = std::make_shared<FastMLP>(strategy_net_->exportLayers());
+    }
+    quantized_strategy_net_.reset();
+}
 
-    for (const auto& memory : batch) {
-        features_batch.push_back(memory.info_state.toFeatureVector());
-        std::vector<float> padded_strategy = memory.strategy;
-        // Pad strategy to fixed size
-        while (padded_strategy.size() < num_actions_) {
-            padded_strategy.push_back(0.0f);
-        }
-        targets_batch.push_back(padded_strategy);
+float DeepCFR::trainOnBuffer(NeuralNet& net, SampleBuffer& buffer, int batch_size) {
+    // Sampled rows (already encoded and padded) are gathered straight into pinned staging memory
+    // by the prefetch thread. Stored weights (Linear CFR iteration weight or reach probability)
+    // scale each sample's loss; weighted-admission buffers report 1 since the weighting already
+    // happened on insertion.
+    SampleBufferSource source(buffer);
+    TrainStats stats = trainNet(net, source, batch_size);
+
+    std::cout << "  " << stats.steps << " steps, " << static_cast<long long>(stats.samplesPerSecond())
+              << " samples/sec" << std::endl;
+    return stats.loss;
+}
+
+TrainStats DeepCFR::trainNet(NeuralNet& net, BatchSource& source, int batch_size) {
+    TRACE_SCOPE("DeepCFR::trainNet");
+    if (!metrics_) {
+        return net.trainSteps(source, batch_size, train_steps_);
     }
 
-    // Train the network
-    float loss = strategy_net_->train(features_batch, targets_batch, batch_size);
-    std::cout << "  Loss: " << loss << std::endl;
+    MetricsCounts counts;
+    TimedBatchSource timed(source, &counts);
+    TrainStats stats{};
+    {
+        ScopedTimer timer(&counts, Phase::SGD);
+        stats = net.trainSteps(timed, batch_size, train_steps_);
+    }
+    counts.add(Counter::TRAINING_STEPS, stats.steps);
+    counts.add(Counter::TRAINING_ROWS, stats.samples);
+    metrics_->merge(counts);
+    return stats;
+}
+
+size_t DeepCFR::sampleSnapshot(int player_id, float u) const {
+    if (!snapshots_) {
+        throw std::logic_error("SD-CFR is not enabled");
+    }
+    return snapshots_->sample(player_id, u);
+}
+
+std::vector<float> DeepCFR::getActionProbabilities(const InfoState& info_state, size_t snapshot) {
+    if (!snapshots_) {
+        throw std::logic_error("SD-CFR is not enabled");
+    }
+    const FastMLP& net = snapshots_->net(info_state.getPlayerId(), snapshot);
+    return regretMatching(net.predict(info_state.toFeatureVector()), info_state.getLegalActions().size());
 }
 
 std::vector<float> DeepCFR::getActionProbabilities(const InfoState& info_state) {
+    if (snapshots_) {
+        int player_id = info_state.getPlayerId();
+        std::vector<float> features = info_state.toFeatureVector();
+        size_t num_legal_actions = info_state.getLegalActions().size();
+
+        std::vector<float> average(num_legal_actions, 0.0f);
+        float total_weight = 0.0f;
+        for (size_t s = 0; s < snapshots_->size(player_id); s++) {
+            std::vector<float> strategy = regretMatching(snapshots_->net(player_id, s).predict(features), num_legal_actions);
+            float weight = snapshots_->weight(player_id, s);
+            for (size_t i = 0; i < num_legal_actions; i++) {
+                average[i] += weight * strategy[i];
+            }
+            total_weight += weight;
+        }
+        if (total_weight == 0.0f) {
+            throw std::runtime_error("No SD-CFR snapshots for player " + std::to_string(player_id));
+        }
+        for (float& p : average) {
+            p /= total_weight;
+        }
+        return average;
+    }
+
     // Use the strategy network to get action probabilities
+    if (quantized_strategy_net_) {
+        return quantized_strategy_net_->predict(info_state.toFeatureVector());
+    }
+    if (fast_inference_) {
+        return fast_strategy_net_->predict(info_state.toFeatureVector());
+    }
     return strategy_net_->predict(info_state.toFeatureVector());
 }
 
+std::vector<std::vector<float>> DeepCFR::getActionProbabilities(const std::vector<InfoState>& info_states) {
+    std::vector<std::vector<float>> probabilities;
+    probabilities.reserve(info_states.size());
+
+    // The CPU networks gain nothing from batching
+    if (snapshots_ || quantized_strategy_net_ || fast_inference_) {
+        for (const InfoState& info_state : info_states) {
+            probabilities.push_back(getActionProbabilities(info_state));
+        }
+        return probabilities;
+    }
+
+    std::vector<float> rows;
+    rows.reserve(info_states.size() * MAX_FEATURE_SIZE);
+    for (const InfoState& info_state : info_states) {
+        std::vector<float> features = info_state.toFeatureVector();
+        features.resize(MAX_FEATURE_SIZE, 0.0f);
+        rows.insert(rows.end(), features.begin(), features.end());
+    }
+    std::vector<float> outputs = strategy_net_->predictBatch(rows.data(), static_cast<int64_t>(info_states.size()));
+    for (size_t i = 0; i < info_states.size(); i++) {
+        probabilities.emplace_back(outputs.begin() + i * num_actions_, outputs.begin() + (i + 1) * num_actions_);
+    }
+    return probabilities;
+}
+
+std::vector<float> DeepCFR::getActionAdvantages(const InfoState& info_state) {
+    std::vector<float> advantages = predictAdvantages(info_state.toFeatureVector(), info_state.getPlayerId());
+    advantages.resize(info_state.getLegalActions().size());
+    return advantages;
+}
+
 void DeepCFR::saveModels(const std::string& path) {
     // Create directory if it doesn't exist
     std::filesystem::create_directories(path);
@@ -260,10 +1224,12 @@ void DeepCFR::saveModels(const std::string& path) {
     // Save advantage networks
     for (int i = 0; i < num_players_; i++) {
         advantage_nets_[i]->save(path + "/advantage_net_" + std::to_string(i) + ".pt");
+        advantage_nets_[i]->exportWeights(path + "/advantage_net_" + std::to_string(i) + ".bin");
     }
 
     // Save strategy network
     strategy_net_->save(path + "/strategy_net.pt");
+    strategy_net_->exportWeights(path + "/strategy_net.bin");
 }
 
 void DeepCFR::loadModels(const std::string& path) {
@@ -274,4 +1240,198 @@ void DeepCFR::loadModels(const std::string& path) {
 
     // Load strategy network
     strategy_net_->load(path + "/strategy_net.pt");
+    quantized_strategy_net_.reset();
+
+    if (fast_inference_) {
+        refreshFastNets();
+    }
+}
+
+void DeepCFR::loadFastModels(const std::string& path) {
+    fast_advantage_nets_.resize(num_players_);
+    for (int i = 0; i < num_players_; i++) {
+        fast_advantage_nets_[i] = std::make_shared<FastMLP>(
+            mapWeightFile(path + "/advantage_net_" + std::to_string(i) + ".bin"));
+    }
+    fast_strategy_net_ = std::make_shared<FastMLP>(mapWeightFile(path + "/strategy_net.bin"));
+    quantized_strategy_net_.reset();
+    fast_inference_ = true;
+}
+
+void DeepCFR::saveBuffers(const std::string& path) {
+    std::filesystem::create_directories(path);
+
+    for (int i = 0; i < num_players_; i++) {
+        advantage_buffers_[i]->snapshot(path + "/advantage_buffer_" + std::to_string(i) + ".snap");
+    }
+    strategy_buffer_->snapshot(path + "/strategy_buffer.snap");
+}
+
+void DeepCFR::loadBuffers(const std::string& path) {
+    for (int i = 0; i < num_players_; i++) {
+        std::string file = path + "/advantage_buffer_" + std::to_string(i) + ".snap";
+        if (!advantage_buffers_[i]->isPersistent() && std::filesystem::exists(file)) {
+            advantage_buffers_[i]->restore(file);
+            std::cout << "Restored advantage buffer " << i << " with "
+                      << advantage_buffers_[i]->size() << " samples" << std::endl;
+        }
+    }
+
+    std::string file = path + "/strategy_buffer.snap";
+    if (!strategy_buffer_->isPersistent() && std::filesystem::exists(file)) {
+        strategy_buffer_->restore(file);
+        std::cout << "Restored strategy buffer with " << strategy_buffer_->size() << " samples" << std::endl;
+    }
+}
+
+void DeepCFR::requireSnapshotBuffers() const {
+    // A disk buffer keeps replacing samples in its own file, which a checkpoint cannot roll back
+    bool persistent = strategy_buffer_->isPersistent();
+    for (const auto& buffer : advantage_buffers_) {
+        persistent = persistent || buffer->isPersistent();
+    }
+    if (persistent) {
+        throw std::logic_error("Checkpoints cannot capture disk-backed reservoir buffers");
+    }
+}
+
+void DeepCFR::saveCheckpoint(const std::string& directory, int keep) {
+    namespace fs = std::filesystem;
+    requireSnapshotBuffers();
+    fs::path root(directory);
+    fs::create_directories(root);
+
+    // A fresh temporary name every time, so the previous checkpoint is never written to
+    std::string name = "checkpoint_" + std::to_string(completed_iterations_);
+    fs::path tmp = root / (".tmp_" + name + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(tmp);
+
+    // Seed the buffer snapshots with copies (reflinks where supported) of the previous
+    // checkpoint's, so saveBuffers below only writes the samples changed since then
+    std::ifstream latest_in(root / "LATEST");
+    std::string previous;
+    if (latest_in >> previous) {
+        for (int i = 0; i <= num_players_; i++) {
+            SampleBuffer& buffer = i < num_players_ ? *advantage_buffers_[i] : *strategy_buffer_;
+            std::string file = i < num_players_ ? "advantage_buffer_" + std::to_string(i) + ".snap" : "strategy_buffer.snap";
+            buffer.cloneSnapshot((root / previous / file).string(), (tmp / file).string());
+        }
+    }
+
+    saveModels(tmp.string());
+    for (int i = 0; i < num_players_; i++) {
+        advantage_nets_[i]->saveOptimizer((tmp / ("advantage_optimizer_" + std::to_string(i) + ".pt")).string());
+    }
+    strategy_net_->saveOptimizer((tmp / "strategy_optimizer.pt").string());
+    saveBuffers(tmp.string());
+    for (auto& [file, generator] : torchGenerators()) {
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        torch::save(generator.get_state(), (tmp / file).string());
+    }
+    {
+        std::ofstream state(tmp / "state.txt");
+        state << "version 2\n"
+              << "players " << num_players_ << "\n"
+              << "actions " << num_actions_ << "\n"
+              << "seed " << seed_ << "\n"
+              << "iteration " << completed_iterations_ << "\n";
+        if (!state.flush()) {
+            throw std::runtime_error("Failed to write checkpoint state to '" + tmp.string() + "'");
+        }
+    }
+    for (const auto& entry : fs::directory_iterator(tmp)) {
+        syncPath(entry.path());
+    }
+    syncPath(tmp);
+
+    fs::path target = root / name;
+    fs::remove_all(target);
+    fs::rename(tmp, target);
+
+    // LATEST moves to the new checkpoint only once that is durable
+    {
+        std::ofstream latest(root / "LATEST.tmp", std::ios::trunc);
+        latest << name << "\n";
+        if (!latest.flush()) {
+            throw std::runtime_error("Failed to write '" + (root / "LATEST.tmp").string() + "'");
+        }
+    }
+    syncPath(root / "LATEST.tmp");
+    fs::rename(root / "LATEST.tmp", root / "LATEST");
+    syncPath(root);
+
+    // Retire the oldest checkpoints, and any temporaries an interrupted save left behind
+    std::vector<std::pair<unsigned long, fs::path>> checkpoints;
+    for (const auto& entry : fs::directory_iterator(root)) {
+        std::string file = entry.path().filename().string();
+        if (!entry.is_directory()) continue;
+        if (file.rfind(".tmp_checkpoint_", 0) == 0) {
+            fs::remove_all(entry.path());
+        } else if (file.rfind("checkpoint_", 0) == 0) {
+            checkpoints.emplace_back(std::stoul(file.substr(11)), entry.path());
+        }
+    }
+    std::sort(checkpoints.begin(), checkpoints.end());
+    for (size_t i = 0; i + std::max(keep, 1) < checkpoints.size(); i++) {
+        fs::remove_all(checkpoints[i].second);
+    }
+    std::cout << "Saved checkpoint " << target.string() << std::endl;
+}
+
+bool DeepCFR::loadCheckpoint(const std::string& directory) {
+    namespace fs = std::filesystem;
+    requireSnapshotBuffers();
+    std::ifstream latest(fs::path(directory) / "LATEST");
+    std::string name;
+    if (!(latest >> name)) {
+        return false;
+    }
+    fs::path path = fs::path(directory) / name;
+
+    std::map<std::string, uint64_t> state;
+    {
+        std::ifstream file(path / "state.txt");
+        std::string key;
+        uint64_t value;
+        while (file >> key >> value) {
+            state[key] = value;
+        }
+    }
+    if (state["version"] != 2 || !state.count("seed") || !state.count("iteration")) {
+        throw std::runtime_error("'" + path.string() + "' is not a valid checkpoint");
+    }
+    if (state["players"] != static_cast<uint64_t>(num_players_) || state["actions"] != static_cast<uint64_t>(num_actions_)) {
+        throw std::invalid_argument("Checkpoint '" + path.string() + "' was written for " + std::to_string(state["players"]) +
+                                    " players and " + std::to_string(state["actions"]) + " actions");
+    }
+
+    seed_ = state["seed"];
+    completed_iterations_ = static_cast<uint32_t>(state["iteration"]);
+
+    // Buffers restore their RNG state from their snapshots below
+    seedBuffers(completed_iterations_);
+
+    loadModels(path.string());
+    for (int i = 0; i < num_players_; i++) {
+        advantage_nets_[i]->loadOptimizer((path / ("advantage_optimizer_" + std::to_string(i) + ".pt")).string());
+    }
+    strategy_net_->loadOptimizer((path / "strategy_optimizer.pt").string());
+    loadBuffers(path.string());
+    for (auto& [file, generator] : torchGenerators()) {
+        if (!fs::exists(path / file)) {
+            throw std::runtime_error("Checkpoint '" + path.string() + "' has no " + file + " for this device");
+        }
+        torch::Tensor generator_state;
+        torch::load(generator_state, (path / file).string());
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        generator.set_state(generator_state);
+    }
+
+    // SD-CFR snapshots past the checkpoint belong to iterations about to be trained again
+    if (snapshots_) {
+        snapshots_->truncate(static_cast<int>(completed_iterations_));
+    }
+
+    std::cout << "Resumed from " << path.string() << " after iteration " << completed_iterations_ << std::endl;
+    return true;
 }
\ No newline at end of file
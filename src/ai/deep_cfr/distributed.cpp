@@ -0,0 +1,429 @@
+#include "distributed.hpp"
+#include "half.hpp"
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t FRAME_MAGIC = 0x50524D46;  // "FMRP" in memory on little-endian hosts
+constexpr uint64_t MAX_PAYLOAD = uint64_t(1) << 32;
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint64_t length;
+};
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// "tcp://host:port" -> (host, port), "unix:/path" -> path
+struct Endpoint {
+    bool is_unix = false;
+    std::string host;
+    std::string port;
+    std::string path;
+};
+
+Endpoint parseEndpoint(const std::string& endpoint) {
+    Endpoint parsed;
+    if (endpoint.rfind("unix:", 0) == 0) {
+        parsed.is_unix = true;
+        parsed.path = endpoint.substr(5);
+        if (parsed.path.empty() || parsed.path.size() >= sizeof(sockaddr_un::sun_path)) {
+            throw std::invalid_argument("Bad unix socket path in endpoint '" + endpoint + "'");
+        }
+        return parsed;
+    }
+    if (endpoint.rfind("tcp://", 0) == 0) {
+        std::string address = endpoint.substr(6);
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos && colon > 0 && colon + 1 < address.size()) {
+            parsed.host = address.substr(0, colon);
+            parsed.port = address.substr(colon + 1);
+            return parsed;
+        }
+    }
+    throw std::invalid_argument("Endpoint must be tcp://host:port or unix:/path, got '" + endpoint + "'");
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+void writeAll(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fail("Failed to send frame");
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// false if the peer closed before the first byte
+bool readAll(int fd, void* data, size_t size) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::recv(fd, bytes + done, size - done, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fail("Failed to receive frame");
+        }
+        if (n == 0) {
+            if (done == 0) return false;
+            throw std::runtime_error("Connection closed in the middle of a frame");
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+class PayloadWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void putFloats(const float* values, size_t count) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+        data_.insert(data_.end(), bytes, bytes + count * sizeof(float));
+    }
+
+    std::vector<uint8_t> take() { return std::move(data_); }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+class PayloadReader {
+public:
+    explicit PayloadReader(const std::vector<uint8_t>& data) : data_(data), offset_(0) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    void getFloats(float* values, size_t count) {
+        std::memcpy(values, advance(count * sizeof(float)), count * sizeof(float));
+    }
+
+    bool done() const { return offset_ == data_.size(); }
+
+private:
+    const std::vector<uint8_t>& data_;
+    size_t offset_;
+
+    const uint8_t* advance(size_t size) {
+        if (size > data_.size() - offset_) {
+            throw std::runtime_error("Truncated message payload");
+        }
+        const uint8_t* at = data_.data() + offset_;
+        offset_ += size;
+        return at;
+    }
+};
+
+}  // namespace
+
+Connection::Connection(int fd) : fd_(fd) {}
+
+Connection::~Connection() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+Connection::Connection(Connection&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), send_mutex_(std::move(other.send_mutex_)) {}
+
+Connection& Connection::operator=(Connection&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+        send_mutex_ = std::move(other.send_mutex_);
+    }
+    return *this;
+}
+
+Connection Connection::connect(const std::string& endpoint) {
+    Endpoint parsed = parseEndpoint(endpoint);
+
+    if (parsed.is_unix) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) fail("Failed to create socket");
+        sockaddr_un address = unixAddress(parsed.path);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            fail("Failed to connect to " + endpoint);
+        }
+        return Connection(fd);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(parsed.host.c_str(), parsed.port.c_str(), &hints, &addresses) != 0) {
+        throw std::runtime_error("Failed to resolve " + endpoint);
+    }
+    int fd = -1;
+    for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+        fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0) fail("Failed to connect to " + endpoint);
+
+    // Sample frames are written whole; don't hold their tails back
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return Connection(fd);
+}
+
+void Connection::send(MessageType type, const std::vector<uint8_t>& payload) {
+    FrameHeader header{FRAME_MAGIC, static_cast<uint32_t>(type), payload.size()};
+    std::lock_guard<std::mutex> lock(*send_mutex_);
+    writeAll(fd_, &header, sizeof(header));
+    writeAll(fd_, payload.data(), payload.size());
+}
+
+bool Connection::receive(MessageType& type, std::vector<uint8_t>& payload) {
+    FrameHeader header;
+    if (!readAll(fd_, &header, sizeof(header))) {
+        return false;
+    }
+    if (header.magic != FRAME_MAGIC) {
+        throw std::runtime_error("Bad frame magic (peer speaks another protocol or byte order)");
+    }
+    if (header.length > MAX_PAYLOAD) {
+        throw std::runtime_error("Frame payload of " + std::to_string(header.length) + " bytes is too large");
+    }
+    type = static_cast<MessageType>(header.type);
+    payload.resize(header.length);
+    if (header.length > 0 && !readAll(fd_, payload.data(), payload.size())) {
+        throw std::runtime_error("Connection closed in the middle of a frame");
+    }
+    return true;
+}
+
+void Connection::shutdown() {
+    if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);
+}
+
+Listener::Listener(const std::string& endpoint) {
+    Endpoint parsed = parseEndpoint(endpoint);
+
+    if (parsed.is_unix) {
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0) fail("Failed to create socket");
+        ::unlink(parsed.path.c_str());  // A stale socket from an earlier run
+        sockaddr_un address = unixAddress(parsed.path);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd_);
+            fail("Failed to bind " + endpoint);
+        }
+        unix_path_ = parsed.path;
+        endpoint_ = endpoint;
+    } else {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* addresses = nullptr;
+        if (::getaddrinfo(parsed.host == "*" ? nullptr : parsed.host.c_str(), parsed.port.c_str(), &hints, &addresses) != 0) {
+            throw std::runtime_error("Failed to resolve " + endpoint);
+        }
+        fd_ = ::socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+        int one = 1;
+        if (fd_ < 0 || ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+            ::bind(fd_, addresses->ai_addr, addresses->ai_addrlen) != 0) {
+            ::freeaddrinfo(addresses);
+            if (fd_ >= 0) ::close(fd_);
+            fail("Failed to bind " + endpoint);
+        }
+        ::freeaddrinfo(addresses);
+
+        // Port 0 picks a free port; report the one we got
+        sockaddr_storage bound{};
+        socklen_t length = sizeof(bound);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&bound), &length);
+        uint16_t port = bound.ss_family == AF_INET6 ? ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port)
+                                                    : ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        endpoint_ = "tcp://" + parsed.host + ":" + std::to_string(port);
+    }
+
+    if (::listen(fd_, 64) != 0) {
+        ::close(fd_);
+        fail("Failed to listen on " + endpoint);
+    }
+}
+
+Listener::~Listener() {
+    close();
+    if (fd_ >= 0) ::close(fd_);
+    if (!unix_path_.empty()) ::unlink(unix_path_.c_str());
+}
+
+Connection Listener::accept() {
+    for (;;) {
+        int fd = ::accept(fd_, nullptr, nullptr);
+        if (fd >= 0) {
+            if (unix_path_.empty()) {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            return Connection(fd);
+        }
+        if (errno != EINTR && errno != ECONNABORTED) {
+            fail("Failed to accept a connection");
+        }
+    }
+}
+
+void Listener::close() {
+    if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);
+}
+
+std::vector<uint8_t> encodeSamples(const SampleBatch& batch) {
+    if (batch.feature_size > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("Feature vectors are too wide for the sample wire format");
+    }
+
+    PayloadWriter writer;
+    writer.put<uint32_t>(static_cast<uint32_t>(batch.size()));
+    writer.put<uint32_t>(static_cast<uint32_t>(batch.feature_size));
+    writer.put<uint32_t>(static_cast<uint32_t>(batch.target_size));
+
+    std::vector<uint16_t> indices;
+    for (size_t row = 0; row < batch.size(); row++) {
+        writer.put<int32_t>(batch.buffers[row]);
+        writer.put<float>(batch.weights[row]);
+
+        const float* features = batch.features.data() + row * batch.feature_size;
+        indices.clear();
+        for (size_t i = 0; i < batch.feature_size; i++) {
+            if (features[i] != 0.0f) indices.push_back(static_cast<uint16_t>(i));
+        }
+        writer.put<uint16_t>(static_cast<uint16_t>(indices.size()));
+        for (uint16_t i : indices) {
+            writer.put<uint16_t>(i);
+            writer.put<uint16_t>(floatToHalf(features[i]));
+        }
+
+        const float* targets = batch.targets.data() + row * batch.target_size;
+        for (size_t i = 0; i < batch.target_size; i++) {
+            writer.put<uint16_t>(floatToHalf(targets[i]));
+        }
+    }
+    return writer.take();
+}
+
+SampleBatch decodeSamples(const std::vector<uint8_t>& payload, size_t feature_size, size_t target_size) {
+    PayloadReader reader(payload);
+    SampleBatch batch;
+    size_t rows = reader.get<uint32_t>();
+    batch.feature_size = reader.get<uint32_t>();
+    batch.target_size = reader.get<uint32_t>();
+    if (batch.feature_size != feature_size || batch.target_size != target_size) {
+        throw std::runtime_error("Sample batch dimensions do not match the receiver's");
+    }
+
+    // Every row takes at least its fixed fields and targets, which bounds rows before allocating
+    if (rows > payload.size() / (sizeof(int32_t) + sizeof(float) + sizeof(uint16_t) * (1 + target_size))) {
+        throw std::runtime_error("Truncated message payload");
+    }
+    batch.features.assign(rows * batch.feature_size, 0.0f);
+    batch.targets.resize(rows * batch.target_size);
+    batch.weights.resize(rows);
+    batch.buffers.resize(rows);
+
+    for (size_t row = 0; row < rows; row++) {
+        batch.buffers[row] = reader.get<int32_t>();
+        batch.weights[row] = reader.get<float>();
+
+        float* features = batch.features.data() + row * batch.feature_size;
+        size_t nonzero = reader.get<uint16_t>();
+        for (size_t k = 0; k < nonzero; k++) {
+            uint16_t i = reader.get<uint16_t>();
+            uint16_t value = reader.get<uint16_t>();
+            if (i >= batch.feature_size) {
+                throw std::runtime_error("Sample feature index out of range");
+            }
+            features[i] = halfToFloat(value);
+        }
+
+        float* targets = batch.targets.data() + row * batch.target_size;
+        for (size_t i = 0; i < batch.target_size; i++) {
+            targets[i] = halfToFloat(reader.get<uint16_t>());
+        }
+    }
+    if (!reader.done()) {
+        throw std::runtime_error("Trailing bytes after sample batch");
+    }
+    return batch;
+}
+
+std::vector<uint8_t> encodeWeights(const WeightsMessage& message) {
+    PayloadWriter writer;
+    writer.put<uint32_t>(message.iteration);
+    writer.put<int32_t>(message.net);
+    writer.put<uint32_t>(static_cast<uint32_t>(message.layers.size()));
+    for (const DenseLayer& layer : message.layers) {
+        writer.put<uint64_t>(layer.input_size);
+        writer.put<uint64_t>(layer.output_size);
+        writer.putFloats(layer.weight.data(), layer.weight.size());
+        writer.putFloats(layer.bias.data(), layer.bias.size());
+    }
+    return writer.take();
+}
+
+WeightsMessage decodeWeights(const std::vector<uint8_t>& payload) {
+    PayloadReader reader(payload);
+    WeightsMessage message;
+    message.iteration = reader.get<uint32_t>();
+    message.net = reader.get<int32_t>();
+    uint32_t num_layers = reader.get<uint32_t>();
+    for (uint32_t l = 0; l < num_layers; l++) {
+        DenseLayer layer;
+        layer.input_size = reader.get<uint64_t>();
+        layer.output_size = reader.get<uint64_t>();
+        // Divided rather than multiplied, so sizes near 2^64 cannot wrap past the check
+        if (layer.input_size == 0 || layer.output_size == 0 ||
+            layer.output_size > payload.size() / sizeof(float) / layer.input_size) {
+            throw std::runtime_error("Corrupt layer dimensions in weights message");
+        }
+        layer.weight.resize(layer.input_size * layer.output_size);
+        layer.bias.resize(layer.output_size);
+        reader.getFloats(layer.weight.data(), layer.weight.size());
+        reader.getFloats(layer.bias.data(), layer.bias.size());
+        message.layers.push_back(std::move(layer));
+    }
+    if (!reader.done()) {
+        throw std::runtime_error("Trailing bytes after weights message");
+    }
+    return message;
+}
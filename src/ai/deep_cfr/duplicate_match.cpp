@@ -0,0 +1,121 @@
+#include "duplicate_match.hpp"
+#include "thread_pool.hpp"
+#include "util/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+double reduction(const WinRate& single, const WinRate& estimate) {
+    return estimate.std_error > 0.0 ? (single.std_error * single.std_error) / (estimate.std_error * estimate.std_error) : 0.0;
+}
+
+}  // namespace
+
+double MatchResult::duplicateReduction() const {
+    return reduction(single, duplicate);
+}
+
+double MatchResult::aivatReduction() const {
+    return reduction(single, aivat);
+}
+
+std::string MatchResult::toString() const {
+    std::ostringstream out;
+    out << "single:    " << single.toString() << "\n"
+        << "duplicate: " << duplicate.toString() << " (" << duplicateReduction() << "x fewer hands)\n"
+        << "AIVAT:     " << aivat.toString() << " (" << aivatReduction() << "x fewer hands)";
+    return out.str();
+}
+
+DuplicateMatch::DuplicateMatch(DeepCFR& a, DeepCFR& b, const MatchConfig& config) : a_(a), b_(b), config_(config) {
+    if (a.getNumPlayers() != 2 || b.getNumPlayers() != 2) {
+        throw std::invalid_argument("Duplicate matches are heads-up only");
+    }
+    if (config_.deals <= 0 || config_.big_blind <= 0) {
+        throw std::invalid_argument("A match needs a positive deal count and big blind");
+    }
+}
+
+MatchResult DuplicateMatch::run() {
+    TRACE_SCOPE("DuplicateMatch::run");
+    size_t threads = config_.threads > 0 ? config_.threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t deals = static_cast<size_t>(config_.deals);
+    std::vector<double> singles(2 * deals);
+    std::vector<double> pairs(deals);
+    std::vector<double> corrected_pairs(deals);
+    pool.parallelFor(0, deals, 1, [&](size_t deal, size_t) {
+        double corrected_0 = 0.0;
+        double corrected_1 = 0.0;
+        singles[2 * deal] = playHand(deal, 0, corrected_0);
+        singles[2 * deal + 1] = playHand(deal, 1, corrected_1);
+        pairs[deal] = 0.5 * (singles[2 * deal] + singles[2 * deal + 1]);
+        corrected_pairs[deal] = 0.5 * (corrected_0 + corrected_1);
+    });
+
+    // A pair is scored per game, so all three rates are over the same 2 * deals games
+    MatchResult result;
+    result.single = WinRate::fromWinnings(singles, config_.big_blind);
+    result.duplicate = WinRate::fromWinnings(pairs, config_.big_blind);
+    result.aivat = WinRate::fromWinnings(corrected_pairs, config_.big_blind);
+    result.duplicate.hands = result.aivat.hands = singles.size();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << result.toString() << "\n"
+              << static_cast<long long>(seconds > 0.0 ? singles.size() / seconds : 0.0) << " hands/sec on "
+              << threads << " threads" << std::endl;
+    return result;
+}
+
+double DuplicateMatch::playHand(size_t deal, int a_seat, double& corrected) {
+    TRACE_SCOPE("DuplicateMatch::playHand");
+    // Both halves of a pair see the same cards and the same action uniforms
+    uint32_t index = static_cast<uint32_t>(deal);
+    Philox4x32 cards(config_.seed, 0, 0, index, RngPurpose::DEAL);
+    Philox4x32 actions(config_.seed, 0, 0, index, RngPurpose::ACTION);
+
+    Game game(2, config_.starting_chips, config_.small_blind, config_.big_blind);
+    game.startHand(Deck(cards), static_cast<int>(deal % 2));
+
+    double correction = 0.0;
+    while (!game.isHandComplete()) {
+        int player = game.getCurrentPlayer();
+        DeepCFR& agent = player == a_seat ? a_ : b_;
+        InfoState state = InfoState::fromGame(game, player);
+        std::vector<Action> legal_actions = state.getLegalActions();
+
+        std::vector<float> probs = DeepCFR::regretMatching(agent.getActionProbabilities(state), legal_actions.size());
+        float r = actions.uniform();
+        float cumulative = 0.0f;
+        size_t chosen = legal_actions.size() - 1;
+        for (size_t i = 0; i < legal_actions.size(); i++) {
+            cumulative += probs[i];
+            if (r < cumulative) {
+                chosen = i;
+                break;
+            }
+        }
+
+        std::vector<float> values = agent.getActionAdvantages(state);
+        double expected = 0.0;
+        for (size_t i = 0; i < legal_actions.size(); i++) {
+            expected += probs[i] * values[i];
+        }
+        double term = expected - values[chosen];
+        correction += player == a_seat ? term : -term;
+
+        game.takeAction(legal_actions[chosen]);
+    }
+
+    // Advantages are in traversal payoff units, which traverseCFR normalizes by the stacks
+    double winnings = static_cast<double>(game.getPlayers()[a_seat]->getChips() - config_.starting_chips);
+    corrected = winnings + correction * game.getInitialStackTotal();
+    return winnings;
+}
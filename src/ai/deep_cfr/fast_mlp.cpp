@@ -0,0 +1,344 @@
+#include "fast_mlp.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FAST_MLP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t W = FastMLP::PANEL_WIDTH;
+
+// Rows sharing one pass over a weight panel; bounded by the accumulator registers available
+constexpr size_t ROW_BLOCK = 4;
+
+// A row block only skips an input when it is zero in every row, so it costs extra FMAs
+// unless activations are dense; sparse ones (one-hot features, most ReLU outputs) go one
+// row at a time and keep their per-row zero skipping
+constexpr float BLOCK_MIN_DENSITY = 0.9f;
+
+// Branch-free compaction of the inputs that are nonzero in any of rows; returns the count
+size_t collectActive(const float* in, size_t in_stride, size_t rows, size_t input_size, uint32_t* active) {
+    size_t n = 0;
+    for (size_t i = 0; i < input_size; i++) {
+        bool any = false;
+        for (size_t r = 0; r < rows; r++) {
+            any |= in[r * in_stride + i] != 0.0f;
+        }
+        active[n] = static_cast<uint32_t>(i);
+        n += any;
+    }
+    return n;
+}
+
+// Applies one weight panel to a block of rows, visiting only the inputs listed in active
+// (the inputs that are nonzero in at least one row of the block)
+using PanelKernel = void (*)(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+                             const float* in, size_t in_stride, size_t rows,
+                             float* out, size_t out_stride, bool relu);
+
+void panelScalar(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+                 const float* in, size_t in_stride, size_t rows,
+                 float* out, size_t out_stride, bool relu) {
+    for (size_t r = 0; r < rows; r++) {
+        const float* x = in + r * in_stride;
+        float acc[W];
+        std::copy(bias, bias + W, acc);
+        for (size_t k = 0; k < num_active; k++) {
+            const size_t i = active[k];
+            const float* w = panel + i * W;
+            for (size_t j = 0; j < W; j++) {
+                acc[j] += x[i] * w[j];
+            }
+        }
+        float* y = out + r * out_stride;
+        for (size_t j = 0; j < W; j++) {
+            y[j] = relu ? std::max(acc[j], 0.0f) : acc[j];
+        }
+    }
+}
+
+#ifdef FAST_MLP_X86
+
+template <size_t R>
+__attribute__((target("avx2,fma")))
+void panelAvx2Rows(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+                   const float* in, size_t in_stride, float* out, size_t out_stride, bool relu) {
+    __m256 acc[R][2];
+    for (size_t r = 0; r < R; r++) {
+        acc[r][0] = _mm256_loadu_ps(bias);
+        acc[r][1] = _mm256_loadu_ps(bias + 8);
+    }
+
+    for (size_t k = 0; k < num_active; k++) {
+        const size_t i = active[k];
+        float x[R];
+        for (size_t r = 0; r < R; r++) {
+            x[r] = in[r * in_stride + i];
+        }
+
+        __m256 w0 = _mm256_loadu_ps(panel + i * W);
+        __m256 w1 = _mm256_loadu_ps(panel + i * W + 8);
+        for (size_t r = 0; r < R; r++) {
+            __m256 xr = _mm256_set1_ps(x[r]);
+            acc[r][0] = _mm256_fmadd_ps(xr, w0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(xr, w1, acc[r][1]);
+        }
+    }
+
+    __m256 zero = _mm256_setzero_ps();
+    for (size_t r = 0; r < R; r++) {
+        if (relu) {
+            acc[r][0] = _mm256_max_ps(acc[r][0], zero);
+            acc[r][1] = _mm256_max_ps(acc[r][1], zero);
+        }
+        _mm256_storeu_ps(out + r * out_stride, acc[r][0]);
+        _mm256_storeu_ps(out + r * out_stride + 8, acc[r][1]);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void panelAvx2(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+               const float* in, size_t in_stride, size_t rows,
+               float* out, size_t out_stride, bool relu) {
+    switch (rows) {
+        case 1: panelAvx2Rows<1>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        case 2: panelAvx2Rows<2>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        case 3: panelAvx2Rows<3>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        default: panelAvx2Rows<4>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+    }
+}
+
+template <size_t R>
+__attribute__((target("avx512f")))
+void panelAvx512Rows(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+                     const float* in, size_t in_stride, float* out, size_t out_stride, bool relu) {
+    __m512 acc[R];
+    for (size_t r = 0; r < R; r++) {
+        acc[r] = _mm512_loadu_ps(bias);
+    }
+
+    for (size_t k = 0; k < num_active; k++) {
+        const size_t i = active[k];
+        float x[R];
+        for (size_t r = 0; r < R; r++) {
+            x[r] = in[r * in_stride + i];
+        }
+
+        __m512 w = _mm512_loadu_ps(panel + i * W);
+        for (size_t r = 0; r < R; r++) {
+            acc[r] = _mm512_fmadd_ps(_mm512_set1_ps(x[r]), w, acc[r]);
+        }
+    }
+
+    __m512 zero = _mm512_setzero_ps();
+    for (size_t r = 0; r < R; r++) {
+        if (relu) {
+            acc[r] = _mm512_mask_max_ps(acc[r], 0xFFFF, acc[r], zero);
+        }
+        _mm512_storeu_ps(out + r * out_stride, acc[r]);
+    }
+}
+
+__attribute__((target("avx512f")))
+void panelAvx512(const float* panel, const float* bias, const uint32_t* active, size_t num_active,
+                 const float* in, size_t in_stride, size_t rows,
+                 float* out, size_t out_stride, bool relu) {
+    switch (rows) {
+        case 1: panelAvx512Rows<1>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        case 2: panelAvx512Rows<2>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        case 3: panelAvx512Rows<3>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+        default: panelAvx512Rows<4>(panel, bias, active, num_active, in, in_stride, out, out_stride, relu); break;
+    }
+}
+
+#endif
+
+PanelKernel kernelFor(FastMLP::Isa isa) {
+    switch (isa) {
+#ifdef FAST_MLP_X86
+        case FastMLP::Isa::AVX512: return panelAvx512;
+        case FastMLP::Isa::AVX2: return panelAvx2;
+#endif
+        default: return panelScalar;
+    }
+}
+
+bool isaSupported(FastMLP::Isa isa) {
+    switch (isa) {
+        case FastMLP::Isa::SCALAR: return true;
+#ifdef FAST_MLP_X86
+        case FastMLP::Isa::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case FastMLP::Isa::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+size_t roundUp(size_t count, size_t multiple) {
+    return (count + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+FastMLP::FastMLP() : isa_(detectIsa()), max_width_(0), max_input_(0) {}
+
+FastMLP::FastMLP(const std::vector<DenseLayer>& layers) : isa_(detectIsa()), max_width_(0), max_input_(0) {
+    // One aligned block for all layers; each section starts on an ALIGNMENT boundary
+    const size_t floats_per_line = ALIGNMENT / sizeof(float);
+    size_t total = 0;
+    for (const auto& layer : layers) {
+        total += roundUp(packedWeightCount(layer.input_size, layer.output_size), floats_per_line);
+        total += roundUp(packedBiasCount(layer.output_size), floats_per_line);
+    }
+
+    float* block = static_cast<float*>(std::aligned_alloc(ALIGNMENT, std::max<size_t>(total, 1) * sizeof(float)));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    storage_ = std::shared_ptr<const void>(block, std::free);
+
+    float* cursor = block;
+    for (const auto& layer : layers) {
+        if (layer.weight.size() != layer.input_size * layer.output_size || layer.bias.size() != layer.output_size) {
+            throw std::invalid_argument("DenseLayer weight/bias sizes do not match its dimensions");
+        }
+        float* weights = cursor;
+        cursor += roundUp(packedWeightCount(layer.input_size, layer.output_size), floats_per_line);
+        float* bias = cursor;
+        cursor += roundUp(packedBiasCount(layer.output_size), floats_per_line);
+
+        packLayer(layer, weights, bias);
+        layers_.push_back({layer.input_size, layer.output_size, weights, bias});
+    }
+    validate();
+}
+
+FastMLP::FastMLP(std::vector<Layer> layers, std::shared_ptr<const void> storage)
+    : layers_(std::move(layers)), storage_(std::move(storage)), isa_(detectIsa()), max_width_(0), max_input_(0) {
+    validate();
+}
+
+size_t FastMLP::packedWeightCount(size_t input_size, size_t output_size) {
+    return roundUp(output_size, PANEL_WIDTH) * input_size;
+}
+
+size_t FastMLP::packedBiasCount(size_t output_size) {
+    return roundUp(output_size, PANEL_WIDTH);
+}
+
+void FastMLP::packLayer(const DenseLayer& layer, float* weights_out, float* bias_out) {
+    const size_t panels = (layer.output_size + PANEL_WIDTH - 1) / PANEL_WIDTH;
+    for (size_t p = 0; p < panels; p++) {
+        float* panel = weights_out + p * layer.input_size * PANEL_WIDTH;
+        for (size_t i = 0; i < layer.input_size; i++) {
+            for (size_t j = 0; j < PANEL_WIDTH; j++) {
+                size_t o = p * PANEL_WIDTH + j;
+                panel[i * PANEL_WIDTH + j] = o < layer.output_size ? layer.weight[o * layer.input_size + i] : 0.0f;
+            }
+        }
+        for (size_t j = 0; j < PANEL_WIDTH; j++) {
+            size_t o = p * PANEL_WIDTH + j;
+            bias_out[p * PANEL_WIDTH + j] = o < layer.output_size ? layer.bias[o] : 0.0f;
+        }
+    }
+}
+
+void FastMLP::validate() {
+    for (size_t l = 0; l < layers_.size(); l++) {
+        if (l > 0 && layers_[l].input_size != layers_[l - 1].output_size) {
+            throw std::invalid_argument("FastMLP layer " + std::to_string(l) + " input size does not match the previous layer");
+        }
+        max_width_ = std::max(max_width_, layers_[l].paddedOutputSize());
+        max_input_ = std::max(max_input_, layers_[l].input_size);
+    }
+}
+
+FastMLP::Isa FastMLP::detectIsa() {
+    if (isaSupported(Isa::AVX512)) return Isa::AVX512;
+    if (isaSupported(Isa::AVX2)) return Isa::AVX2;
+    return Isa::SCALAR;
+}
+
+void FastMLP::setIsa(Isa isa) {
+    isa_ = isaSupported(isa) ? isa : detectIsa();
+}
+
+void FastMLP::forward(const float* inputs, size_t rows, float* outputs) const {
+    if (layers_.empty()) return;
+
+    // Ping-pong activations for one chunk; reused across calls on the same thread
+    thread_local std::vector<float> scratch[2];
+    thread_local std::vector<uint32_t> active;
+    for (auto& buffer : scratch) {
+        if (buffer.size() < ROW_BLOCK * max_width_) buffer.resize(ROW_BLOCK * max_width_);
+    }
+    if (active.size() < ROW_BLOCK * max_input_) active.resize(ROW_BLOCK * max_input_);
+    size_t block_active[ROW_BLOCK];
+
+    PanelKernel kernel = kernelFor(isa_);
+    const size_t input_size = inputSize();
+    const size_t output_size = outputSize();
+
+    for (size_t chunk = 0; chunk < rows; chunk += ROW_BLOCK) {
+        const size_t chunk_rows = std::min(ROW_BLOCK, rows - chunk);
+        const float* in = inputs + chunk * input_size;
+        size_t in_stride = input_size;
+
+        for (size_t l = 0; l < layers_.size(); l++) {
+            const Layer& layer = layers_[l];
+            const bool relu = l + 1 < layers_.size();
+            float* out = scratch[l % 2].data();
+            const size_t out_stride = layer.paddedOutputSize();
+
+            // Index each row's active inputs once; their count decides whether blocking rows pays off
+            size_t nonzero = 0;
+            for (size_t r = 0; r < chunk_rows; r++) {
+                block_active[r] = collectActive(in + r * in_stride, in_stride, 1, layer.input_size,
+                                                active.data() + r * max_input_);
+                nonzero += block_active[r];
+            }
+
+            size_t row_block = 1;
+            if (chunk_rows > 1 && nonzero >= BLOCK_MIN_DENSITY * chunk_rows * layer.input_size) {
+                row_block = chunk_rows;
+                block_active[0] = collectActive(in, in_stride, chunk_rows, layer.input_size, active.data());
+            }
+            const size_t num_blocks = chunk_rows / row_block;
+
+            for (size_t b = 0; b < num_blocks; b++) {
+                const size_t r = b * row_block;
+                for (size_t p = 0; p < layer.panels(); p++) {
+                    kernel(layer.weights + p * layer.input_size * PANEL_WIDTH, layer.bias + p * PANEL_WIDTH,
+                           active.data() + b * max_input_, block_active[b],
+                           in + r * in_stride, in_stride, row_block,
+                           out + r * out_stride + p * PANEL_WIDTH, out_stride, relu);
+                }
+            }
+
+            in = out;
+            in_stride = out_stride;
+        }
+
+        for (size_t r = 0; r < chunk_rows; r++) {
+            std::memcpy(outputs + (chunk + r) * output_size, in + r * in_stride, output_size * sizeof(float));
+        }
+    }
+}
+
+std::vector<float> FastMLP::predict(const std::vector<float>& features) const {
+    if (features.size() != inputSize()) {
+        throw std::invalid_argument("FastMLP expects " + std::to_string(inputSize()) +
+                                    " features, got " + std::to_string(features.size()));
+    }
+    std::vector<float> result(outputSize());
+    forward(features.data(), 1, result.data());
+    return result;
+}
@@ -0,0 +1,145 @@
+#include "hand_range.hpp"
+#include "evaluator.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+std::vector<Card> buildDeck() {
+    const std::string ranks = "23456789TJQKA";
+    const std::string suits = "shdc";
+    std::vector<Card> cards;
+    for (char rank : ranks) {
+        for (char suit : suits) {
+            cards.emplace_back(std::string{rank, suit});
+        }
+    }
+    return cards;
+}
+
+std::vector<std::pair<int, int>> buildCombos() {
+    std::vector<std::pair<int, int>> combos;
+    for (int first = 0; first < static_cast<int>(HandRange::NUM_CARDS); first++) {
+        for (int second = first + 1; second < static_cast<int>(HandRange::NUM_CARDS); second++) {
+            combos.emplace_back(first, second);
+        }
+    }
+    return combos;
+}
+
+}  // namespace
+
+HandRange::HandRange() {
+    weights_.fill(1.0f);
+}
+
+const std::vector<Card>& HandRange::deck() {
+    static const std::vector<Card> cards = buildDeck();
+    return cards;
+}
+
+int HandRange::cardIndex(const Card& card) {
+    static const std::unordered_map<int, int> indices = []() {
+        std::unordered_map<int, int> map;
+        for (size_t i = 0; i < NUM_CARDS; i++) {
+            map[deck()[i].toInt()] = static_cast<int>(i);
+        }
+        return map;
+    }();
+    auto it = indices.find(card.toInt());
+    if (it == indices.end()) {
+        throw std::invalid_argument("Not a card: " + std::to_string(card.toInt()));
+    }
+    return it->second;
+}
+
+const std::pair<int, int>& HandRange::combo(size_t index) {
+    static const std::vector<std::pair<int, int>> combos = buildCombos();
+    return combos.at(index);
+}
+
+std::vector<Card> HandRange::comboCards(size_t index) {
+    const auto& cards = combo(index);
+    return {deck()[cards.first], deck()[cards.second]};
+}
+
+size_t HandRange::comboIndex(const Card& first, const Card& second) {
+    int a = cardIndex(first);
+    int b = cardIndex(second);
+    if (a == b) {
+        throw std::invalid_argument("A combo needs two different cards");
+    }
+    if (a > b) std::swap(a, b);
+    // Combos with a smaller first card come first: 51 + 50 + ... for each of them
+    return static_cast<size_t>(a * (2 * static_cast<int>(NUM_CARDS) - a - 1) / 2 + (b - a - 1));
+}
+
+double HandRange::total() const {
+    return std::accumulate(weights_.begin(), weights_.end(), 0.0);
+}
+
+void HandRange::removeCards(const std::vector<Card>& cards) {
+    std::array<bool, NUM_CARDS> dead{};
+    for (const Card& card : cards) {
+        dead[cardIndex(card)] = true;
+    }
+    for (size_t i = 0; i < NUM_COMBOS; i++) {
+        if (dead[combo(i).first] || dead[combo(i).second]) {
+            weights_[i] = 0.0f;
+        }
+    }
+}
+
+std::vector<size_t> HandRange::liveCombos() const {
+    std::vector<size_t> live;
+    for (size_t i = 0; i < NUM_COMBOS; i++) {
+        if (weights_[i] > 0.0f) live.push_back(i);
+    }
+    return live;
+}
+
+double HandRange::equity(const std::vector<Card>& hole, const std::vector<Card>& board, int runouts, Philox4x32& rng) const {
+    std::array<bool, NUM_CARDS> dead{};
+    for (const Card& card : hole) dead[cardIndex(card)] = true;
+    for (const Card& card : board) dead[cardIndex(card)] = true;
+
+    std::vector<size_t> live;
+    for (size_t i : liveCombos()) {
+        if (!dead[combo(i).first] && !dead[combo(i).second]) live.push_back(i);
+    }
+    std::vector<int> remaining;
+    for (int c = 0; c < static_cast<int>(NUM_CARDS); c++) {
+        if (!dead[c]) remaining.push_back(c);
+    }
+
+    size_t to_come = 5 - std::min<size_t>(5, board.size());
+    int boards = to_come == 0 ? 1 : std::max(1, runouts);
+
+    double won = 0.0;
+    double total = 0.0;
+    std::vector<Card> full_board = board;
+    for (int r = 0; r < boards; r++) {
+        // Complete the board by a partial Fisher-Yates over the unseen cards
+        std::array<bool, NUM_CARDS> drawn{};
+        full_board.resize(board.size(), deck()[0]);
+        for (size_t j = 0; j < to_come; j++) {
+            size_t k = j + rng.below(static_cast<uint32_t>(remaining.size() - j));
+            std::swap(remaining[j], remaining[k]);
+            drawn[remaining[j]] = true;
+            full_board.push_back(deck()[remaining[j]]);
+        }
+
+        int rank = Evaluator::evaluate(hole, full_board);  // Lower is stronger
+        for (size_t i : live) {
+            const auto& cards = combo(i);
+            if (drawn[cards.first] || drawn[cards.second]) continue;
+            int opponent = Evaluator::evaluate(comboCards(i), full_board);
+            float w = weights_[i];
+            won += rank < opponent ? w : rank == opponent ? 0.5 * w : 0.0;
+            total += w;
+        }
+    }
+    return total > 0.0 ? won / total : 0.5;
+}
@@ -0,0 +1,106 @@
+#include "inference_broker.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+InferenceBroker::InferenceBroker(BatchFunction predict_batch,
+                                 size_t input_size,
+                                 size_t output_size,
+                                 size_t max_batch_size,
+                                 std::chrono::microseconds max_delay)
+    : predict_batch_(std::move(predict_batch)),
+      input_size_(input_size),
+      output_size_(output_size),
+      max_batch_size_(std::max<size_t>(1, max_batch_size)),
+      max_delay_(max_delay),
+      stopping_(false),
+      batches_(0),
+      requests_(0) {
+    worker_ = std::thread(&InferenceBroker::run, this);
+}
+
+InferenceBroker::~InferenceBroker() {
+    stop();
+}
+
+std::future<std::vector<float>> InferenceBroker::submit(std::vector<float> features) {
+    if (features.size() != input_size_) {
+        throw std::invalid_argument("Feature row size does not match the broker's input size");
+    }
+    Request request;
+    request.features = std::move(features);
+    std::future<std::vector<float>> result = request.result.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            throw std::runtime_error("InferenceBroker is stopped");
+        }
+        request.enqueued = std::chrono::steady_clock::now();
+        queue_.push_back(std::move(request));
+    }
+    cv_.notify_one();
+    return result;
+}
+
+void InferenceBroker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void InferenceBroker::run() {
+    std::vector<Request> batch;
+    std::vector<float> inputs;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;  // Stopping and fully drained
+            }
+
+            // Give other threads until the oldest request has waited max_delay to fill the batch
+            auto deadline = queue_.front().enqueued + max_delay_;
+            cv_.wait_until(lock, deadline, [this]() {
+                return stopping_ || queue_.size() >= max_batch_size_;
+            });
+
+            size_t take = std::min(queue_.size(), max_batch_size_);
+            batch.clear();
+            for (size_t i = 0; i < take; i++) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        inputs.resize(batch.size() * input_size_);
+        for (size_t i = 0; i < batch.size(); i++) {
+            std::copy(batch[i].features.begin(), batch[i].features.end(), inputs.begin() + i * input_size_);
+        }
+
+        // Counted before any caller wakes, so a caller that has its result sees it included
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        requests_.fetch_add(batch.size(), std::memory_order_relaxed);
+
+        try {
+            std::vector<float> outputs = predict_batch_(inputs.data(), static_cast<int64_t>(batch.size()));
+            if (outputs.size() != batch.size() * output_size_) {
+                throw std::runtime_error("Batch function returned the wrong number of outputs");
+            }
+            for (size_t i = 0; i < batch.size(); i++) {
+                batch[i].result.set_value(std::vector<float>(outputs.begin() + i * output_size_,
+                                                             outputs.begin() + (i + 1) * output_size_));
+            }
+        } catch (...) {
+            for (auto& request : batch) {
+                request.result.set_exception(std::current_exception());
+            }
+        }
+    }
+}
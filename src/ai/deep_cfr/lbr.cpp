@@ -0,0 +1,173 @@
+#include "lbr.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+LocalBestResponse::LocalBestResponse(DeepCFR& strategy, const LbrConfig& config)
+    : strategy_(strategy), config_(config) {
+    if (strategy.getNumPlayers() != 2) {
+        throw std::invalid_argument("LBR evaluates heads-up strategies only");
+    }
+    if (config_.hands <= 0 || config_.big_blind <= 0) {
+        throw std::invalid_argument("LBR needs a positive hand count and big blind");
+    }
+}
+
+WinRate LocalBestResponse::evaluate() {
+    size_t threads = config_.threads > 0 ? config_.threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> winnings(config_.hands, 0.0);
+    pool.parallelFor(0, winnings.size(), 1, [&](size_t hand, size_t) { winnings[hand] = playHand(hand); });
+
+    WinRate rate = WinRate::fromWinnings(winnings, config_.big_blind);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "LBR: " << rate.toString() << " (" << static_cast<long long>(seconds > 0.0 ? rate.hands / seconds : 0.0)
+              << " hands/sec on " << threads << " threads)" << std::endl;
+    return rate;
+}
+
+double LocalBestResponse::playHand(size_t hand) {
+    uint32_t index = static_cast<uint32_t>(hand);
+    Philox4x32 deal(config_.seed, 0, 0, index, RngPurpose::DEAL);
+    Philox4x32 actions(config_.seed, 0, 0, index, RngPurpose::ACTION);
+    Philox4x32 sampling(config_.seed, 0, 0, index, RngPurpose::SAMPLING);
+
+    Game game(2, config_.starting_chips, config_.small_blind, config_.big_blind);
+    game.startHand(Deck(deal), static_cast<int>(hand % 2));
+
+    // LBR only knows its own cards and the board
+    HandRange range;
+    range.removeCards(game.getPlayers()[LBR_SEAT]->getHand());
+    size_t board_seen = 0;
+
+    while (!game.isHandComplete()) {
+        const std::vector<Card>& board = game.getBoard();
+        if (board.size() > board_seen) {
+            range.removeCards(std::vector<Card>(board.begin() + board_seen, board.end()));
+            board_seen = board.size();
+        }
+
+        int player = game.getCurrentPlayer();
+        InfoState state = InfoState::fromGame(game, player);
+        std::vector<Action> legal_actions = state.getLegalActions();
+
+        if (player == LBR_SEAT) {
+            game.takeAction(bestResponse(game, legal_actions, range, sampling));
+            continue;
+        }
+
+        // One batch over the range serves both the strategy's own decision and the update
+        const std::vector<Card>& hole = game.getPlayers()[STRATEGY_SEAT]->getHand();
+        size_t actual = HandRange::comboIndex(hole[0], hole[1]);
+        std::vector<size_t> combos = range.liveCombos();
+        if (range.weight(actual) <= 0.0f) {
+            combos.push_back(actual);  // Its weight underflowed; it still has to act
+        }
+        std::vector<InfoState> states;
+        states.reserve(combos.size());
+        size_t actual_row = 0;
+        for (size_t i = 0; i < combos.size(); i++) {
+            if (combos[i] == actual) actual_row = i;
+            states.push_back(state.withHoleCards(HandRange::comboCards(combos[i])));
+        }
+        std::vector<std::vector<float>> outputs = strategy_.getActionProbabilities(states);
+
+        std::vector<float> probs = DeepCFR::regretMatching(outputs[actual_row], legal_actions.size());
+        float r = actions.uniform();
+        float cumulative = 0.0f;
+        size_t chosen = legal_actions.size() - 1;
+        for (size_t i = 0; i < legal_actions.size(); i++) {
+            cumulative += probs[i];
+            if (r < cumulative) {
+                chosen = i;
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < combos.size(); i++) {
+            float p = DeepCFR::regretMatching(outputs[i], legal_actions.size())[chosen];
+            range.setWeight(combos[i], range.weight(combos[i]) * p);
+        }
+        game.takeAction(legal_actions[chosen]);
+    }
+
+    return static_cast<double>(game.getPlayers()[LBR_SEAT]->getChips() - config_.starting_chips);
+}
+
+Action LocalBestResponse::bestResponse(const Game& game, const std::vector<Action>& legal_actions,
+                                       const HandRange& range, Philox4x32& rng) {
+    const auto& lbr = game.getPlayers()[LBR_SEAT];
+    double wp = range.equity(lbr->getHand(), game.getBoard(), config_.runouts, rng);
+    double pot = 0.0;
+    for (const auto& p : game.getPots()) {
+        pot += p->get_amount();
+    }
+    double to_call = game.getPots().back()->chips_to_call(LBR_SEAT);
+
+    double best_value = -std::numeric_limits<double>::infinity();
+    size_t best = 0;
+    for (size_t i = 0; i < legal_actions.size(); i++) {
+        double value = 0.0;
+        switch (legal_actions[i].getActionType()) {
+            case ActionType::FOLD:
+                value = 0.0;
+                break;
+            case ActionType::CHECK:
+            case ActionType::CALL:
+                value = wp * pot - (1.0 - wp) * to_call;
+                break;
+            case ActionType::RAISE:
+            case ActionType::ALL_IN: {
+                // A raise adds its amount (capped at the stack), an all-in the whole stack; the
+                // range answers how often it folds, on a copy of the hand
+                double cost = legal_actions[i].getActionType() == ActionType::ALL_IN
+                                  ? lbr->getChips()
+                                  : std::min(legal_actions[i].getAmount(), lbr->getChips());
+                Game next = game;
+                next.takeAction(legal_actions[i]);
+                double fp = !next.isHandComplete() && next.getCurrentPlayer() == STRATEGY_SEAT
+                                ? foldProbability(next, range) : 0.0;
+                value = fp * pot + (1.0 - fp) * (wp * (pot + cost) - (1.0 - wp) * cost);
+                break;
+            }
+        }
+        if (value > best_value) {
+            best_value = value;
+            best = i;
+        }
+    }
+    return legal_actions[best];
+}
+
+double LocalBestResponse::foldProbability(const Game& game, const HandRange& range) {
+    InfoState state = InfoState::fromGame(game, STRATEGY_SEAT);
+    std::vector<Action> legal_actions = state.getLegalActions();
+    size_t fold = legal_actions.size();
+    for (size_t i = 0; i < legal_actions.size(); i++) {
+        if (legal_actions[i].getActionType() == ActionType::FOLD) fold = i;
+    }
+    if (fold == legal_actions.size()) return 0.0;
+
+    std::vector<size_t> combos = range.liveCombos();
+    std::vector<InfoState> states;
+    states.reserve(combos.size());
+    for (size_t combo : combos) {
+        states.push_back(state.withHoleCards(HandRange::comboCards(combo)));
+    }
+    std::vector<std::vector<float>> outputs = strategy_.getActionProbabilities(states);
+
+    double folded = 0.0;
+    double total = 0.0;
+    for (size_t i = 0; i < combos.size(); i++) {
+        double w = range.weight(combos[i]);
+        folded += w * DeepCFR::regretMatching(outputs[i], legal_actions.size())[fold];
+        total += w;
+    }
+    return total > 0.0 ? folded / total : 0.0;
+}
@@ -0,0 +1,110 @@
+#include "metrics.hpp"
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char* PHASE_NAMES[NUM_PHASES] = {"traversal", "encoding", "inference", "buffer_insert", "batch_assembly", "sgd"};
+const char* COUNTER_NAMES[NUM_COUNTERS] = {"traversals", "nodes", "advantage_samples", "strategy_samples",
+                                           "inference_calls", "training_steps", "training_rows"};
+
+double rate(uint64_t count, double seconds) {
+    return seconds > 0.0 ? count / seconds : 0.0;
+}
+
+double meanTrainingBatch(const MetricsCounts& counts) {
+    uint64_t steps = counts.count(Counter::TRAINING_STEPS);
+    return steps > 0 ? static_cast<double>(counts.count(Counter::TRAINING_ROWS)) / steps : 0.0;
+}
+
+}  // namespace
+
+const char* phaseName(Phase phase) {
+    return PHASE_NAMES[static_cast<size_t>(phase)];
+}
+
+const char* counterName(Counter counter) {
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+MetricsCounts& MetricsCounts::operator+=(const MetricsCounts& other) {
+    for (size_t i = 0; i < NUM_PHASES; i++) {
+        phase_nanos[i] += other.phase_nanos[i];
+        phase_calls[i] += other.phase_calls[i];
+    }
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+        counters[i] += other.counters[i];
+    }
+    return *this;
+}
+
+MetricsCounts MetricsCounts::operator-(const MetricsCounts& other) const {
+    MetricsCounts delta;
+    for (size_t i = 0; i < NUM_PHASES; i++) {
+        delta.phase_nanos[i] = phase_nanos[i] - other.phase_nanos[i];
+        delta.phase_calls[i] = phase_calls[i] - other.phase_calls[i];
+    }
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+        delta.counters[i] = counters[i] - other.counters[i];
+    }
+    return delta;
+}
+
+MetricsLog::MetricsLog(const std::string& path) : path_(path), out_(path, std::ios::app) {
+    if (!out_) {
+        throw std::runtime_error("Failed to open metrics log '" + path + "'");
+    }
+}
+
+void MetricsLog::write(int iteration, double wall_seconds, const MetricsCounts& counts) {
+    std::ostringstream line;
+    line << std::setprecision(6);
+    line << "{\"iteration\":" << iteration << ",\"wall_seconds\":" << wall_seconds << ",\"phases\":{";
+    for (size_t i = 0; i < NUM_PHASES; i++) {
+        Phase phase = static_cast<Phase>(i);
+        line << (i ? "," : "") << '"' << phaseName(phase) << "\":{\"seconds\":" << counts.seconds(phase)
+             << ",\"calls\":" << counts.calls(phase) << '}';
+    }
+    line << "},\"counters\":{";
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+        Counter counter = static_cast<Counter>(i);
+        line << (i ? "," : "") << '"' << counterName(counter) << "\":" << counts.count(counter);
+    }
+    uint64_t samples = counts.count(Counter::ADVANTAGE_SAMPLES) + counts.count(Counter::STRATEGY_SAMPLES);
+    line << "},\"nodes_per_second\":" << rate(counts.count(Counter::NODES), wall_seconds)
+         << ",\"samples_per_second\":" << rate(samples, wall_seconds)
+         << ",\"mean_training_batch\":" << meanTrainingBatch(counts) << "}\n";
+
+    // One write per record, flushed, so a tail -f or a crash sees whole lines
+    out_ << line.str();
+    if (!out_.flush()) {
+        throw std::runtime_error("Failed to write metrics log '" + path_ + "'");
+    }
+}
+
+std::string formatMetricsTable(const MetricsCounts& counts, double wall_seconds) {
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(2);
+    table << std::left << std::setw(16) << "phase" << std::right << std::setw(12) << "seconds"
+          << std::setw(14) << "calls" << std::setw(10) << "% wall" << "\n";
+    for (size_t i = 0; i < NUM_PHASES; i++) {
+        Phase phase = static_cast<Phase>(i);
+        table << std::left << std::setw(16) << phaseName(phase) << std::right << std::setw(12) << counts.seconds(phase)
+              << std::setw(14) << counts.calls(phase) << std::setw(10)
+              << (wall_seconds > 0.0 ? 100.0 * counts.seconds(phase) / wall_seconds : 0.0) << "\n";
+    }
+
+    uint64_t samples = counts.count(Counter::ADVANTAGE_SAMPLES) + counts.count(Counter::STRATEGY_SAMPLES);
+    table << "\n";
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+        Counter counter = static_cast<Counter>(i);
+        table << std::left << std::setw(20) << counterName(counter) << std::right << std::setw(16)
+              << counts.count(counter) << "\n";
+    }
+    table << std::left << std::setw(20) << "nodes/sec" << std::right << std::setw(16)
+          << rate(counts.count(Counter::NODES), wall_seconds) << "\n";
+    table << std::left << std::setw(20) << "samples/sec" << std::right << std::setw(16) << rate(samples, wall_seconds) << "\n";
+    table << std::left << std::setw(20) << "mean train batch" << std::right << std::setw(16) << meanTrainingBatch(counts) << "\n";
+    return table.str();
+}
@@ -0,0 +1,436 @@
+#include "quantized_mlp.hpp"
+#include "half.hpp"
+#include "mapped_file.hpp"
+#include "weight_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QUANTIZED_MLP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Inputs are padded to this many elements so the kernels never need a scalar tail
+constexpr size_t STRIDE_ALIGNMENT = 32;
+
+int32_t dotInt8Scalar(const int8_t* w, const int16_t* x, size_t n) {
+    int32_t acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += static_cast<int32_t>(w[i]) * x[i];
+    }
+    return acc;
+}
+
+float dotHalfScalar(const uint16_t* w, const float* x, size_t n) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        acc += halfToFloat(w[i]) * x[i];
+    }
+    return acc;
+}
+
+#ifdef QUANTIZED_MLP_X86
+
+__attribute__((target("avx2")))
+int32_t dotInt8Avx2(const int8_t* w, const int16_t* x, size_t n) {
+    // Widen 16 weights to int16 and let madd form pairwise int32 sums (|127 * 127 * 2| fits easily)
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 16) {
+        __m256i wv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i)));
+        __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(wv, xv));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+float dotHalfAvx2(const uint16_t* w, const float* x, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 wv = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i)));
+        acc = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x + i), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+#endif
+
+bool simdSupported(QuantizedMLP::Precision precision) {
+#ifdef QUANTIZED_MLP_X86
+    if (precision == QuantizedMLP::Precision::INT8) {
+        return __builtin_cpu_supports("avx2");
+    }
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#else
+    (void)precision;
+    return false;
+#endif
+}
+
+size_t paddedStride(size_t input_size) {
+    return (input_size + STRIDE_ALIGNMENT - 1) / STRIDE_ALIGNMENT * STRIDE_ALIGNMENT;
+}
+
+// Quantized weight file layout
+constexpr char QUANT_MAGIC[8] = {'P', 'K', 'R', 'Q', 'U', 'A', 'N', 'T'};
+constexpr uint32_t QUANT_BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t QUANT_HEADER_BYTES = 4096;
+constexpr size_t QUANT_MAX_LAYERS = 64;
+constexpr size_t QUANT_SECTION_ALIGNMENT = 64;
+
+struct QuantLayerEntry {
+    uint64_t input_size;
+    uint64_t output_size;
+    uint64_t stride;
+    uint64_t weights_offset;
+    uint64_t input_scale_offset;   // INT8 only
+    uint64_t output_scale_offset;  // INT8 only
+    uint64_t bias_offset;
+};
+
+struct QuantHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t precision;
+    uint32_t num_layers;
+    uint64_t file_size;
+    QuantLayerEntry layers[QUANT_MAX_LAYERS];
+};
+
+static_assert(sizeof(QuantHeader) <= QUANT_HEADER_BYTES, "quantized weight file header must fit its reserved block");
+
+size_t alignSection(size_t offset) {
+    return (offset + QUANT_SECTION_ALIGNMENT - 1) & ~(QUANT_SECTION_ALIGNMENT - 1);
+}
+
+[[noreturn]] void failFile(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " '" + path + "'");
+}
+
+// Plain fp32 forward that records the largest magnitude each layer's inputs reach
+std::vector<std::vector<float>> calibrateInputRanges(const std::vector<DenseLayer>& layers,
+                                                     const float* rows, size_t num_rows) {
+    std::vector<std::vector<float>> ranges;
+    for (const auto& layer : layers) {
+        ranges.emplace_back(layer.input_size, 0.0f);
+    }
+
+    std::vector<float> x, y;
+    for (size_t r = 0; r < num_rows; r++) {
+        x.assign(rows + r * layers.front().input_size, rows + (r + 1) * layers.front().input_size);
+        for (size_t l = 0; l < layers.size(); l++) {
+            const DenseLayer& layer = layers[l];
+            for (size_t i = 0; i < layer.input_size; i++) {
+                ranges[l][i] = std::max(ranges[l][i], std::fabs(x[i]));
+            }
+            y.assign(layer.output_size, 0.0f);
+            for (size_t o = 0; o < layer.output_size; o++) {
+                float acc = layer.bias[o];
+                const float* w = layer.weight.data() + o * layer.input_size;
+                for (size_t i = 0; i < layer.input_size; i++) {
+                    acc += w[i] * x[i];
+                }
+                y[o] = l + 1 < layers.size() ? std::max(acc, 0.0f) : acc;
+            }
+            x.swap(y);
+        }
+    }
+    return ranges;
+}
+
+}  // namespace
+
+QuantizedMLP::QuantizedMLP(const std::vector<DenseLayer>& layers,
+                           const float* calibration_rows,
+                           size_t num_rows,
+                           Precision precision)
+    : precision_(precision),
+      use_simd_(simdSupported(precision)) {
+    if (layers.empty()) {
+        throw std::invalid_argument("QuantizedMLP needs at least one layer");
+    }
+    for (size_t l = 1; l < layers.size(); l++) {
+        if (layers[l].input_size != layers[l - 1].output_size) {
+            throw std::invalid_argument("QuantizedMLP layer " + std::to_string(l) + " input size does not match the previous layer");
+        }
+    }
+    if (precision_ == Precision::INT8 && (calibration_rows == nullptr || num_rows == 0)) {
+        throw std::invalid_argument("INT8 quantization needs calibration rows");
+    }
+
+    std::vector<std::vector<float>> ranges;
+    if (precision_ == Precision::INT8) {
+        ranges = calibrateInputRanges(layers, calibration_rows, num_rows);
+    }
+
+    for (size_t l = 0; l < layers.size(); l++) {
+        const DenseLayer& dense = layers[l];
+        Layer layer;
+        layer.input_size = dense.input_size;
+        layer.output_size = dense.output_size;
+        layer.stride = paddedStride(dense.input_size);
+        layer.bias = dense.bias;
+
+        if (precision_ == Precision::FP16) {
+            layer.weights_h.assign(layer.output_size * layer.stride, 0);
+            for (size_t o = 0; o < layer.output_size; o++) {
+                for (size_t i = 0; i < layer.input_size; i++) {
+                    layer.weights_h[o * layer.stride + i] = floatToHalf(dense.weight[o * layer.input_size + i]);
+                }
+            }
+        } else {
+            // Inputs never seen nonzero during calibration keep a unit range
+            std::vector<float> range(layer.input_size);
+            layer.input_scale.resize(layer.input_size);
+            for (size_t i = 0; i < layer.input_size; i++) {
+                range[i] = ranges[l][i] > 0.0f ? ranges[l][i] : 1.0f;
+                layer.input_scale[i] = 127.0f / range[i];
+            }
+
+            layer.weights_q.assign(layer.output_size * layer.stride, 0);
+            layer.output_scale.resize(layer.output_size);
+            for (size_t o = 0; o < layer.output_size; o++) {
+                const float* w = dense.weight.data() + o * layer.input_size;
+                float max_abs = 0.0f;
+                for (size_t i = 0; i < layer.input_size; i++) {
+                    max_abs = std::max(max_abs, std::fabs(w[i] * range[i]));
+                }
+                float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+                for (size_t i = 0; i < layer.input_size; i++) {
+                    float q = std::round(w[i] * range[i] / scale);
+                    layer.weights_q[o * layer.stride + i] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
+                }
+                layer.output_scale[o] = scale / 127.0f;
+            }
+        }
+
+        layers_.push_back(std::move(layer));
+    }
+}
+
+void QuantizedMLP::forwardRow(const float* input, float* output) const {
+    // Activations for the current layer, padded to its stride; reused across calls on the same thread
+    thread_local std::vector<float> x;
+    thread_local std::vector<float> y;
+    thread_local std::vector<int16_t> xq;
+
+    x.assign(input, input + inputSize());
+    for (size_t l = 0; l < layers_.size(); l++) {
+        const Layer& layer = layers_[l];
+        const bool relu = l + 1 < layers_.size();
+        x.resize(layer.stride, 0.0f);
+        y.resize(layer.output_size);
+
+        if (precision_ == Precision::INT8) {
+            xq.assign(layer.stride, 0);
+            for (size_t i = 0; i < layer.input_size; i++) {
+                float q = std::round(x[i] * layer.input_scale[i]);
+                xq[i] = static_cast<int16_t>(std::clamp(q, -127.0f, 127.0f));
+            }
+            for (size_t o = 0; o < layer.output_size; o++) {
+                const int8_t* w = layer.weights_q.data() + o * layer.stride;
+#ifdef QUANTIZED_MLP_X86
+                int32_t dot = use_simd_ ? dotInt8Avx2(w, xq.data(), layer.stride) : dotInt8Scalar(w, xq.data(), layer.stride);
+#else
+                int32_t dot = dotInt8Scalar(w, xq.data(), layer.stride);
+#endif
+                y[o] = static_cast<float>(dot) * layer.output_scale[o] + layer.bias[o];
+            }
+        } else {
+            for (size_t o = 0; o < layer.output_size; o++) {
+                const uint16_t* w = layer.weights_h.data() + o * layer.stride;
+#ifdef QUANTIZED_MLP_X86
+                float dot = use_simd_ ? dotHalfAvx2(w, x.data(), layer.stride) : dotHalfScalar(w, x.data(), layer.stride);
+#else
+                float dot = dotHalfScalar(w, x.data(), layer.stride);
+#endif
+                y[o] = dot + layer.bias[o];
+            }
+        }
+
+        if (relu) {
+            for (float& v : y) v = std::max(v, 0.0f);
+        }
+        x.swap(y);
+    }
+
+    std::copy(x.begin(), x.begin() + outputSize(), output);
+}
+
+void QuantizedMLP::forward(const float* inputs, size_t rows, float* outputs) const {
+    for (size_t r = 0; r < rows; r++) {
+        forwardRow(inputs + r * inputSize(), outputs + r * outputSize());
+    }
+}
+
+std::vector<float> QuantizedMLP::predict(const std::vector<float>& features) const {
+    if (features.size() != inputSize()) {
+        throw std::invalid_argument("QuantizedMLP expects " + std::to_string(inputSize()) +
+                                    " features, got " + std::to_string(features.size()));
+    }
+    std::vector<float> result(outputSize());
+    forwardRow(features.data(), result.data());
+    return result;
+}
+
+void QuantizedMLP::save(const std::string& path) const {
+    if (layers_.size() > QUANT_MAX_LAYERS) {
+        throw std::invalid_argument("Quantized weight files hold at most " + std::to_string(QUANT_MAX_LAYERS) + " layers");
+    }
+
+    QuantHeader header{};
+    std::memcpy(header.magic, QUANT_MAGIC, sizeof(QUANT_MAGIC));
+    header.version = QUANTIZED_WEIGHT_FILE_VERSION;
+    header.byte_order = QUANT_BYTE_ORDER_MARK;
+    header.precision = static_cast<uint32_t>(precision_);
+    header.num_layers = static_cast<uint32_t>(layers_.size());
+
+    const size_t weight_bytes = precision_ == Precision::INT8 ? sizeof(int8_t) : sizeof(uint16_t);
+    size_t offset = QUANT_HEADER_BYTES;
+    for (size_t l = 0; l < layers_.size(); l++) {
+        const Layer& layer = layers_[l];
+        QuantLayerEntry& entry = header.layers[l];
+        entry.input_size = layer.input_size;
+        entry.output_size = layer.output_size;
+        entry.stride = layer.stride;
+        entry.weights_offset = offset;
+        offset = alignSection(offset + layer.output_size * layer.stride * weight_bytes);
+        entry.input_scale_offset = offset;
+        offset = alignSection(offset + layer.input_scale.size() * sizeof(float));
+        entry.output_scale_offset = offset;
+        offset = alignSection(offset + layer.output_scale.size() * sizeof(float));
+        entry.bias_offset = offset;
+        offset = alignSection(offset + layer.bias.size() * sizeof(float));
+    }
+    header.file_size = offset;
+
+    std::vector<uint8_t> image(offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (size_t l = 0; l < layers_.size(); l++) {
+        const Layer& layer = layers_[l];
+        const QuantLayerEntry& entry = header.layers[l];
+        if (precision_ == Precision::INT8) {
+            std::memcpy(image.data() + entry.weights_offset, layer.weights_q.data(), layer.weights_q.size());
+        } else {
+            std::memcpy(image.data() + entry.weights_offset, layer.weights_h.data(), layer.weights_h.size() * sizeof(uint16_t));
+        }
+        std::memcpy(image.data() + entry.input_scale_offset, layer.input_scale.data(), layer.input_scale.size() * sizeof(float));
+        std::memcpy(image.data() + entry.output_scale_offset, layer.output_scale.data(), layer.output_scale.size() * sizeof(float));
+        std::memcpy(image.data() + entry.bias_offset, layer.bias.data(), layer.bias.size() * sizeof(float));
+    }
+
+    writeFileAtomically(path, image);
+}
+
+QuantizedMLP QuantizedMLP::load(const std::string& path) {
+    MappedFile file(path, MappedFile::Mode::READ_ONLY);
+    if (file.size() < QUANT_HEADER_BYTES) failFile("Truncated quantized weight file", path);
+
+    QuantHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, QUANT_MAGIC, sizeof(QUANT_MAGIC)) != 0) failFile("Not a quantized weight file", path);
+    if (header.version != QUANTIZED_WEIGHT_FILE_VERSION) failFile("Unsupported quantized weight file version in", path);
+    if (header.byte_order != QUANT_BYTE_ORDER_MARK) failFile("Quantized weight file has foreign byte order", path);
+    if (header.precision > static_cast<uint32_t>(Precision::FP16)) failFile("Unknown precision in", path);
+    if (header.num_layers == 0 || header.num_layers > QUANT_MAX_LAYERS) failFile("Corrupt layer table in", path);
+    if (header.file_size != file.size()) failFile("Truncated quantized weight file", path);
+
+    QuantizedMLP net(static_cast<Precision>(header.precision));
+    const bool int8 = net.precision_ == Precision::INT8;
+    const size_t weight_bytes = int8 ? sizeof(int8_t) : sizeof(uint16_t);
+    auto section = [&](uint64_t offset, size_t bytes) {
+        if (offset < QUANT_HEADER_BYTES || offset % QUANT_SECTION_ALIGNMENT != 0 || offset + bytes > file.size()) {
+            failFile("Corrupt layer table in", path);
+        }
+        return file.data() + offset;
+    };
+    auto floats = [&](uint64_t offset, size_t count) {
+        const float* begin = reinterpret_cast<const float*>(section(offset, count * sizeof(float)));
+        return std::vector<float>(begin, begin + count);
+    };
+
+    for (uint32_t l = 0; l < header.num_layers; l++) {
+        const QuantLayerEntry& entry = header.layers[l];
+        if (entry.stride != paddedStride(entry.input_size) ||
+            (l > 0 && entry.input_size != header.layers[l - 1].output_size)) {
+            failFile("Corrupt layer table in", path);
+        }
+
+        Layer layer;
+        layer.input_size = entry.input_size;
+        layer.output_size = entry.output_size;
+        layer.stride = entry.stride;
+        size_t weight_count = layer.output_size * layer.stride;
+        const uint8_t* weights = section(entry.weights_offset, weight_count * weight_bytes);
+        if (int8) {
+            const int8_t* q = reinterpret_cast<const int8_t*>(weights);
+            layer.weights_q.assign(q, q + weight_count);
+            layer.input_scale = floats(entry.input_scale_offset, layer.input_size);
+            layer.output_scale = floats(entry.output_scale_offset, layer.output_size);
+        } else {
+            const uint16_t* h = reinterpret_cast<const uint16_t*>(weights);
+            layer.weights_h.assign(h, h + weight_count);
+        }
+        layer.bias = floats(entry.bias_offset, layer.output_size);
+        net.layers_.push_back(std::move(layer));
+    }
+
+    net.use_simd_ = simdSupported(net.precision_);
+    return net;
+}
+
+size_t QuantizedMLP::weightBytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers_) {
+        bytes += layer.weights_q.size() * sizeof(int8_t) + layer.weights_h.size() * sizeof(uint16_t);
+        bytes += (layer.input_scale.size() + layer.output_scale.size() + layer.bias.size()) * sizeof(float);
+    }
+    return bytes;
+}
+
+QuantizationReport QuantizedMLP::evaluate(const std::vector<DenseLayer>& reference, const float* rows, size_t num_rows) const {
+    FastMLP fp32(reference);
+    const size_t outputs = outputSize();
+    std::vector<float> expected(num_rows * outputs);
+    std::vector<float> actual(num_rows * outputs);
+    fp32.forward(rows, num_rows, expected.data());
+    forward(rows, num_rows, actual.data());
+
+    QuantizationReport report{};
+    report.samples = num_rows;
+    size_t agreements = 0;
+    for (size_t r = 0; r < num_rows; r++) {
+        const float* e = expected.data() + r * outputs;
+        const float* a = actual.data() + r * outputs;
+        for (size_t o = 0; o < outputs; o++) {
+            double error = std::fabs(static_cast<double>(e[o]) - a[o]);
+            report.mean_abs_error += error;
+            report.max_abs_error = std::max(report.max_abs_error, error);
+            report.mean_abs_output += std::fabs(e[o]);
+        }
+        agreements += std::max_element(e, e + outputs) - e == std::max_element(a, a + outputs) - a;
+    }
+    if (num_rows > 0) {
+        report.mean_abs_error /= static_cast<double>(num_rows * outputs);
+        report.mean_abs_output /= static_cast<double>(num_rows * outputs);
+        report.argmax_agreement = static_cast<double>(agreements) / num_rows;
+    }
+
+    for (const auto& layer : reference) {
+        report.fp32_bytes += (layer.weight.size() + layer.bias.size()) * sizeof(float);
+    }
+    report.quantized_bytes = weightBytes();
+    return report;
+}
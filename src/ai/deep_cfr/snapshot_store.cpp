@@ -0,0 +1,103 @@
+#include "snapshot_store.hpp"
+#include "weight_file.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+SnapshotStore::SnapshotStore(const std::string& directory) : directory_(directory) {
+    std::filesystem::create_directories(directory_);
+
+    std::ifstream index(directory_ + "/index.txt");
+    int iteration;
+    int player;
+    float weight;
+    while (index >> iteration >> player >> weight) {
+        append(iteration, player, weight);
+    }
+}
+
+void SnapshotStore::add(int iteration, int player, float weight, const std::vector<DenseLayer>& layers) {
+    if (player < 0 || weight <= 0.0f) {
+        throw std::invalid_argument("Snapshots need a player and a positive weight");
+    }
+
+    writeWeightFile(path(iteration, player), layers);
+    {
+        std::ofstream index(directory_ + "/index.txt", std::ios::app);
+        index << iteration << ' ' << player << ' ' << weight << '\n';
+        if (!index.flush()) {
+            throw std::runtime_error("Failed to append to snapshot index in '" + directory_ + "'");
+        }
+    }
+    append(iteration, player, weight);
+}
+
+void SnapshotStore::truncate(int iteration) {
+    std::vector<PlayerSnapshots> kept(players_.size());
+    std::string index_path = directory_ + "/index.txt";
+    std::string tmp_path = index_path + ".tmp";
+    {
+        std::ofstream index(tmp_path, std::ios::trunc);
+        for (size_t player = 0; player < players_.size(); player++) {
+            const PlayerSnapshots& snapshots = players_[player];
+            for (size_t i = 0; i < snapshots.entries.size(); i++) {
+                const Entry& entry = snapshots.entries[i];
+                if (entry.iteration > iteration) continue;
+                index << entry.iteration << ' ' << player << ' ' << entry.weight << '\n';
+                double total = kept[player].cumulative_weights.empty() ? 0.0 : kept[player].cumulative_weights.back();
+                kept[player].entries.push_back(entry);
+                kept[player].cumulative_weights.push_back(total + entry.weight);
+            }
+        }
+        if (!index.flush()) {
+            throw std::runtime_error("Failed to rewrite snapshot index in '" + directory_ + "'");
+        }
+    }
+    std::filesystem::rename(tmp_path, index_path);
+    players_ = std::move(kept);
+}
+
+void SnapshotStore::append(int iteration, int player, float weight) {
+    if (static_cast<size_t>(player) >= players_.size()) {
+        players_.resize(player + 1);
+    }
+    PlayerSnapshots& snapshots = players_[player];
+    snapshots.entries.push_back({iteration, weight, std::make_shared<const FastMLP>(mapWeightFile(path(iteration, player)))});
+    double total = snapshots.cumulative_weights.empty() ? 0.0 : snapshots.cumulative_weights.back();
+    snapshots.cumulative_weights.push_back(total + weight);
+}
+
+size_t SnapshotStore::size(int player) const {
+    return player >= 0 && static_cast<size_t>(player) < players_.size() ? players_[player].entries.size() : 0;
+}
+
+size_t SnapshotStore::sample(int player, float u) const {
+    const PlayerSnapshots& snapshots = this->snapshots(player);
+    double target = u * snapshots.cumulative_weights.back();
+    auto it = std::upper_bound(snapshots.cumulative_weights.begin(), snapshots.cumulative_weights.end(), target);
+    return std::min<size_t>(it - snapshots.cumulative_weights.begin(), snapshots.entries.size() - 1);
+}
+
+const FastMLP& SnapshotStore::net(int player, size_t index) const {
+    return *snapshots(player).entries.at(index).net;
+}
+
+float SnapshotStore::weight(int player, size_t index) const {
+    return snapshots(player).entries.at(index).weight;
+}
+
+int SnapshotStore::iteration(int player, size_t index) const {
+    return snapshots(player).entries.at(index).iteration;
+}
+
+std::string SnapshotStore::path(int iteration, int player) const {
+    return directory_ + "/iter_" + std::to_string(iteration) + "_player_" + std::to_string(player) + ".bin";
+}
+
+const SnapshotStore::PlayerSnapshots& SnapshotStore::snapshots(int player) const {
+    if (size(player) == 0) {
+        throw std::out_of_range("No snapshots stored for player " + std::to_string(player));
+    }
+    return players_[player];
+}
@@ -0,0 +1,118 @@
+#include "thread_pool.hpp"
+#include "util/trace.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : generation_(0),
+      stopping_(false),
+      job_(nullptr),
+      remaining_(0),
+      steals_(0) {
+    num_threads = std::max<size_t>(1, num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, const IndexFunction& fn) {
+    if (begin >= end) return;
+    grain = std::max<size_t>(1, grain);
+
+    std::lock_guard<std::mutex> submit(submit_mutex_);
+    job_ = &fn;
+    error_ = nullptr;
+
+    // Deal the chunks out before waking anyone, so a worker that finds every deque empty
+    // knows the job has no more work for it
+    size_t num_chunks = (end - begin + grain - 1) / grain;
+    remaining_.store(num_chunks, std::memory_order_relaxed);
+    for (size_t c = 0; c < num_chunks; c++) {
+        Worker& worker = *workers_[c % workers_.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.chunks.push_back({begin + c * grain, std::min(end, begin + (c + 1) * grain)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+    }
+    wake_.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return remaining_.load(std::memory_order_acquire) == 0; });
+    }
+    job_ = nullptr;
+
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+bool ThreadPool::takeChunk(size_t worker, Chunk& chunk) {
+    {
+        Worker& own = *workers_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.back();
+            own.chunks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t k = 1; k < workers_.size(); k++) {
+        Worker& victim = *workers_[(worker + k) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.front();
+            victim.chunks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    Tracer::setThreadName("pool worker " + std::to_string(worker));
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+
+        Chunk chunk;
+        while (takeChunk(worker, chunk)) {
+            for (size_t i = chunk.begin; i < chunk.end; i++) {
+                try {
+                    (*job_)(i, worker);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) error_ = std::current_exception();
+                }
+            }
+
+            if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_all();
+            }
+        }
+    }
+}
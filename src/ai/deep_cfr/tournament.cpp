@@ -0,0 +1,217 @@
+#include "tournament.hpp"
+#include "deep_cfr.hpp"
+#include "thread_pool.hpp"
+#include "weight_file.hpp"
+#include "util/trace.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// One table of a pair's lockstep batch, playing hand after hand
+struct Table {
+    std::unique_ptr<Game> game;
+    size_t hand = 0;
+    int a_seat = 0;
+    Philox4x32 actions{0, 0, 0, 0, RngPurpose::ACTION};
+};
+
+}  // namespace
+
+double TournamentResult::score(size_t model) const {
+    double total = 0.0;
+    for (size_t opponent = 0; opponent < names.size(); opponent++) {
+        if (opponent != model) total += matrix[model][opponent].mbb_per_game;
+    }
+    return names.size() > 1 ? total / (names.size() - 1) : 0.0;
+}
+
+std::vector<size_t> TournamentResult::ranking() const {
+    std::vector<size_t> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return score(x) > score(y); });
+    return order;
+}
+
+std::string TournamentResult::toString() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "Win rates in mbb/g (row against column, +/- 95% CI):\n";
+    for (size_t row = 0; row < names.size(); row++) {
+        out << std::setw(20) << names[row];
+        for (size_t column = 0; column < names.size(); column++) {
+            if (row == column) {
+                out << std::setw(18) << "-";
+            } else {
+                std::ostringstream cell;
+                cell << std::fixed << std::setprecision(1) << matrix[row][column].mbb_per_game << " +/- "
+                     << 1.96 * matrix[row][column].std_error;
+                out << std::setw(18) << cell.str();
+            }
+        }
+        out << "\n";
+    }
+    out << "Ranking:\n";
+    std::vector<size_t> order = ranking();
+    for (size_t i = 0; i < order.size(); i++) {
+        out << "  " << i + 1 << ". " << names[order[i]] << " (" << score(order[i]) << " mbb/g)\n";
+    }
+    return out.str();
+}
+
+std::string TournamentResult::toCsv() const {
+    std::ostringstream out;
+    out << "model";
+    for (const std::string& name : names) out << ',' << name;
+    out << '\n';
+    for (size_t row = 0; row < names.size(); row++) {
+        out << names[row];
+        for (size_t column = 0; column < names.size(); column++) {
+            out << ',';
+            if (row != column) out << matrix[row][column].mbb_per_game;
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+Tournament::Tournament(const std::vector<std::string>& model_directories, const TournamentConfig& config)
+    : config_(config) {
+    if (model_directories.size() < 2) {
+        throw std::invalid_argument("A tournament needs at least two models");
+    }
+    if (config_.deals <= 0 || config_.tables == 0 || config_.big_blind <= 0) {
+        throw std::invalid_argument("A tournament needs positive deals, tables and big blind");
+    }
+    for (const std::string& directory : model_directories) {
+        names_.push_back(std::filesystem::path(directory).filename().string());
+        nets_.push_back(std::make_shared<const FastMLP>(mapWeightFile(directory + "/strategy_net.bin")));
+    }
+}
+
+TournamentResult Tournament::run() {
+    TRACE_SCOPE("Tournament::run");
+    size_t models = nets_.size();
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t a = 0; a < models; a++) {
+        for (size_t b = a + 1; b < models; b++) pairs.emplace_back(a, b);
+    }
+
+    TournamentResult result;
+    result.names = names_;
+    result.matrix.assign(models, std::vector<WinRate>(models));
+
+    size_t threads = config_.threads > 0 ? config_.threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    pool.parallelFor(0, pairs.size(), 1, [&](size_t p, size_t) {
+        auto [a, b] = pairs[p];
+        std::vector<double> winnings = playPair(a, b);
+        WinRate rate = WinRate::fromWinnings(winnings, config_.big_blind);
+        rate.hands = 2 * winnings.size();
+        result.matrix[a][b] = rate;
+
+        // Zero-sum: the column's view is the same estimate negated
+        WinRate mirrored = rate;
+        mirrored.mbb_per_game = -rate.mbb_per_game;
+        mirrored.ci95_low = -rate.ci95_high;
+        mirrored.ci95_high = -rate.ci95_low;
+        result.matrix[b][a] = mirrored;
+    });
+    return result;
+}
+
+std::vector<double> Tournament::playPair(size_t a, size_t b) {
+    TRACE_SCOPE("Tournament::playPair");
+    const FastMLP* nets[2] = {nets_[a].get(), nets_[b].get()};
+    size_t hands = 2 * static_cast<size_t>(config_.deals);
+    std::vector<double> winnings(hands, 0.0);
+    uint32_t pair = static_cast<uint32_t>(a * nets_.size() + b);
+
+    size_t next_hand = 0;
+    auto deal = [&](Table& table) {
+        if (next_hand >= hands) {
+            table.game.reset();
+            return;
+        }
+        // Both hands of a duplicate pair share the deck and the button, seats swapped
+        table.hand = next_hand++;
+        table.a_seat = static_cast<int>(table.hand % 2);
+        uint32_t deal_index = static_cast<uint32_t>(table.hand / 2);
+        Philox4x32 cards(config_.seed, pair, 0, deal_index, RngPurpose::DEAL);
+        table.actions = Philox4x32(config_.seed, pair, 0, deal_index, RngPurpose::ACTION);
+        table.game = std::make_unique<Game>(2, config_.starting_chips, config_.small_blind, config_.big_blind);
+        table.game->startHand(Deck(cards), static_cast<int>(deal_index % 2));
+    };
+
+    std::vector<Table> tables(std::min(config_.tables, hands));
+    for (Table& table : tables) deal(table);
+
+    std::vector<size_t> pending[2];
+    std::vector<InfoState> states;
+    std::vector<float> rows;
+    std::vector<float> outputs;
+    size_t live = tables.size();
+    while (live > 0) {
+        pending[0].clear();
+        pending[1].clear();
+        for (size_t t = 0; t < tables.size(); t++) {
+            if (!tables[t].game) continue;
+            int player = tables[t].game->getCurrentPlayer();
+            pending[player == tables[t].a_seat ? 0 : 1].push_back(t);
+        }
+
+        for (int side = 0; side < 2; side++) {
+            if (pending[side].empty()) continue;
+            const FastMLP& net = *nets[side];
+            size_t input_size = net.inputSize();
+            size_t output_size = net.outputSize();
+
+            states.clear();
+            rows.assign(pending[side].size() * input_size, 0.0f);
+            for (size_t i = 0; i < pending[side].size(); i++) {
+                const Game& game = *tables[pending[side][i]].game;
+                states.push_back(InfoState::fromGame(game, game.getCurrentPlayer()));
+                std::vector<float> features = states.back().toFeatureVector();
+                std::copy_n(features.begin(), std::min(features.size(), input_size), rows.begin() + i * input_size);
+            }
+            outputs.resize(pending[side].size() * output_size);
+            net.forward(rows.data(), pending[side].size(), outputs.data());
+
+            for (size_t i = 0; i < pending[side].size(); i++) {
+                Table& table = tables[pending[side][i]];
+                std::vector<Action> legal_actions = states[i].getLegalActions();
+                std::vector<float> row(outputs.begin() + i * output_size, outputs.begin() + (i + 1) * output_size);
+                std::vector<float> probs = DeepCFR::regretMatching(row, legal_actions.size());
+
+                float r = table.actions.uniform();
+                float cumulative = 0.0f;
+                size_t chosen = legal_actions.size() - 1;
+                for (size_t j = 0; j < legal_actions.size(); j++) {
+                    cumulative += probs[j];
+                    if (r < cumulative) {
+                        chosen = j;
+                        break;
+                    }
+                }
+                table.game->takeAction(legal_actions[chosen]);
+
+                if (table.game->isHandComplete()) {
+                    winnings[table.hand] = table.game->getPlayers()[table.a_seat]->getChips() - config_.starting_chips;
+                    deal(table);
+                    if (!table.game) live--;
+                }
+            }
+        }
+    }
+
+    std::vector<double> duplicates(config_.deals);
+    for (size_t d = 0; d < duplicates.size(); d++) {
+        duplicates[d] = 0.5 * (winnings[2 * d] + winnings[2 * d + 1]);
+    }
+    return duplicates;
+}
@@ -0,0 +1,141 @@
+#include "weight_file.hpp"
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'P', 'K', 'R', 'W', 'E', 'I', 'G', 'H'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t HEADER_BYTES = 4096;
+constexpr size_t MAX_LAYERS = 64;
+
+struct LayerEntry {
+    uint64_t input_size;
+    uint64_t output_size;
+    uint64_t weights_offset;
+    uint64_t bias_offset;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t panel_width;
+    uint32_t num_layers;
+    uint64_t file_size;
+    LayerEntry layers[MAX_LAYERS];
+};
+
+static_assert(sizeof(Header) <= HEADER_BYTES, "weight file header must fit its reserved block");
+
+size_t alignUp(size_t offset) {
+    return (offset + FastMLP::ALIGNMENT - 1) & ~(FastMLP::ALIGNMENT - 1);
+}
+
+[[noreturn]] void fail(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " '" + path + "'");
+}
+
+}  // namespace
+
+void writeWeightFile(const std::string& path, const std::vector<DenseLayer>& layers) {
+    if (layers.empty() || layers.size() > MAX_LAYERS) {
+        throw std::invalid_argument("Weight files hold between 1 and " + std::to_string(MAX_LAYERS) + " layers");
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = WEIGHT_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.panel_width = static_cast<uint32_t>(FastMLP::PANEL_WIDTH);
+    header.num_layers = static_cast<uint32_t>(layers.size());
+
+    size_t offset = HEADER_BYTES;
+    for (size_t l = 0; l < layers.size(); l++) {
+        LayerEntry& entry = header.layers[l];
+        entry.input_size = layers[l].input_size;
+        entry.output_size = layers[l].output_size;
+        entry.weights_offset = offset;
+        offset = alignUp(offset + FastMLP::packedWeightCount(layers[l].input_size, layers[l].output_size) * sizeof(float));
+        entry.bias_offset = offset;
+        offset = alignUp(offset + FastMLP::packedBiasCount(layers[l].output_size) * sizeof(float));
+    }
+    header.file_size = offset;
+
+    // Assemble the whole image, then publish it with a single rename
+    std::vector<uint8_t> image(offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    for (size_t l = 0; l < layers.size(); l++) {
+        if (layers[l].weight.size() != layers[l].input_size * layers[l].output_size ||
+            layers[l].bias.size() != layers[l].output_size) {
+            throw std::invalid_argument("DenseLayer weight/bias sizes do not match its dimensions");
+        }
+        FastMLP::packLayer(layers[l],
+                           reinterpret_cast<float*>(image.data() + header.layers[l].weights_offset),
+                           reinterpret_cast<float*>(image.data() + header.layers[l].bias_offset));
+    }
+
+    writeFileAtomically(path, image);
+}
+
+void writeFileAtomically(const std::string& path, const std::vector<uint8_t>& image) {
+    std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) fail("Failed to create", tmp_path);
+
+    size_t written = 0;
+    while (written < image.size()) {
+        ssize_t n = ::write(fd, image.data() + written, image.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            fail("Failed to write", tmp_path);
+        }
+        written += static_cast<size_t>(n);
+    }
+    if (::fsync(fd) != 0) {
+        ::close(fd);
+        fail("Failed to sync", tmp_path);
+    }
+    ::close(fd);
+
+    std::filesystem::rename(tmp_path, path);
+}
+
+FastMLP mapWeightFile(const std::string& path) {
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Mode::READ_ONLY);
+    if (file->size() < HEADER_BYTES) fail("Truncated weight file", path);
+
+    const Header* header = reinterpret_cast<const Header*>(file->data());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("Not a weight file", path);
+    if (header->version != WEIGHT_FILE_VERSION) fail("Unsupported weight file version in", path);
+    if (header->byte_order != BYTE_ORDER_MARK) fail("Weight file has foreign byte order", path);
+    if (header->panel_width != FastMLP::PANEL_WIDTH) fail("Weight file was packed for another panel width", path);
+    if (header->num_layers == 0 || header->num_layers > MAX_LAYERS) fail("Corrupt layer table in", path);
+    if (header->file_size != file->size()) fail("Truncated weight file", path);
+
+    std::vector<FastMLP::Layer> layers;
+    for (uint32_t l = 0; l < header->num_layers; l++) {
+        const LayerEntry& entry = header->layers[l];
+        size_t weights_end = entry.weights_offset + FastMLP::packedWeightCount(entry.input_size, entry.output_size) * sizeof(float);
+        size_t bias_end = entry.bias_offset + FastMLP::packedBiasCount(entry.output_size) * sizeof(float);
+        if (entry.weights_offset % FastMLP::ALIGNMENT != 0 || entry.bias_offset % FastMLP::ALIGNMENT != 0 ||
+            entry.weights_offset < HEADER_BYTES || weights_end > file->size() || bias_end > file->size()) {
+            fail("Corrupt layer table in", path);
+        }
+        layers.push_back({entry.input_size, entry.output_size,
+                          reinterpret_cast<const float*>(file->data() + entry.weights_offset),
+                          reinterpret_cast<const float*>(file->data() + entry.bias_offset)});
+    }
+
+    // Inference touches every page; fault them in ahead of the first decision
+    file->advise(0, file->size(), MADV_WILLNEED);
+    return FastMLP(std::move(layers), std::move(file));
+}
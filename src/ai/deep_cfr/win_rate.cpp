@@ -0,0 +1,40 @@
+#include "win_rate.hpp"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+WinRate WinRate::fromWinnings(const std::vector<double>& chips, int big_blind) {
+    if (big_blind <= 0) {
+        throw std::invalid_argument("Win rates need a positive big blind");
+    }
+
+    WinRate rate;
+    rate.hands = chips.size();
+    if (chips.empty()) return rate;
+
+    // Two-pass mean and variance; the per-hand values span a few hundred big blinds at most
+    double scale = 1000.0 / big_blind;
+    double sum = 0.0;
+    for (double c : chips) sum += c * scale;
+    rate.mbb_per_game = sum / chips.size();
+
+    if (chips.size() > 1) {
+        double squares = 0.0;
+        for (double c : chips) {
+            double d = c * scale - rate.mbb_per_game;
+            squares += d * d;
+        }
+        rate.std_error = std::sqrt(squares / (chips.size() - 1) / chips.size());
+    }
+    rate.ci95_low = rate.mbb_per_game - 1.96 * rate.std_error;
+    rate.ci95_high = rate.mbb_per_game + 1.96 * rate.std_error;
+    return rate;
+}
+
+std::string WinRate::toString() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    out << mbb_per_game << " +/- " << 1.96 * std_error << " mbb/g over " << hands << " hands";
+    return out.str();
+}
@@ -0,0 +1,53 @@
+#include "bet_abstraction.hpp"
+#include <stdexcept>
+
+BetAbstraction::BetAbstraction(std::vector<float> pot_fractions, int max_raises)
+    : pot_fractions_(std::move(pot_fractions)), max_raises_(max_raises) {
+    // Fold, check/call and all-in besides the raises
+    if (pot_fractions_.size() + 3 > static_cast<size_t>(MAX_ACTIONS)) {
+        throw std::invalid_argument("At most " + std::to_string(MAX_ACTIONS - 3) + " raise sizes fit an info set");
+    }
+    for (float fraction : pot_fractions_) {
+        if (fraction <= 0.0f) {
+            throw std::invalid_argument("Raise sizes must be positive pot fractions");
+        }
+    }
+}
+
+std::vector<Action> BetAbstraction::actions(const Game& game, int raises_this_street) const {
+    int player = game.getCurrentPlayer();
+    int chips = game.getPlayers()[player]->getChips();
+    int to_call = game.getPots().back()->chips_to_call(player);
+    int pot = 0;
+    for (const auto& p : game.getPots()) {
+        pot += p->get_amount();
+    }
+
+    std::vector<Action> actions;
+    if (to_call > 0) {
+        actions.emplace_back(ActionType::FOLD);
+    }
+    if (to_call == 0) {
+        actions.emplace_back(ActionType::CHECK);
+    } else if (to_call < chips) {
+        actions.emplace_back(ActionType::CALL);
+    }
+
+    // Raise amounts are the chips posted now, the call included
+    if (raises_this_street < max_raises_) {
+        int previous = to_call;
+        for (float fraction : pot_fractions_) {
+            int amount = to_call + static_cast<int>(fraction * (pot + to_call));
+            if (amount > previous && amount < chips) {
+                actions.emplace_back(ActionType::RAISE, amount);
+                previous = amount;
+            }
+        }
+    }
+
+    // All-in stays available past the raise cap; short of the call it is the call
+    if (chips > 0) {
+        actions.emplace_back(ActionType::ALL_IN);
+    }
+    return actions;
+}
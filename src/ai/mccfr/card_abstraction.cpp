@@ -0,0 +1,85 @@
+#include "card_abstraction.hpp"
+#include "evaluator.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const std::vector<Card>& fullDeck() {
+    static const std::vector<Card> deck = []() {
+        std::vector<Card> cards;
+        for (char rank : std::string("23456789TJQKA")) {
+            for (char suit : std::string("shdc")) {
+                cards.emplace_back(std::string{rank, suit});
+            }
+        }
+        return cards;
+    }();
+    return deck;
+}
+
+}  // namespace
+
+CardAbstraction::CardAbstraction(int postflop_buckets, int samples)
+    : postflop_buckets_(postflop_buckets), samples_(samples) {
+    if (postflop_buckets_ <= 0 || samples_ <= 0) {
+        throw std::invalid_argument("The card abstraction needs positive bucket and sample counts");
+    }
+}
+
+int CardAbstraction::preflopClass(const Card& a, const Card& b) {
+    int high = std::max(a.getRank(), b.getRank());
+    int low = std::min(a.getRank(), b.getRank());
+    if (high == low) {
+        return high;
+    }
+    // 78 unordered pairs of distinct ranks, each suited and offsuit
+    int pair_index = high * (high - 1) / 2 + low;
+    return 13 + 2 * pair_index + (a.getSuit() == b.getSuit() ? 0 : 1);
+}
+
+int CardAbstraction::bucket(const std::vector<Card>& hole, const std::vector<Card>& board, Philox4x32& rng) const {
+    if (board.empty()) {
+        return preflopClass(hole[0], hole[1]);
+    }
+    int b = static_cast<int>(handStrength(hole, board, rng) * postflop_buckets_);
+    return std::min(b, postflop_buckets_ - 1);
+}
+
+int CardAbstraction::numBuckets(HandPhase::Phase phase) const {
+    return phase == HandPhase::Phase::PREFLOP ? PREFLOP_CLASSES : postflop_buckets_;
+}
+
+double CardAbstraction::handStrength(const std::vector<Card>& hole, const std::vector<Card>& board,
+                                     Philox4x32& rng) const {
+    const std::vector<Card>& deck = fullDeck();
+    std::vector<Card> remaining;
+    remaining.reserve(deck.size());
+    for (const Card& card : deck) {
+        bool dead = std::find(hole.begin(), hole.end(), card) != hole.end() ||
+                    std::find(board.begin(), board.end(), card) != board.end();
+        if (!dead) remaining.push_back(card);
+    }
+
+    size_t to_come = 5 - std::min<size_t>(5, board.size());
+    double won = 0.0;
+    std::vector<Card> full_board;
+    std::vector<Card> opponent(2, deck[0]);
+    for (int s = 0; s < samples_; s++) {
+        // Opponent cards and runout by a partial Fisher-Yates over the unseen cards
+        for (size_t j = 0; j < 2 + to_come; j++) {
+            size_t k = j + rng.below(static_cast<uint32_t>(remaining.size() - j));
+            std::swap(remaining[j], remaining[k]);
+        }
+        opponent[0] = remaining[0];
+        opponent[1] = remaining[1];
+        full_board.assign(board.begin(), board.end());
+        full_board.insert(full_board.end(), remaining.begin() + 2, remaining.begin() + 2 + to_come);
+
+        int rank = Evaluator::evaluate(hole, full_board);  // Lower is stronger
+        int other = Evaluator::evaluate(opponent, full_board);
+        won += rank < other ? 1.0 : rank == other ? 0.5 : 0.0;
+    }
+    return won / samples_;
+}
@@ -0,0 +1,74 @@
+#include "info_set_table.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+
+static_assert(std::atomic<int32_t>::is_always_lock_free && std::atomic<float>::is_always_lock_free,
+              "Regret slots need lock-free 32-bit atomics");
+
+InfoSetTable::InfoSetTable(size_t capacity) {
+    capacity = roundCapacity(capacity);
+
+    // Zero-filled anonymous pages are what empty slots and zero regrets look like
+    size_t key_bytes = capacity * sizeof(std::atomic<uint64_t>);
+    size_t slot_bytes = capacity * WIDTH * sizeof(std::atomic<int32_t>);
+    bytes_ = key_bytes + 2 * slot_bytes;
+    memory_ = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory_ == MAP_FAILED) {
+        throw std::runtime_error("Failed to allocate an info-set table of " + std::to_string(bytes_) +
+                                 " bytes: " + std::strerror(errno));
+    }
+    char* base = static_cast<char*>(memory_);
+    regrets_ = reinterpret_cast<std::atomic<int32_t>*>(base + key_bytes);
+    strategy_ = reinterpret_cast<std::atomic<float>*>(base + key_bytes + slot_bytes);
+    attach(reinterpret_cast<std::atomic<uint64_t>*>(base), capacity, &size_);
+}
+
+InfoSetTable::~InfoSetTable() {
+    ::munmap(memory_, bytes_);
+}
+
+void InfoSetTable::regrets(size_t slot, size_t num_actions, float* out) const {
+    const std::atomic<int32_t>* regrets = regrets_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        out[a] = static_cast<float>(regrets[a].load(std::memory_order_relaxed));
+    }
+}
+
+void InfoSetTable::addRegrets(size_t slot, size_t num_actions, const double* deltas, double floor, Philox4x32&) {
+    std::atomic<int32_t>* regrets = regrets_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        double updated = regrets[a].load(std::memory_order_relaxed) + std::round(deltas[a]);
+        updated = std::clamp(updated, floor, static_cast<double>(std::numeric_limits<int32_t>::max()));
+        regrets[a].store(static_cast<int32_t>(updated), std::memory_order_relaxed);
+    }
+}
+
+void InfoSetTable::strategySums(size_t slot, size_t num_actions, float* out) const {
+    const std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        out[a] = sums[a].load(std::memory_order_relaxed);
+    }
+}
+
+void InfoSetTable::addStrategy(size_t slot, size_t num_actions, const float* probabilities) {
+    std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        sums[a].store(sums[a].load(std::memory_order_relaxed) + probabilities[a], std::memory_order_relaxed);
+    }
+}
+
+void InfoSetTable::scale(size_t slot, double factor) {
+    std::atomic<int32_t>* regrets = regrets_ + slot * WIDTH;
+    std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (int a = 0; a < WIDTH; a++) {
+        regrets[a].store(static_cast<int32_t>(regrets[a].load(std::memory_order_relaxed) * factor),
+                         std::memory_order_relaxed);
+        sums[a].store(static_cast<float>(sums[a].load(std::memory_order_relaxed) * factor), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,182 @@
+#include "mapped_info_set_table.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(std::atomic<int16_t>::is_always_lock_free, "Regret codes need lock-free 16-bit atomics");
+
+namespace {
+
+// Decoded magnitude of every non-negative code
+const std::array<float, MappedInfoSetTable::MAX_CODE + 1>& magnitudes() {
+    static const auto table = []() {
+        std::array<float, MappedInfoSetTable::MAX_CODE + 1> values{};
+        for (size_t c = 0; c < values.size(); c++) {
+            values[c] = static_cast<float>(std::expm1(c / MappedInfoSetTable::REGRET_CODE_SCALE));
+        }
+        return values;
+    }();
+    return table;
+}
+
+}  // namespace
+
+size_t MappedInfoSetTable::fileSize(size_t capacity) {
+    return HEADER_BYTES + capacity * (sizeof(uint64_t) + WIDTH * (sizeof(int16_t) + sizeof(float)));
+}
+
+MappedInfoSetTable::MappedInfoSetTable(const std::string& path, size_t capacity) {
+    bool exists = std::filesystem::exists(path) && std::filesystem::file_size(path) >= HEADER_BYTES;
+    if (exists) {
+        // Read the capacity from the header before mapping the whole table
+        MappedFile probe(path, MappedFile::Mode::READ_ONLY);
+        const Header* header = reinterpret_cast<const Header*>(probe.data());
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+            header->width != static_cast<uint32_t>(WIDTH) || probe.size() != fileSize(header->capacity)) {
+            throw std::runtime_error("'" + path + "' is not a regret table with this layout");
+        }
+        capacity = header->capacity;
+    } else {
+        if (capacity == 0) {
+            throw std::invalid_argument("Creating regret table '" + path + "' needs a capacity");
+        }
+        capacity = roundCapacity(capacity);
+    }
+
+    // A new file is sparse: zero pages are empty slots with zero regrets
+    file_ = MappedFile(path, MappedFile::Mode::READ_WRITE, fileSize(capacity));
+    header_ = reinterpret_cast<Header*>(file_.data());
+    if (!exists) {
+        std::memcpy(header_->magic, MAGIC, sizeof(MAGIC));
+        header_->version = VERSION;
+        header_->width = WIDTH;
+        header_->capacity = capacity;
+        header_->size.store(0);
+        header_->iterations = 0;
+    }
+
+    uint8_t* base = file_.data() + HEADER_BYTES;
+    auto* keys = reinterpret_cast<std::atomic<uint64_t>*>(base);
+    regrets_ = reinterpret_cast<std::atomic<int16_t>*>(base + capacity * sizeof(uint64_t));
+    strategy_ = reinterpret_cast<std::atomic<float>*>(base + capacity * (sizeof(uint64_t) + WIDTH * sizeof(int16_t)));
+    attach(keys, capacity, &header_->size);
+
+    // Info sets are visited in hash order; kernel readahead would only waste I/O
+    file_.advise(HEADER_BYTES, file_.size() - HEADER_BYTES, MADV_RANDOM);
+}
+
+float MappedInfoSetTable::decodeRegret(int16_t code) {
+    int magnitude = std::min<int>(std::abs(static_cast<int>(code)), MAX_CODE);
+    float value = magnitudes()[magnitude];
+    return code < 0 ? -value : value;
+}
+
+int16_t MappedInfoSetTable::encodeRegret(double regret, float u) {
+    double magnitude = std::abs(regret);
+    double position = REGRET_CODE_SCALE * std::log1p(magnitude);
+    if (position >= MAX_CODE) {
+        return static_cast<int16_t>(regret < 0.0 ? -MAX_CODE : MAX_CODE);
+    }
+    int lower = static_cast<int>(position);
+    double low = magnitudes()[lower];
+    double high = magnitudes()[lower + 1];
+    double p = std::clamp((magnitude - low) / (high - low), 0.0, 1.0);
+    int code = lower + (u < p ? 1 : 0);
+    return static_cast<int16_t>(regret < 0.0 ? -code : code);
+}
+
+void MappedInfoSetTable::regrets(size_t slot, size_t num_actions, float* out) const {
+    const std::atomic<int16_t>* codes = regrets_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        out[a] = decodeRegret(codes[a].load(std::memory_order_relaxed));
+    }
+}
+
+void MappedInfoSetTable::addRegrets(size_t slot, size_t num_actions, const double* deltas, double floor,
+                                    Philox4x32& rng) {
+    std::atomic<int16_t>* codes = regrets_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        double updated = std::max(decodeRegret(codes[a].load(std::memory_order_relaxed)) + deltas[a], floor);
+        codes[a].store(encodeRegret(updated, rng.uniform()), std::memory_order_relaxed);
+    }
+}
+
+void MappedInfoSetTable::strategySums(size_t slot, size_t num_actions, float* out) const {
+    const std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        out[a] = sums[a].load(std::memory_order_relaxed);
+    }
+}
+
+void MappedInfoSetTable::addStrategy(size_t slot, size_t num_actions, const float* probabilities) {
+    std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (size_t a = 0; a < num_actions; a++) {
+        sums[a].store(sums[a].load(std::memory_order_relaxed) + probabilities[a], std::memory_order_relaxed);
+    }
+}
+
+void MappedInfoSetTable::scale(size_t slot, double factor) {
+    // Discounts are rare and shrink every regret alike; the nearest code is close enough
+    std::atomic<int16_t>* codes = regrets_ + slot * WIDTH;
+    std::atomic<float>* sums = strategy_ + slot * WIDTH;
+    for (int a = 0; a < WIDTH; a++) {
+        double regret = decodeRegret(codes[a].load(std::memory_order_relaxed)) * factor;
+        codes[a].store(encodeRegret(regret, 0.5f), std::memory_order_relaxed);
+        sums[a].store(static_cast<float>(sums[a].load(std::memory_order_relaxed) * factor), std::memory_order_relaxed);
+    }
+}
+
+MappedInfoSetTable::RebuildStats MappedInfoSetTable::rebuild(const std::string& from, const std::string& to,
+                                                             size_t capacity, bool drop_empty, double max_load) {
+    RebuildStats stats;
+    std::string tmp_path = to + ".rebuild";
+    std::filesystem::remove(tmp_path);
+    {
+        MappedInfoSetTable source(from);
+        std::vector<size_t> live;
+        for (size_t slot = 0; slot < source.capacity(); slot++) {
+            if (source.key(slot) == 0) continue;
+            bool empty = true;
+            for (int a = 0; a < WIDTH && empty; a++) {
+                empty = source.regrets_[slot * WIDTH + a].load(std::memory_order_relaxed) == 0 &&
+                        source.strategy_[slot * WIDTH + a].load(std::memory_order_relaxed) == 0.0f;
+            }
+            if (drop_empty && empty) {
+                stats.dropped++;
+            } else {
+                live.push_back(slot);
+            }
+        }
+
+        if (capacity == 0) {
+            capacity = static_cast<size_t>(std::ceil(live.size() / std::clamp(max_load, 0.01, 1.0)));
+        }
+        capacity = roundCapacity(std::max<size_t>(capacity, 1));
+        if (capacity < live.size()) {
+            throw std::invalid_argument("A capacity of " + std::to_string(capacity) + " cannot hold " +
+                                        std::to_string(live.size()) + " info sets");
+        }
+
+        // Codes and sums move verbatim; only the slots change
+        MappedInfoSetTable target(tmp_path, capacity);
+        for (size_t slot : live) {
+            size_t moved = target.findOrInsert(source.key(slot));
+            for (int a = 0; a < WIDTH; a++) {
+                target.regrets_[moved * WIDTH + a].store(source.regrets_[slot * WIDTH + a].load(std::memory_order_relaxed),
+                                                         std::memory_order_relaxed);
+                target.strategy_[moved * WIDTH + a].store(
+                    source.strategy_[slot * WIDTH + a].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+        target.setIterations(source.iterations());
+        target.sync();
+        stats.kept = live.size();
+        stats.capacity = capacity;
+    }
+    std::filesystem::rename(tmp_path, to);
+    return stats;
+}
@@ -0,0 +1,200 @@
+#include "mccfr_solver.hpp"
+#include "info_set_table.hpp"
+#include "mapped_info_set_table.hpp"
+#include "util/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+MCCFRSolver::MCCFRSolver(const MCCFRConfig& config)
+    : config_(config),
+      cards_(config.postflop_buckets, config.strength_samples),
+      bets_(config.raise_fractions, config.max_raises),
+      pool_(config.threads > 0 ? config.threads : std::max(1u, std::thread::hardware_concurrency())) {
+    if (config_.num_players < 2 || config_.discount_interval <= 0) {
+        throw std::invalid_argument("MCCFR needs at least two players and a positive discount interval");
+    }
+    if (config_.table_path.empty()) {
+        table_ = std::make_unique<InfoSetTable>(config_.table_capacity);
+    } else {
+        table_ = std::make_unique<MappedInfoSetTable>(config_.table_path, config_.table_capacity);
+        iteration_ = static_cast<int>(table_->iterations());
+    }
+}
+
+void MCCFRSolver::train(int iterations) {
+    TRACE_SCOPE("MCCFRSolver::train");
+    int target = iteration_ + iterations;
+    while (iteration_ < target) {
+        // Run up to the next discount boundary; iterations never overlap a discount
+        int interval = config_.discount_interval;
+        int batch = std::min(target - iteration_, interval - iteration_ % interval);
+        auto start = std::chrono::steady_clock::now();
+        pool_.parallelFor(iteration_, iteration_ + batch, 1,
+                          [&](size_t t, size_t) { runIteration(static_cast<uint32_t>(t)); });
+        iteration_ += batch;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (iteration_ % interval == 0 && iteration_ <= config_.linear_until) {
+            double d = static_cast<double>(iteration_ / interval);
+            discount(d / (d + 1.0));
+        }
+        // Written back asynchronously; a crash loses at most the pages still in flight
+        table_->setIterations(iteration_);
+        table_->sync(true);
+
+        std::cout << "Iteration " << iteration_ << ": "
+                  << static_cast<long long>(seconds > 0.0 ? batch / seconds : 0.0) << " iterations/sec, "
+                  << table_->size() << " info sets ("
+                  << 100.0 * table_->size() / table_->capacity() << "% of the table)" << std::endl;
+    }
+}
+
+void MCCFRSolver::runIteration(uint32_t iteration) {
+    Hand hand;
+    hand.iteration = iteration;
+    hand.buckets.assign(config_.num_players, {-1, -1, -1, -1});
+
+    for (int traverser = 0; traverser < config_.num_players; traverser++) {
+        // Every traversal of an iteration plays the same cards and button
+        Philox4x32 deal(config_.seed, iteration, 0, 0, RngPurpose::DEAL);
+        Philox4x32 rng(config_.seed, iteration, traverser, 0, RngPurpose::ACTION);
+        Game game(config_.num_players, config_.starting_chips, config_.small_blind, config_.big_blind);
+        game.startHand(Deck(deal), static_cast<int>(iteration % config_.num_players));
+        traverse(game, traverser, hand, 0, 0, game.getPhase(), rng);
+    }
+}
+
+double MCCFRSolver::traverse(Game& game, int traverser, Hand& hand, uint64_t history, int raises,
+                             HandPhase::Phase street, Philox4x32& rng) {
+    if (game.isHandComplete()) {
+        return static_cast<double>(game.getPlayers()[traverser]->getChips() - config_.starting_chips);
+    }
+
+    HandPhase::Phase phase = game.getPhase();
+    if (phase != street) {
+        raises = 0;
+        history = combine(history, 0x100 + static_cast<uint64_t>(phase));
+        street = phase;
+    }
+
+    int player = game.getCurrentPlayer();
+    std::vector<Action> actions = bets_.actions(game, raises);
+    size_t n = actions.size();
+    size_t slot = table_->findOrInsert(infoSetKey(history, player, bucketPath(game, player, hand)));
+
+    float strategy[RegretTable::WIDTH];
+    regretMatching(slot, n, strategy);
+
+    if (player != traverser) {
+        // Average strategy from the non-traversers' visits, then one sampled action
+        table_->addStrategy(slot, n, strategy);
+
+        float r = rng.uniform();
+        float cumulative = 0.0f;
+        size_t chosen = n - 1;
+        for (size_t a = 0; a < n; a++) {
+            cumulative += strategy[a];
+            if (r < cumulative) {
+                chosen = a;
+                break;
+            }
+        }
+        game.takeAction(actions[chosen]);
+        return traverse(game, traverser, hand, combine(history, chosen), raises + BetAbstraction::isRaise(actions[chosen]),
+                        street, rng);
+    }
+
+    double values[RegretTable::WIDTH];
+    double value = 0.0;
+    for (size_t a = 0; a < n; a++) {
+        Game next = game;
+        next.takeAction(actions[a]);
+        values[a] = traverse(next, traverser, hand, combine(history, a), raises + BetAbstraction::isRaise(actions[a]),
+                             street, rng);
+        value += strategy[a] * values[a];
+    }
+
+    double deltas[RegretTable::WIDTH];
+    for (size_t a = 0; a < n; a++) {
+        deltas[a] = values[a] - value;
+    }
+    table_->addRegrets(slot, n, deltas, REGRET_FLOOR, rng);
+    return value;
+}
+
+std::vector<int> MCCFRSolver::bucketPath(const Game& game, int player, Hand& hand) const {
+    // Streets are numbered by board size: 0, 3, 4 and 5 cards
+    const std::vector<Card>& board = game.getBoard();
+    size_t street = board.size() < 3 ? 0 : board.size() - 2;
+    std::array<int, 4>& buckets = hand.buckets[player];
+    if (buckets[street] < 0) {
+        Philox4x32 rng(config_.seed, hand.iteration, player, static_cast<uint32_t>(street), RngPurpose::SAMPLING);
+        buckets[street] = cards_.bucket(game.getPlayers()[player]->getHand(), board, rng);
+    }
+    return std::vector<int>(buckets.begin(), buckets.begin() + street + 1);
+}
+
+void MCCFRSolver::regretMatching(size_t slot, size_t num_actions, float* strategy) const {
+    table_->regrets(slot, num_actions, strategy);
+    double positive = 0.0;
+    for (size_t a = 0; a < num_actions; a++) {
+        strategy[a] = std::max(strategy[a], 0.0f);
+        positive += strategy[a];
+    }
+    for (size_t a = 0; a < num_actions; a++) {
+        strategy[a] = positive > 0.0 ? static_cast<float>(strategy[a] / positive) : 1.0f / num_actions;
+    }
+}
+
+void MCCFRSolver::discount(double factor) {
+    TRACE_SCOPE("MCCFRSolver::discount");
+    size_t grain = 1 << 16;
+    pool_.parallelFor(0, table_->capacity(), grain, [&](size_t slot, size_t) {
+        if (table_->key(slot) != 0) table_->scale(slot, factor);
+    });
+}
+
+std::vector<float> MCCFRSolver::currentStrategy(uint64_t key, size_t num_actions) const {
+    std::vector<float> strategy(num_actions, 1.0f / num_actions);
+    size_t slot = table_->find(key);
+    if (slot != RegretTable::NOT_FOUND) {
+        regretMatching(slot, num_actions, strategy.data());
+    }
+    return strategy;
+}
+
+std::vector<float> MCCFRSolver::averageStrategy(uint64_t key, size_t num_actions) const {
+    std::vector<float> strategy(num_actions, 1.0f / num_actions);
+    size_t slot = table_->find(key);
+    if (slot == RegretTable::NOT_FOUND) return strategy;
+
+    float sums[RegretTable::WIDTH];
+    table_->strategySums(slot, num_actions, sums);
+    double total = 0.0;
+    for (size_t a = 0; a < num_actions; a++) total += sums[a];
+    if (total > 0.0) {
+        for (size_t a = 0; a < num_actions; a++) {
+            strategy[a] = static_cast<float>(sums[a] / total);
+        }
+    }
+    return strategy;
+}
+
+uint64_t MCCFRSolver::combine(uint64_t hash, uint64_t value) {
+    // splitmix64 finalizer over the running hash and the next value
+    uint64_t z = hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t MCCFRSolver::infoSetKey(uint64_t history, int player, const std::vector<int>& buckets) {
+    uint64_t key = combine(history, static_cast<uint64_t>(player));
+    for (int bucket : buckets) {
+        key = combine(key, static_cast<uint64_t>(bucket));
+    }
+    return key;
+}
@@ -0,0 +1,57 @@
+#include "regret_table.hpp"
+#include <stdexcept>
+#include <string>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Info-set keys need lock-free 64-bit atomics");
+
+size_t RegretTable::roundCapacity(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+    return rounded;
+}
+
+void RegretTable::attach(std::atomic<uint64_t>* keys, size_t capacity, std::atomic<uint64_t>* size) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        throw std::invalid_argument("Regret table capacity must be a power of two");
+    }
+    keys_ = keys;
+    size_ = size;
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+}
+
+size_t RegretTable::home(uint64_t key) const {
+    // Keys are already hashes; one more mix spreads any structure in their low bits
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & mask_;
+}
+
+size_t RegretTable::findOrInsert(uint64_t key) {
+    key = storedKey(key);
+    size_t slot = home(key);
+    for (size_t probe = 0; probe < capacity_; probe++, slot = (slot + 1) & mask_) {
+        uint64_t current = keys_[slot].load(std::memory_order_acquire);
+        if (current == key) return slot;
+        if (current == 0) {
+            if (keys_[slot].compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                size_->fetch_add(1, std::memory_order_relaxed);
+                return slot;
+            }
+            if (current == key) return slot;  // Another thread inserted the same key
+        }
+    }
+    throw std::runtime_error("Regret table is full at " + std::to_string(capacity_) + " entries");
+}
+
+size_t RegretTable::find(uint64_t key) const {
+    key = storedKey(key);
+    size_t slot = home(key);
+    for (size_t probe = 0; probe < capacity_; probe++, slot = (slot + 1) & mask_) {
+        uint64_t current = keys_[slot].load(std::memory_order_acquire);
+        if (current == key) return slot;
+        if (current == 0) return NOT_FOUND;
+    }
+    return NOT_FOUND;
+}
@@ -1,5 +1,6 @@
 #include "include/engine/evaluator.hpp"
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <stdexcept>
 
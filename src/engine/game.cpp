@@ -8,8 +8,6 @@
 
 
 void Game::_deal_cards() {
-    deck_ = Deck(); // New shuffled deck
-
     // Deal 2 cards to each player
     for (int i = 0; i < 2; i++) {
         for (auto& player : players_) {
@@ -112,7 +110,52 @@ Game::Game(int num_players, int starting_chips, int small_blind, int big_blind)
     pots_.push_back(std::make_shared<Pot>());
 }
 
+Game::Game(const Game& other)
+    : action_history_(other.action_history_)
+    , board_(other.board_)
+    , deck_(other.deck_)
+    , phase_(other.phase_)
+    , btn_loc_(other.btn_loc_)
+    , current_player_(other.current_player_)
+    , small_blind_(other.small_blind_)
+    , big_blind_(other.big_blind_)
+    , last_raise_(other.last_raise_) {
+
+    for (const auto& player : other.players_) {
+        players_.push_back(std::make_shared<Player>(*player));
+    }
+
+    // The betting round also holds pots it split off itself, so both lists map each
+    // original pot to one shared copy
+    std::unordered_map<const Pot*, std::shared_ptr<Pot>> pot_copies;
+    auto copyPot = [&pot_copies](const std::shared_ptr<Pot>& pot) {
+        std::shared_ptr<Pot>& copy = pot_copies[pot.get()];
+        if (!copy) {
+            copy = std::make_shared<Pot>(*pot);
+        }
+        return copy;
+    };
+    for (const auto& pot : other.pots_) {
+        pots_.push_back(copyPot(pot));
+    }
+    if (other.betting_round_) {
+        betting_round_ = std::make_unique<BettingRound>(other.betting_round_->rebound(players_, copyPot));
+    }
+}
+
+Game& Game::operator=(const Game& other) {
+    if (this != &other) {
+        *this = Game(other);
+    }
+    return *this;
+}
+
 GameState Game::startHand(int btn_loc) {
+    return startHand(Deck(), btn_loc); // New shuffled deck
+}
+
+GameState Game::startHand(Deck deck, int btn_loc) {
+    deck_ = std::move(deck);
     board_.clear();
     
     for (auto& player : players_) {
@@ -156,8 +199,13 @@ GameState Game::takeAction(Action action) {
         next_round = betting_round_->handleAction(action);
         current_player_ = betting_round_->getCurrentPlayer();
     }
-    if (next_round) {
-        phase_ = betting_round_->everyoneAllIn() ? HandPhase::Phase::SETTLE : HandPhase::getNextPhase(phase_);
+    // Once everyone else has folded the hand is decided, whatever street it is on
+    int contesting = static_cast<int>(std::count_if(players_.begin(), players_.end(), [](const auto& player) {
+        return player->getState() != PlayerState::OUT && player->getState() != PlayerState::SKIP;
+    }));
+    if (next_round || contesting < 2) {
+        phase_ = contesting < 2 || betting_round_->everyoneAllIn() ? HandPhase::Phase::SETTLE
+                                                                  : HandPhase::getNextPhase(phase_);
 
         if (isHandOver()) {
             _settle_hand();
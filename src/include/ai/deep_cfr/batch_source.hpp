@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include "sample_buffer.hpp"
+#include "metrics.hpp"
+
+// Producer of training batches, written straight into caller-provided contiguous host memory.
+// NeuralNet::trainSteps calls nextBatch from its prefetch thread only.
+class BatchSource {
+public:
+    virtual ~BatchSource() = default;
+
+    // Write up to batch_size rows of features, targets and weights (1 if the source has none);
+    // returns the number written, 0 once the source is exhausted
+    virtual size_t nextBatch(size_t batch_size, float* features, float* targets, float* weights) = 0;
+
+    virtual size_t featureSize() const = 0;
+    virtual size_t targetSize() const = 0;
+};
+
+// Endless stream of independent minibatches drawn from a reservoir buffer
+class SampleBufferSource : public BatchSource {
+private:
+    SampleBuffer& buffer_;
+
+public:
+    explicit SampleBufferSource(SampleBuffer& buffer) : buffer_(buffer) {}
+
+    size_t nextBatch(size_t batch_size, float* features, float* targets, float* weights) override {
+        return buffer_.sample(batch_size, features, targets, weights);
+    }
+
+    size_t featureSize() const override { return buffer_.featureSize(); }
+    size_t targetSize() const override { return buffer_.targetSize(); }
+};
+
+// SampleBufferSource for a buffer that other threads add to, serialized by their shared mutex
+class LockedSampleBufferSource : public BatchSource {
+private:
+    SampleBuffer& buffer_;
+    std::mutex& mutex_;
+
+public:
+    LockedSampleBufferSource(SampleBuffer& buffer, std::mutex& mutex) : buffer_(buffer), mutex_(mutex) {}
+
+    size_t nextBatch(size_t batch_size, float* features, float* targets, float* weights) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return buffer_.sample(batch_size, features, targets, weights);
+    }
+
+    size_t featureSize() const override { return buffer_.featureSize(); }
+    size_t targetSize() const override { return buffer_.targetSize(); }
+};
+
+// Times another source's batch assembly into counts, which belong to the prefetch thread
+// until trainSteps returns
+class TimedBatchSource : public BatchSource {
+private:
+    BatchSource& source_;
+    MetricsCounts* counts_;
+
+public:
+    TimedBatchSource(BatchSource& source, MetricsCounts* counts) : source_(source), counts_(counts) {}
+
+    size_t nextBatch(size_t batch_size, float* features, float* targets, float* weights) override {
+        ScopedTimer timer(counts_, Phase::BATCH_ASSEMBLY);
+        return source_.nextBatch(batch_size, features, targets, weights);
+    }
+
+    size_t featureSize() const override { return source_.featureSize(); }
+    size_t targetSize() const override { return source_.targetSize(); }
+};
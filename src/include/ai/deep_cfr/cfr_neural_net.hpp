@@ -4,6 +4,8 @@
 #include <string>
 #include <memory>
 #include <torch/torch.h>
+#include "fast_mlp.hpp"
+#include "batch_source.hpp"
 
 // Check for Apple Silicon and MPS support
 #if defined(__APPLE__) && defined(__arm64__)
@@ -22,6 +24,16 @@ private:
 
 TORCH_MODULE(MLP);
 
+// Outcome of a multi-step training run
+struct TrainStats {
+    float loss;       // Mean loss over the steps taken
+    int steps;
+    size_t samples;
+    double seconds;
+
+    double samplesPerSecond() const { return seconds > 0.0 ? samples / seconds : 0.0; }
+};
+
 // Neural network wrapper for Deep CFR
 class NeuralNet {
 private:
@@ -29,19 +41,59 @@ private:
     torch::optim::Adam optimizer;
     int input_size;
     int output_size;
+
+    torch::Device device() const { return model->parameters().front().device(); }
+
+    // One optimizer step on device-resident tensors; returns the loss without synchronizing
+    torch::Tensor step(const torch::Tensor& inputs, const torch::Tensor& targets, const torch::Tensor& weights);
     
 public:
     NeuralNet(int input_size, int hidden_size, int output_size, float learning_rate = 0.001);
     
     // Forward pass
     std::vector<float> predict(const std::vector<float>& features);
+
+    // Forward pass over num_rows contiguous feature rows; returns [num_rows x output_size] row-major
+    std::vector<float> predictBatch(const float* rows, int64_t num_rows);
     
     // Training
     float train(const std::vector<std::vector<float>>& features_batch, 
                 const std::vector<std::vector<float>>& targets_batch,
                 int batch_size);
-    
+
+    // Single SGD step on pre-assembled [batch x input_size] / [batch x output_size] tensors
+    float train(const torch::Tensor& inputs, const torch::Tensor& targets);
+
+    // Single SGD step minimizing the weight-normalized per-sample MSE sum(w_i * mse_i) / sum(w_i)
+    float train(const torch::Tensor& inputs, const torch::Tensor& targets, const torch::Tensor& weights);
+
+    // Run steps optimizer steps on batches drawn from source. A background thread gathers the
+    // next batch into pinned host memory while the current one trains; the loss is read back
+    // from the device once, at the end.
+    TrainStats trainSteps(BatchSource& source, int batch_size, int steps);
+
+    // Run epochs passes over a pre-filled dataset, which is moved to the device once and
+    // reshuffled on the device every epoch
+    TrainStats trainEpochs(const torch::Tensor& inputs, const torch::Tensor& targets,
+                           const torch::Tensor& weights, int batch_size, int epochs);
+
+    // Host tensor to gather training batches into (page-locked when training on CUDA)
+    torch::Tensor stagingTensor(int64_t rows, int64_t cols) const;
+
+    // Copy the current weights to host memory, one DenseLayer per Linear, for FastMLP
+    std::vector<DenseLayer> exportLayers() const;
+
+    // Write the weights as a flat file that mapWeightFile() can serve in place
+    void exportWeights(const std::string& path) const;
+
+    int getInputSize() const { return input_size; }
+    int getOutputSize() const { return output_size; }
+
     // Save and load
     void save(const std::string& path);
     void load(const std::string& path);
+
+    // Adam moments and step counts, so a resumed run continues the same optimization
+    void saveOptimizer(const std::string& path);
+    void loadOptimizer(const std::string& path);
 }; 
\ No newline at end of file
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "sample_buffer.hpp"
+#include "philox.hpp"
+
+// Reservoir buffer that many traversal threads can insert into without a global lock.
+//
+// Every add reserves a unique sequence number n with one atomic fetch_add on the
+// counter. Items n < capacity take slot n; later items draw j uniformly from [0, n]
+// with a per-thread Philox stream and overwrite slot j when j < capacity. Writers can
+// reach the same slot out of reservation order, so each slot remembers the sequence
+// number it holds and a writer with an older one leaves it alone. Once writers are
+// quiet the contents are those of Algorithm R run serially in reservation order, so
+// each of the count() items offered is retained with probability capacity / count().
+// Which thread draws which j still depends on scheduling, so runs are not reproducible.
+//
+// Each slot carries a seqlock version (odd while a writer owns it, 0 if never written)
+// so concurrent writers to the same slot serialize and samplers never observe torn rows.
+class ConcurrentReservoirBuffer : public SampleBuffer {
+private:
+    size_t capacity_;
+    size_t feature_size_;
+    size_t target_size_;
+
+    // Default-initialized so untouched capacity is never committed
+    std::unique_ptr<float[]> features_;
+    std::unique_ptr<float[]> targets_;
+    std::unique_ptr<float[]> weights_;
+    std::unique_ptr<std::atomic<uint32_t>[]> versions_;
+    std::unique_ptr<size_t[]> sequences_;  // Reservation held by each slot, guarded by its version
+
+    alignas(64) std::atomic<size_t> count_;
+
+    // Each thread draws from its own Philox stream, keyed by the seed and the order in
+    // which threads first touched the buffer since the last seed() call
+    const uint64_t id_;
+    uint64_t seed_;
+    std::atomic<uint32_t> generation_;
+    std::atomic<uint32_t> streams_;
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> next(0);
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Philox4x32& threadRng() {
+        struct Stream {
+            uint64_t buffer;
+            uint32_t generation;
+            Philox4x32 rng;
+        };
+        // A handful of entries: one per buffer this thread writes to
+        thread_local std::vector<Stream> streams;
+
+        uint32_t generation = generation_.load(std::memory_order_acquire);
+        for (Stream& stream : streams) {
+            if (stream.buffer == id_) {
+                if (stream.generation != generation) {
+                    stream = {id_, generation, makeStream()};
+                }
+                return stream.rng;
+            }
+        }
+        streams.push_back({id_, generation, makeStream()});
+        return streams.back().rng;
+    }
+
+    Philox4x32 makeStream() {
+        uint32_t index = streams_.fetch_add(1, std::memory_order_relaxed);
+        return Philox4x32(seed_, 0, 0, index, RngPurpose::RESERVOIR);
+    }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    void store(size_t slot, size_t sequence, const float* features, const float* targets, size_t num_targets, float weight) {
+        std::atomic<uint32_t>& version = versions_[slot];
+        uint32_t v = version.load(std::memory_order_relaxed);
+        for (;;) {
+            if (v & 1u) {
+                cpuRelax();
+                v = version.load(std::memory_order_relaxed);
+            } else if (version.compare_exchange_weak(v, v + 1, std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        // A later reservation already landed here and Algorithm R would have kept it
+        if (v != 0 && sequences_[slot] > sequence) {
+            version.store(v, std::memory_order_release);
+            return;
+        }
+
+        sequences_[slot] = sequence;
+        num_targets = std::min(num_targets, target_size_);
+        std::copy(features, features + feature_size_, features_.get() + slot * feature_size_);
+        float* target_row = targets_.get() + slot * target_size_;
+        std::copy(targets, targets + num_targets, target_row);
+        std::fill(target_row + num_targets, target_row + target_size_, 0.0f);
+        weights_[slot] = weight;
+
+        version.store(v + 2, std::memory_order_release);
+    }
+
+    // Seqlock read of one slot; false if the slot has never been written
+    bool load(size_t slot, float* feature_row, float* target_row, float* weight) const {
+        const std::atomic<uint32_t>& version = versions_[slot];
+        for (;;) {
+            uint32_t before = version.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1u) {
+                cpuRelax();
+                continue;
+            }
+
+            const float* feature_src = features_.get() + slot * feature_size_;
+            std::copy(feature_src, feature_src + feature_size_, feature_row);
+            const float* target_src = targets_.get() + slot * target_size_;
+            std::copy(target_src, target_src + target_size_, target_row);
+            float w = weights_[slot];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before) {
+                if (weight) *weight = w;
+                return true;
+            }
+        }
+    }
+
+public:
+    ConcurrentReservoirBuffer(size_t capacity, size_t feature_size, size_t target_size)
+        : capacity_(capacity),
+          feature_size_(feature_size),
+          target_size_(target_size),
+          features_(new float[capacity * feature_size]),
+          targets_(new float[capacity * target_size]),
+          weights_(new float[capacity]),
+          versions_(new std::atomic<uint32_t>[capacity]),
+          sequences_(new size_t[capacity]),
+          count_(0),
+          id_(nextId()),
+          seed_(0),
+          generation_(0),
+          streams_(0) {
+        for (size_t i = 0; i < capacity_; i++) {
+            versions_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    using SampleBuffer::add;
+    using SampleBuffer::sample;
+
+    // Thread-safe; may run concurrently with other adds and with sample()
+    void add(const float* features, const float* targets, size_t num_targets, float weight) override {
+        size_t n = count_.fetch_add(1, std::memory_order_relaxed);
+        if (n < capacity_) {
+            store(n, n, features, targets, num_targets, weight);
+            return;
+        }
+        size_t j = std::uniform_int_distribution<size_t>(0, n)(threadRng());
+        if (j < capacity_) {
+            store(j, n, features, targets, num_targets, weight);
+        }
+    }
+
+    // Thread-safe; slots reserved but not yet written are skipped
+    size_t sample(size_t batch_size, float* features_out, float* targets_out, float* weights_out) override {
+        std::vector<size_t> slots;
+        sampleDistinctIndices(size(), batch_size, threadRng(), slots);
+
+        size_t rows = 0;
+        for (size_t slot : slots) {
+            float* weight = weights_out ? weights_out + rows : nullptr;
+            if (load(slot, features_out + rows * feature_size_, targets_out + rows * target_size_, weight)) {
+                rows++;
+            }
+        }
+        return rows;
+    }
+
+    size_t size() const override { return std::min(count_.load(std::memory_order_relaxed), capacity_); }
+    size_t capacity() const override { return capacity_; }
+    size_t count() const override { return count_.load(std::memory_order_relaxed); }
+    size_t featureSize() const override { return feature_size_; }
+    size_t targetSize() const override { return target_size_; }
+
+    // Not thread-safe: callers must quiesce writers first. Threads restart their streams.
+    void seed(uint64_t seed) override {
+        seed_ = seed;
+        streams_.store(0, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Not thread-safe: callers must quiesce writers first
+    void clear() override {
+        for (size_t i = 0; i < capacity_; i++) {
+            versions_[i].store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+    }
+};
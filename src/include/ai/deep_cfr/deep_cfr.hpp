@@ -4,54 +4,339 @@
 #include <memory>
 #include <random>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include "engine.hpp"
 #include "cfr_neural_net.hpp"
-#include "reservoir_buffer.hpp"
+#include "feature_reservoir_buffer.hpp"
+#include "mmap_reservoir_buffer.hpp"
+#include "concurrent_reservoir_buffer.hpp"
+#include "fast_mlp.hpp"
+#include "quantized_mlp.hpp"
+#include "thread_pool.hpp"
+#include "philox.hpp"
+#include "snapshot_store.hpp"
+#include "distributed.hpp"
+#include "inference_broker.hpp"
+#include "metrics.hpp"
 #include "info_state.hpp"
 
+// How the traverser's actions are explored. EXTERNAL expands every action; OUTCOME follows a
+// single action drawn from an exploratory mix of the strategy and uniform; ROBUST expands k
+// actions drawn uniformly without replacement. The sampling schemes importance-weight what
+// they expand, so regret targets stay unbiased while a traversal costs O(depth) (OUTCOME) or
+// O(k^depth) (ROBUST) rather than growing with every action at every decision.
+enum class TraversalScheme {
+    EXTERNAL,
+    OUTCOME,
+    ROBUST
+};
+
 class DeepCFR {
 private:
+    // Samples produced by one worker, staged row-major until flushed into the shared buffers
+    struct StagedSamples {
+        std::vector<float> features;  // rows x MAX_FEATURE_SIZE
+        std::vector<float> targets;   // rows x num_actions, zero padded
+        std::vector<float> weights;
+        std::vector<int> players;     // Advantage buffer each row belongs to
+
+        size_t size() const { return weights.size(); }
+        void add(const std::vector<float>& row_features, const std::vector<float>& row_targets,
+                 size_t target_size, float weight, int player) {
+            features.insert(features.end(), row_features.begin(), row_features.end());
+            size_t n = std::min(row_targets.size(), target_size);
+            targets.insert(targets.end(), row_targets.begin(), row_targets.begin() + n);
+            targets.insert(targets.end(), target_size - n, 0.0f);
+            weights.push_back(weight);
+            players.push_back(player);
+        }
+        void clear() {
+            features.clear();
+            targets.clear();
+            weights.clear();
+            players.clear();
+        }
+    };
+
+    // Advantage networks published by the pipelined learner. Actors hold one for a whole
+    // traversal; the learner publishes by swapping in a new snapshot (copy-update-store),
+    // and a snapshot is freed once the last traversal using it lets go.
+    struct NetSnapshot {
+        std::vector<std::shared_ptr<const FastMLP>> advantage_nets;
+        uint64_t version = 0;
+    };
+
+    // Everything a traversal mutates. Each traversal of a window gets its own, so neither
+    // its random stream nor the order its samples reach the buffers depends on the worker.
+    struct TraversalContext {
+        Philox4x32 rng{0, 0, 0, 0, RngPurpose::ACTION};
+        StagedSamples advantage_samples;
+        StagedSamples strategy_samples;
+        size_t nodes_visited = 0;
+        bool prune = false;        // Regret-based pruning applies to this traversal
+        std::shared_ptr<const NetSnapshot> snapshot;  // Pipelined mode: the nets this traversal plays
+        size_t actions_pruned = 0;
+        MetricsCounts counts;
+        MetricsCounts* metrics = nullptr;  // &counts while metrics are enabled
+    };
+
+    // Regret-based pruning (Pluribus): past start_iteration, a traversal prunes with the given
+    // probability, skipping traverser actions whose predicted advantage is below threshold
+    struct PruningConfig {
+        bool enabled = false;
+        float threshold = -0.05f;  // In normalized payoff units, like the advantages
+        float probability = 0.95f;
+        int start_iteration = 10;
+    };
+
     // Neural networks for advantage estimation (one per player)
     std::vector<std::shared_ptr<NeuralNet>> advantage_nets_;
     
     // Neural network for the average policy
     std::shared_ptr<NeuralNet> strategy_net_;
     
-    // Reservoir buffers for advantage training (one per player)
-    std::vector<ReservoirBuffer<AdvantageMemory>> advantage_buffers_;
+    // Reservoir buffers for advantage training (one per player), holding encoded features and regrets
+    std::vector<std::unique_ptr<SampleBuffer>> advantage_buffers_;
     
-    // Reservoir buffer for strategy training
-    ReservoirBuffer<StrategyMemory> strategy_buffer_;
+    // Reservoir buffer for strategy training, holding encoded features and strategies
+    std::unique_ptr<SampleBuffer> strategy_buffer_;
     
-    // Random number generator
-    std::mt19937 rng_;
+    // Run seed; every random stream of a run is keyed by it
+    uint64_t seed_;
+    uint32_t completed_iterations_;  // Across train() calls, so streams never repeat
+
+    // Traversal workers (none when running single-threaded) and one context per traversal
+    // of the window in flight
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<TraversalContext> contexts_;
+
+    // Pipelined training: the latest published snapshot, and the lock shared by sample
+    // flushes and learner minibatch draws
+    bool pipelined_;
+    std::shared_ptr<const NetSnapshot> snapshot_;  // Accessed only through std::atomic_load/store
+    std::mutex buffer_mutex_;
+
+    // Buffers take concurrent inserts, so workers flush straight after each traversal
+    // instead of in traversal order under buffer_mutex_
+    bool concurrent_buffers_;
+
+    // Distributed worker: flushed samples go to the learner instead of the local buffers
+    Connection* sample_sink_;
+    SampleBatch pending_samples_;
+
+    std::unique_ptr<Metrics> metrics_;  // Null unless enableMetrics was called
     
     // Parameters
     int num_players_;
     int num_traversals_;
     int num_actions_;
+    ArenaPrecision buffer_precision_;
     float alpha_; // Linear weighting of iterations (typically 2.0)
+    int train_steps_; // SGD steps per network update
+    PruningConfig pruning_;
+    TraversalScheme traversal_scheme_;
+    float exploration_;      // OUTCOME: weight of the uniform policy in the sampling mix
+    size_t robust_actions_;  // ROBUST: actions expanded per traverser decision
     std::vector<float> iteration_weights_;
+
+    // Batched inference: per-player brokers that coalesce the traversal workers' advantage
+    // queries, alive only while runTraversals runs (0 = disabled)
+    size_t inference_batch_size_;
+    std::chrono::microseconds inference_delay_;
+    std::vector<std::unique_ptr<InferenceBroker>> inference_brokers_;
+
+    // Packed CPU copies of the networks used for inference when fast inference is enabled
+    std::vector<std::shared_ptr<FastMLP>> fast_advantage_nets_;
+    std::shared_ptr<FastMLP> fast_strategy_net_;
+    bool fast_inference_;
+
+    // Post-training quantized strategy network serving getActionProbabilities, if built
+    std::shared_ptr<QuantizedMLP> quantized_strategy_net_;
+
+    // Single Deep CFR: per-iteration advantage snapshots standing in for the strategy network
+    std::unique_ptr<SnapshotStore> snapshots_;
     
     // Helper methods
-    float traverseCFR(Game& state, int traversing_player, int iteration, float reach_prob);
+    void initNetworks();
+    void seedBuffers(uint32_t iteration = 0);
+    void ensureIterationWeights(size_t iterations);
+    float traverseCFR(Game& state, int traversing_player, int iteration, float reach_prob, TraversalContext& context);
+    // Traversal streams are keyed by seed: seed_, or a distributed worker's own seed
+    void runTraversals(int player_id, int iteration, uint64_t seed);
+    void flushSamples(TraversalContext& context);
+    std::vector<float> chooseActions(const std::vector<float>& strategy, TraversalContext& context) const;
     std::vector<float> computeStrategy(const InfoState& info_state, int player_id);
+    std::vector<float> computeStrategy(const std::vector<float>& features, size_t num_legal_actions, int player_id);
+    std::vector<float> predictAdvantages(const std::vector<float>& features, int player_id);
+    std::vector<float> predictAdvantages(const std::vector<float>& features, int player_id, const TraversalContext& context);
+    float trainOnBuffer(NeuralNet& net, SampleBuffer& buffer, int batch_size);
     void updateAdvantageNet(int player_id, int batch_size);
     void updateStrategyNet(int batch_size);
+    void refreshFastNets();
+    void publishSnapshot(int player_id, const std::vector<DenseLayer>& layers);
+    void requireSnapshotBuffers() const;
+    void sendPendingSamples();
+
+    // trainSteps with the SGD and batch assembly time and the rows trained on recorded
+    TrainStats trainNet(NeuralNet& net, BatchSource& source, int batch_size);
+    void learnerLoop(int advantage_batch_size, int strategy_batch_size, const std::atomic<bool>& stop, size_t& rounds);
 
 public:
     DeepCFR(int num_players, 
             int num_traversals = 1000,
             float alpha = 2.0,
-            int num_actions = MAX_ACTIONS);
+            int num_actions = MAX_ACTIONS,
+            ArenaPrecision buffer_precision = ArenaPrecision::FP32);
     
+    // Replace the in-RAM reservoir buffers with memory-mapped files in directory,
+    // so capacity is limited by disk rather than RAM. Existing files are resumed.
+    void useDiskBuffers(const std::string& directory, size_t capacity);
+
+    // Admit strategy samples by A-Res weighted reservoir sampling on their Linear CFR
+    // iteration weight instead of storing them uniformly and weighting the loss
+    void useWeightedStrategyReservoir(size_t capacity = 1000000);
+
+    // Replace the reservoir buffers with lock-free ConcurrentReservoirBuffers that traversal
+    // workers insert into as soon as a traversal finishes. Buffer contents then depend on
+    // thread scheduling, and the buffers cannot be snapshotted.
+    void useConcurrentBuffers(size_t capacity = 1000000);
+
+    // Run computeStrategy and getActionProbabilities on FastMLP copies of the networks
+    // instead of LibTorch; the copies are refreshed whenever a network is trained or loaded
+    void useFastInference(bool enable = true);
+
+    // Send traversal advantage queries through per-player InferenceBrokers, so that the
+    // workers' single rows run as LibTorch batches of up to max_batch_size. Pays off with
+    // many traversal threads; ignored under fast inference and pipelined training, which
+    // query FastMLP copies instead. max_batch_size 0 disables.
+    void useBatchedInference(size_t max_batch_size = 256,
+                             std::chrono::microseconds max_delay = std::chrono::microseconds(200));
+
+    // Run traversals on num_threads workers (1 = on the calling thread). Results do not
+    // depend on the thread count.
+    void setNumThreads(size_t num_threads);
+
+    // Make the run reproducible: reseeds LibTorch and the reservoir buffers and
+    // reinitializes the networks, so call it before training or loading. Traversal
+    // randomness is drawn from Philox streams keyed by (seed, iteration, player, traversal,
+    // purpose). Without a call the seed comes from std::random_device.
+    void setSeed(uint64_t seed);
+    uint64_t seed() const { return seed_; }
+
+    // Record phase timings and work counters (metrics.hpp) from here on. Call it before
+    // training, not during.
+    void enableMetrics();
+
+    // Totals since enableMetrics; all zero while metrics are disabled
+    MetricsCounts metrics() const;
+
+    // Number of SGD steps each network update runs on freshly sampled minibatches (default 1)
+    void setTrainingSteps(int steps);
+
+    // Regret-based pruning: from start_iteration on, each traversal with the given probability
+    // skips the traverser's actions whose predicted advantage is below threshold. River nodes
+    // and all-in actions are always expanded, and so is every action while the strategy is
+    // uniform. A pruned action's regret sample is its predicted advantage.
+    void enablePruning(float threshold = -0.05f, float probability = 0.95f, int start_iteration = 10);
+
+    // Select how traversals explore the traverser's actions (default EXTERNAL). Pruning only
+    // applies to EXTERNAL, the other schemes already expand a bounded number of actions.
+    void setTraversalScheme(TraversalScheme scheme, size_t robust_actions = 2, float exploration = 0.6f);
+
+    // Quantize the strategy network for play. Calibrates on calibration_rows strategy buffer
+    // samples and reports accuracy against fp32 on holdout_rows different ones. Training or
+    // loading the strategy network drops the quantized copy.
+    QuantizationReport quantizeStrategyNet(QuantizedMLP::Precision precision = QuantizedMLP::Precision::INT8,
+                                           size_t calibration_rows = 4096,
+                                           size_t holdout_rows = 4096);
+
+    // Write the quantized strategy network to path/strategy_net.qnet, or load one back for
+    // play. Loading needs neither the fp32 strategy network nor the strategy buffer.
+    void saveQuantizedStrategyNet(const std::string& path) const;
+    void loadQuantizedStrategyNet(const std::string& path);
+
     // Train the Deep CFR agent
     void train(int iterations, int advantage_batch_size = 128, int strategy_batch_size = 128);
+
+    // Single Deep CFR (Steinberger 2019): instead of strategy traversals and a strategy
+    // network, every advantage network is stored in directory after each iteration and the
+    // average strategy is played by sampling one snapshot per hand, weighted like Linear CFR.
+    // Snapshots already in directory are kept, so this also opens a finished run for play.
+    void useSingleDeepCFR(const std::string& directory);
+    bool usesSingleDeepCFR() const { return snapshots_ != nullptr; }
+
+    // SD-CFR play: the snapshot player_id plays a hand with, given u uniform in [0, 1)
+    size_t sampleSnapshot(int player_id, float u) const;
+
+    // SD-CFR play: the regret-matched strategy of one snapshot, over the legal actions
+    std::vector<float> getActionProbabilities(const InfoState& info_state, size_t snapshot);
+
+    // Train with traversals and network updates overlapped: actors run the usual traversal
+    // passes against the most recently published FastMLP snapshots of the advantage networks
+    // while a learner thread keeps training every network on the growing buffers, publishing
+    // a fresh snapshot after each advantage update. Trades the strict alternation of train()
+    // (and its reproducibility) for keeping every core busy for the whole run.
+    void trainPipelined(int iterations, int advantage_batch_size = 128, int strategy_batch_size = 128);
     
-    // Get action probabilities for a given info state
+    // Get action probabilities for a given info state. Under SD-CFR this is the
+    // weight-averaged strategy of all snapshots, which ignores each snapshot's reach
+    // probability; per-hand snapshot sampling plays the exact average strategy.
     std::vector<float> getActionProbabilities(const InfoState& info_state);
+
+    // getActionProbabilities for many states at once; the LibTorch strategy network runs
+    // them as a single batch. Safe to call from several threads.
+    std::vector<std::vector<float>> getActionProbabilities(const std::vector<InfoState>& info_states);
+
+    // The acting player's advantage network over the legal actions: its estimate of each
+    // action's value relative to the information state, in traversal payoff units (chips
+    // over the sum of the players' starting stacks)
+    std::vector<float> getActionAdvantages(const InfoState& info_state);
+
+    // Positive parts of the first num_legal_actions values, normalized (uniform if none is
+    // positive). Also turns raw strategy network outputs into a distribution.
+    static std::vector<float> regretMatching(const std::vector<float>& advantages, size_t num_legal_actions);
+
+    int getNumPlayers() const { return num_players_; }
     
-    // Save and load models
+    // Distributed training over the transport in distributed.hpp. The learner accepts workers
+    // on endpoint, adds the samples they stream to its reservoir buffers and runs iterations
+    // training rounds, each once every buffer has received a fresh batch's worth of samples;
+    // every advantage update is broadcast to all workers. Workers traverse continuously
+    // against the latest weights received (as in trainPipelined) until the learner shuts
+    // them down. Each worker's streams are keyed by the id the learner assigns it, so
+    // workers started with the same seed still explore different traversals. Throws if a
+    // round is waiting for samples and no worker has been connected for two minutes.
+    void runLearner(const std::string& endpoint, int iterations, int advantage_batch_size = 128, int strategy_batch_size = 128);
+    void runWorker(const std::string& endpoint);
+
+    // Save and load models. saveModels also writes flat .bin weight files next to the .pt archives.
     void saveModels(const std::string& path);
     void loadModels(const std::string& path);
+
+    // Serve inference straight from the flat weight files written by saveModels, mapped
+    // read-only and shared with every other process using them. Skips LibTorch entirely;
+    // the networks themselves stay untrained until loadModels or training.
+    void loadFastModels(const std::string& path);
+
+    // Snapshot and restore the reservoir buffers. Snapshots to the same directory
+    // only write samples changed since the previous one; restore maps them in place.
+    void saveBuffers(const std::string& path);
+    void loadBuffers(const std::string& path);
+
+    // Complete training state for resuming a run: networks with their optimizer state, the
+    // buffers (with their RNG state), LibTorch's generator states, the seed and the iteration
+    // count, which keys every traversal stream. Each checkpoint is written to a temporary directory, synced, renamed
+    // to directory/checkpoint_<iteration> and only then named in directory/LATEST, so an
+    // interruption at any point leaves the previous checkpoint loadable. The newest keep
+    // checkpoints are retained. Disk buffers (useDiskBuffers) overwrite samples in place,
+    // so checkpoints refuse them rather than resume against buffers from a later iteration.
+    void saveCheckpoint(const std::string& directory, int keep = 2);
+
+    // Restore the checkpoint directory/LATEST names, after configuring the agent as for the
+    // original run; false when the directory holds no checkpoint yet
+    bool loadCheckpoint(const std::string& directory);
+
+    int completedIterations() const { return static_cast<int>(completed_iterations_); }
 }; 
\ No newline at end of file
@@ -13,6 +13,10 @@ private:
     bool explore_;
     float explore_prob_;
 
+    // SD-CFR: the snapshot playing the current hand, redrawn whenever the hole cards change
+    std::vector<Card> hand_;
+    size_t snapshot_ = 0;
+
 public:
     DeepCFRPlayer(int id, const std::string& name, int chips, 
                   std::shared_ptr<DeepCFR> deep_cfr,
@@ -29,7 +33,16 @@ public:
         InfoState info_state = InfoState::fromGame(game, getId());
         
         // Get action probabilities from Deep CFR
-        std::vector<float> probs = deep_cfr_->getActionProbabilities(info_state);
+        std::vector<float> probs;
+        if (deep_cfr_->usesSingleDeepCFR()) {
+            if (info_state.getHoleCards() != hand_) {
+                hand_ = info_state.getHoleCards();
+                snapshot_ = deep_cfr_->sampleSnapshot(getId(), std::uniform_real_distribution<float>(0, 1)(rng_));
+            }
+            probs = deep_cfr_->getActionProbabilities(info_state, snapshot_);
+        } else {
+            probs = deep_cfr_->getActionProbabilities(info_state);
+        }
         std::vector<Action> legal_actions = info_state.getLegalActions();
         
         // Exploration: with small probability, choose a random action
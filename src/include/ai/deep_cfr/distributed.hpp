@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "fast_mlp.hpp"
+
+// Transport and wire formats for distributed Deep CFR: worker processes run traversals and
+// stream their samples to one learner, which trains and broadcasts updated networks.
+//
+// Endpoints are "tcp://host:port" or "unix:/path/to/socket"; a learner on localhost plus
+// workers on the same machine needs nothing else. Every message is a frame
+//
+//   [magic u32][type u32][payload length u64][payload]
+//
+// in host byte order (the magic doubles as a byte-order check), so frames of any size go
+// over a stream socket without further delimiting.
+enum class MessageType : uint32_t {
+    HELLO = 1,     // worker -> learner, empty
+    WELCOME = 2,   // learner -> worker, u32 worker id
+    SAMPLES = 3,   // worker -> learner, encodeSamples
+    WEIGHTS = 4,   // learner -> worker, encodeWeights
+    SHUTDOWN = 5,  // learner -> worker, empty
+};
+
+// One connected stream socket carrying frames. send() may be called from several threads;
+// receive() from one at a time.
+class Connection {
+public:
+    Connection() = default;
+    explicit Connection(int fd);
+    ~Connection();
+
+    Connection(Connection&& other) noexcept;
+    Connection& operator=(Connection&& other) noexcept;
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    static Connection connect(const std::string& endpoint);
+
+    void send(MessageType type, const std::vector<uint8_t>& payload);
+
+    // Next frame; false once the peer has closed the connection
+    bool receive(MessageType& type, std::vector<uint8_t>& payload);
+
+    // Stop both directions, waking a thread blocked in receive()
+    void shutdown();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+private:
+    int fd_ = -1;
+    std::unique_ptr<std::mutex> send_mutex_ = std::make_unique<std::mutex>();
+};
+
+// Listening socket the learner accepts workers on
+class Listener {
+public:
+    explicit Listener(const std::string& endpoint);
+    ~Listener();
+
+    Listener(const Listener&) = delete;
+    Listener& operator=(const Listener&) = delete;
+
+    // Block for the next worker; throws once close() has been called
+    Connection accept();
+
+    // Stop accepting, waking a thread blocked in accept()
+    void close();
+
+    // The endpoint workers should connect to, with an ephemeral TCP port resolved
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    int fd_ = -1;
+    std::string endpoint_;
+    std::string unix_path_;
+};
+
+// Rows bound for the learner's reservoir buffers. buffers[i] is the advantage buffer (player
+// id) row i belongs to, or the number of players for the strategy buffer.
+struct SampleBatch {
+    size_t feature_size = 0;
+    size_t target_size = 0;
+    std::vector<float> features;  // rows x feature_size
+    std::vector<float> targets;   // rows x target_size
+    std::vector<float> weights;
+    std::vector<int32_t> buffers;
+
+    size_t size() const { return weights.size(); }
+    void clear() {
+        features.clear();
+        targets.clear();
+        weights.clear();
+        buffers.clear();
+    }
+};
+
+// Features travel as (index u16, fp16 value) pairs of their nonzero entries and targets as
+// fp16, about a tenth of the raw size for the sparse Deep CFR encoding. Decoding throws
+// unless the batch has the receiver's feature_size and target_size, checked before anything
+// is allocated.
+std::vector<uint8_t> encodeSamples(const SampleBatch& batch);
+SampleBatch decodeSamples(const std::vector<uint8_t>& payload, size_t feature_size, size_t target_size);
+
+// One network at full precision: the learner iteration it comes from, which network (player
+// id, or the number of players for the strategy network) and its layers
+struct WeightsMessage {
+    uint32_t iteration = 0;
+    int32_t net = 0;
+    std::vector<DenseLayer> layers;
+};
+
+std::vector<uint8_t> encodeWeights(const WeightsMessage& message);
+WeightsMessage decodeWeights(const std::vector<uint8_t>& payload);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "deep_cfr.hpp"
+#include "win_rate.hpp"
+
+// Heads-up comparison of two agents with variance reduction.
+//
+// Duplicate: every deal is played twice from the same seeded deck and button with the agents
+// in swapped seats, so card luck largely cancels within the pair.
+//
+// AIVAT-style control variate: at each decision the acting agent's advantage network gives
+// an estimate q of every legal action's value, and A's result is corrected by
+//
+//   sum_a pi(a) q(a) - q(chosen)
+//
+// (negated for B's decisions). The correction has zero mean because the action is sampled
+// from pi itself, so the estimate stays unbiased however rough q is; a per-state offset in q
+// cancels, which is why advantages are enough. Chance nodes are left to duplicate dealing.
+struct MatchConfig {
+    int deals = 10000;      // Each played twice
+    int starting_chips = 1000;
+    int small_blind = 10;
+    int big_blind = 20;
+    uint64_t seed = 0;
+    size_t threads = 0;     // 0 = one per core
+};
+
+struct MatchResult {
+    WinRate single;     // Every hand on its own
+    WinRate duplicate;  // Seat-swapped pairs
+    WinRate aivat;      // Pairs with the control variate
+
+    // How many times fewer games each estimator needs than single hands for the same error
+    double duplicateReduction() const;
+    double aivatReduction() const;
+
+    std::string toString() const;
+};
+
+class DuplicateMatch {
+public:
+    // Both agents must be heads-up models; A's winnings are reported
+    DuplicateMatch(DeepCFR& a, DeepCFR& b, const MatchConfig& config);
+
+    // Play every deal across the thread pool. Decks and action choices come from Philox
+    // streams keyed by (seed, deal), so the result does not depend on the thread count.
+    MatchResult run();
+
+    // A's winnings in chips with A in seat a_seat, and the same with the control variate
+    double playHand(size_t deal, int a_seat, double& corrected);
+
+private:
+    DeepCFR& a_;
+    DeepCFR& b_;
+    MatchConfig config_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Dense layer as exported from a torch::nn::Linear: weight is [output_size x input_size] row-major
+struct DenseLayer {
+    size_t input_size;
+    size_t output_size;
+    std::vector<float> weight;
+    std::vector<float> bias;
+};
+
+// Dependency-free CPU inference for the Deep CFR MLP (Linear layers with ReLU between them
+// and no activation after the last one). No autograd, no dispatcher, no allocation per call.
+//
+// Each layer is repacked into panels of PANEL_WIDTH output neurons stored input-major,
+// [panel][input][PANEL_WIDTH], so a GEMV streams one panel sequentially while whole panels
+// of accumulators stay in vector registers. A batch is pushed through one layer at a time
+// and each panel is applied to every row before moving on, so it is read from L1 once per
+// block of rows instead of once per row. Inputs that are exactly zero (one-hot features,
+// ReLU outputs) are compacted out once per layer, so the kernels only visit active inputs.
+// Kernels are picked at runtime: AVX-512F, AVX2+FMA or scalar.
+class FastMLP {
+public:
+    enum class Isa { SCALAR, AVX2, AVX512 };
+
+    static constexpr size_t PANEL_WIDTH = 16;
+    static constexpr size_t ALIGNMENT = 64;
+
+    struct Layer {
+        size_t input_size;
+        size_t output_size;
+        const float* weights;  // panels() x input_size x PANEL_WIDTH
+        const float* bias;     // panels() x PANEL_WIDTH, zero padded
+
+        size_t panels() const { return (output_size + PANEL_WIDTH - 1) / PANEL_WIDTH; }
+        size_t paddedOutputSize() const { return panels() * PANEL_WIDTH; }
+    };
+
+    FastMLP();
+    explicit FastMLP(const std::vector<DenseLayer>& layers);
+
+    // Adopt layers that are already packed; storage keeps their memory alive (e.g. a mapped file)
+    FastMLP(std::vector<Layer> layers, std::shared_ptr<const void> storage);
+
+    // Number of floats packLayer writes for the weights and bias of an input_size x output_size layer
+    static size_t packedWeightCount(size_t input_size, size_t output_size);
+    static size_t packedBiasCount(size_t output_size);
+    static void packLayer(const DenseLayer& layer, float* weights_out, float* bias_out);
+
+    // Forward pass over rows contiguous input rows; writes rows x outputSize() floats
+    void forward(const float* inputs, size_t rows, float* outputs) const;
+    std::vector<float> predict(const std::vector<float>& features) const;
+
+    size_t inputSize() const { return layers_.empty() ? 0 : layers_.front().input_size; }
+    size_t outputSize() const { return layers_.empty() ? 0 : layers_.back().output_size; }
+    const std::vector<Layer>& layers() const { return layers_; }
+    bool empty() const { return layers_.empty(); }
+
+    // Best kernel set supported by this CPU
+    static Isa detectIsa();
+    Isa isa() const { return isa_; }
+
+    // Force a kernel set (for tests and benchmarks); unsupported choices fall back to detectIsa()
+    void setIsa(Isa isa);
+
+private:
+    std::vector<Layer> layers_;
+    std::shared_ptr<const void> storage_;
+    Isa isa_;
+    size_t max_width_;
+    size_t max_input_;
+
+    void validate();
+};
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <utility>
+#include "half.hpp"
+#include "mapped_file.hpp"
+#include "sample_buffer.hpp"
+
+// Storage precision of the feature/target arenas
+enum class ArenaPrecision {
+    FP32,
+    FP16
+};
+
+// Admission policy once the reservoir is full
+enum class ReservoirMode {
+    UNIFORM,  // Algorithm R: every offered sample is kept with equal probability
+    WEIGHTED  // A-Res: samples are kept with probability increasing in their weight
+};
+
+// Reservoir sampling buffer that stores pre-encoded samples in contiguous
+// structure-of-arrays arenas: one row of features, one row of targets and a
+// weight per slot. Batches are gathered straight into caller-provided memory
+// (e.g. a pinned training tensor) without materializing per-sample objects.
+//
+// In WEIGHTED mode each sample gets the A-Res key u^(1/w) and the buffer keeps
+// the capacity samples with the largest keys, so the sample weight is folded into
+// admission and gathered weights are reported as 1.
+//
+// snapshot() writes the arenas, counters and RNG state to a file laid out with one
+// fixed offset per slot, so repeated snapshots to the same path only write the slots
+// changed since the previous one. The header's complete flag is cleared and synced
+// before any slot is rewritten and set again once the data is synced, so restore()
+// rejects a file left behind by an interrupted snapshot. restore() maps the file
+// copy-on-write and uses the arenas in place; only pages touched by later inserts
+// are copied into memory.
+class FeatureReservoirBuffer : public SampleBuffer {
+private:
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t precision;
+        uint32_t mode;
+        uint32_t rng_state_bytes;
+        uint32_t complete;  // 0 while a snapshot is being written over the file
+        uint32_t reserved;
+        uint64_t capacity;
+        uint64_t feature_size;
+        uint64_t target_size;
+        uint64_t size;
+        uint64_t count;
+        uint64_t features_offset;
+        uint64_t targets_offset;
+        uint64_t weights_offset;
+        uint64_t keys_offset;
+        uint64_t file_size;
+    };
+
+    struct SnapshotKey {
+        float key;
+        uint32_t reserved;
+        uint64_t slot;
+    };
+
+    static constexpr char SNAPSHOT_MAGIC[8] = {'P', 'K', 'R', 'S', 'N', 'A', 'P', '1'};
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+    static constexpr size_t SNAPSHOT_HEADER_BYTES = 16384;  // Header followed by the serialized RNG
+    static constexpr size_t SECTION_ALIGNMENT = 4096;
+
+    size_t capacity_;
+    size_t feature_size_;
+    size_t target_size_;
+    ArenaPrecision precision_;
+    ReservoirMode mode_;
+    size_t element_size_;
+    size_t size_;
+    size_t count_;
+
+    // Arenas are owned and grown on demand, or point into a restored snapshot mapping
+    std::vector<uint8_t> owned_features_;
+    std::vector<uint8_t> owned_targets_;
+    std::vector<float> owned_weights_;
+    MappedFile snapshot_map_;
+    uint8_t* features_;
+    uint8_t* targets_;
+    float* weights_;
+
+    // WEIGHTED mode: min-heap of (log key, slot) over the stored samples
+    std::vector<std::pair<float, size_t>> key_heap_;
+
+    // One bit per slot written since the last snapshot to snapshot_path_, and the identity
+    // of that file, which survives renames
+    std::vector<uint64_t> dirty_;
+    std::string snapshot_path_;
+    dev_t snapshot_device_;
+    ino_t snapshot_inode_;
+
+    std::mt19937 rng_;
+
+    static size_t alignSection(size_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    SnapshotHeader snapshotLayout() const {
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = SNAPSHOT_VERSION;
+        header.precision = static_cast<uint32_t>(precision_);
+        header.mode = static_cast<uint32_t>(mode_);
+        header.capacity = capacity_;
+        header.feature_size = feature_size_;
+        header.target_size = target_size_;
+        header.size = size_;
+        header.count = count_;
+        header.features_offset = SNAPSHOT_HEADER_BYTES;
+        header.targets_offset = alignSection(header.features_offset + capacity_ * feature_size_ * element_size_);
+        header.weights_offset = alignSection(header.targets_offset + capacity_ * target_size_ * element_size_);
+        header.keys_offset = alignSection(header.weights_offset + capacity_ * sizeof(float));
+        header.file_size = alignSection(header.keys_offset + capacity_ * sizeof(SnapshotKey));
+        return header;
+    }
+
+    void rememberSnapshotFile() {
+        struct stat st;
+        if (::stat(snapshot_path_.c_str(), &st) != 0) {
+            throw std::runtime_error("Failed to stat snapshot '" + snapshot_path_ + "': " + std::strerror(errno));
+        }
+        snapshot_device_ = st.st_dev;
+        snapshot_inode_ = st.st_ino;
+    }
+
+    void markDirty(size_t slot) { dirty_[slot / 64] |= uint64_t(1) << (slot % 64); }
+    bool isDirty(size_t slot) const { return (dirty_[slot / 64] >> (slot % 64)) & 1u; }
+
+    void grow() {
+        size_t rows = size_ + 1;
+        if (!snapshot_map_.isOpen()) {
+            owned_features_.resize(rows * feature_size_ * element_size_);
+            owned_targets_.resize(rows * target_size_ * element_size_);
+            owned_weights_.resize(rows);
+            features_ = owned_features_.data();
+            targets_ = owned_targets_.data();
+            weights_ = owned_weights_.data();
+        }
+        dirty_.resize((rows + 63) / 64, 0);
+        size_ = rows;
+    }
+
+    // Copy a row into the arena, zero-padding targets shorter than target_size_
+    void store(size_t slot, const float* features, const float* targets, size_t num_targets, float weight) {
+        num_targets = std::min(num_targets, target_size_);
+        if (precision_ == ArenaPrecision::FP32) {
+            float* feature_row = reinterpret_cast<float*>(features_) + slot * feature_size_;
+            std::copy(features, features + feature_size_, feature_row);
+            float* target_row = reinterpret_cast<float*>(targets_) + slot * target_size_;
+            std::copy(targets, targets + num_targets, target_row);
+            std::fill(target_row + num_targets, target_row + target_size_, 0.0f);
+        } else {
+            uint16_t* feature_row = reinterpret_cast<uint16_t*>(features_) + slot * feature_size_;
+            for (size_t i = 0; i < feature_size_; i++) {
+                feature_row[i] = floatToHalf(features[i]);
+            }
+            uint16_t* target_row = reinterpret_cast<uint16_t*>(targets_) + slot * target_size_;
+            for (size_t i = 0; i < num_targets; i++) {
+                target_row[i] = floatToHalf(targets[i]);
+            }
+            std::fill(target_row + num_targets, target_row + target_size_, static_cast<uint16_t>(0));
+        }
+        weights_[slot] = weight;
+        markDirty(slot);
+    }
+
+    void addWeighted(const float* features, const float* targets, size_t num_targets, float weight) {
+        if (!(weight > 0.0f)) return;
+
+        // log(u^(1/w)) = log(u) / w keeps keys representable for large weights
+        float u = std::uniform_real_distribution<float>(std::numeric_limits<float>::min(), 1.0f)(rng_);
+        float key = std::log(u) / weight;
+        auto greater = [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) {
+            return a.first > b.first;
+        };
+
+        if (size_ < capacity_) {
+            grow();
+            store(size_ - 1, features, targets, num_targets, weight);
+            key_heap_.emplace_back(key, size_ - 1);
+            std::push_heap(key_heap_.begin(), key_heap_.end(), greater);
+        } else if (key > key_heap_.front().first) {
+            std::pop_heap(key_heap_.begin(), key_heap_.end(), greater);
+            size_t slot = key_heap_.back().second;
+            store(slot, features, targets, num_targets, weight);
+            key_heap_.back().first = key;
+            std::push_heap(key_heap_.begin(), key_heap_.end(), greater);
+        }
+    }
+
+    static void writeAt(int fd, const void* data, size_t length, size_t offset, const std::string& path) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (length > 0) {
+            ssize_t written = ::pwrite(fd, bytes, length, static_cast<off_t>(offset));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Failed to write snapshot '" + path + "': " + std::strerror(errno));
+            }
+            bytes += written;
+            length -= static_cast<size_t>(written);
+            offset += static_cast<size_t>(written);
+        }
+    }
+
+    static void syncData(int fd, const std::string& path) {
+        if (::fdatasync(fd) != 0) {
+            throw std::runtime_error("Failed to sync snapshot '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    // Write slots [begin, end) of every arena at their fixed offsets
+    void writeSlots(int fd, const SnapshotHeader& layout, size_t begin, size_t end, const std::string& path) const {
+        size_t feature_row = feature_size_ * element_size_;
+        size_t target_row = target_size_ * element_size_;
+        size_t rows = end - begin;
+        writeAt(fd, features_ + begin * feature_row, rows * feature_row,
+                layout.features_offset + begin * feature_row, path);
+        writeAt(fd, targets_ + begin * target_row, rows * target_row,
+                layout.targets_offset + begin * target_row, path);
+        writeAt(fd, weights_ + begin, rows * sizeof(float),
+                layout.weights_offset + begin * sizeof(float), path);
+    }
+
+public:
+    FeatureReservoirBuffer(size_t capacity,
+                           size_t feature_size,
+                           size_t target_size,
+                           ArenaPrecision precision = ArenaPrecision::FP32,
+                           ReservoirMode mode = ReservoirMode::UNIFORM)
+        : capacity_(capacity),
+          feature_size_(feature_size),
+          target_size_(target_size),
+          precision_(precision),
+          mode_(mode),
+          element_size_(precision == ArenaPrecision::FP32 ? sizeof(float) : sizeof(uint16_t)),
+          size_(0),
+          count_(0),
+          features_(nullptr),
+          targets_(nullptr),
+          weights_(nullptr),
+          snapshot_device_(0),
+          snapshot_inode_(0),
+          rng_(std::random_device{}()) {}
+
+    using SampleBuffer::add;
+    using SampleBuffer::sample;
+
+    // Add a sample using reservoir sampling (Algorithm R, or A-Res in WEIGHTED mode)
+    void add(const float* features, const float* targets, size_t num_targets, float weight) override {
+        if (mode_ == ReservoirMode::WEIGHTED) {
+            addWeighted(features, targets, num_targets, weight);
+        } else if (size_ < capacity_) {
+            grow();
+            store(size_ - 1, features, targets, num_targets, weight);
+        } else {
+            size_t j = std::uniform_int_distribution<size_t>(0, count_)(rng_);
+            if (j < capacity_) {
+                store(j, features, targets, num_targets, weight);
+            }
+        }
+        count_++;
+    }
+
+    // Draw batch_size distinct slot indices in O(batch_size)
+    void sampleIndices(size_t batch_size, std::vector<size_t>& indices) {
+        sampleDistinctIndices(size_, batch_size, rng_, indices);
+    }
+
+    // Gather rows into row-major float outputs ([rows x feature_size], [rows x target_size], [rows])
+    void gather(const std::vector<size_t>& indices,
+                float* features_out,
+                float* targets_out,
+                float* weights_out = nullptr) const {
+        for (size_t r = 0; r < indices.size(); r++) {
+            size_t slot = indices[r];
+            float* feature_row = features_out + r * feature_size_;
+            float* target_row = targets_out + r * target_size_;
+            if (precision_ == ArenaPrecision::FP32) {
+                const float* src = reinterpret_cast<const float*>(features_) + slot * feature_size_;
+                std::copy(src, src + feature_size_, feature_row);
+                const float* target_src = reinterpret_cast<const float*>(targets_) + slot * target_size_;
+                std::copy(target_src, target_src + target_size_, target_row);
+            } else {
+                const uint16_t* src = reinterpret_cast<const uint16_t*>(features_) + slot * feature_size_;
+                for (size_t i = 0; i < feature_size_; i++) {
+                    feature_row[i] = halfToFloat(src[i]);
+                }
+                const uint16_t* target_src = reinterpret_cast<const uint16_t*>(targets_) + slot * target_size_;
+                for (size_t i = 0; i < target_size_; i++) {
+                    target_row[i] = halfToFloat(target_src[i]);
+                }
+            }
+            if (weights_out) {
+                weights_out[r] = mode_ == ReservoirMode::WEIGHTED ? 1.0f : weights_[slot];
+            }
+        }
+    }
+
+    // Sample a batch and gather it; returns the number of rows written
+    size_t sample(size_t batch_size, float* features_out, float* targets_out, float* weights_out) override {
+        std::vector<size_t> indices;
+        sampleIndices(batch_size, indices);
+        gather(indices, features_out, targets_out, weights_out);
+        return indices.size();
+    }
+
+    // Stream the buffer to path. If the last snapshot went to the same path only the
+    // slots written since then are rewritten. An interrupted snapshot leaves the file
+    // marked incomplete, and the previous snapshot at path is lost with it.
+    void snapshot(const std::string& path) override {
+        SnapshotHeader layout = snapshotLayout();
+        bool incremental = path == snapshot_path_;
+
+        // No O_TRUNC: path may be the file the arenas are currently mapped from
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open snapshot '" + path + "': " + std::strerror(errno));
+        }
+        try {
+            // Sparse preallocation so every slot has a fixed offset
+            if (::ftruncate(fd, static_cast<off_t>(layout.file_size)) != 0) {
+                throw std::runtime_error("Failed to size snapshot '" + path + "': " + std::strerror(errno));
+            }
+
+            // Invalidate whatever snapshot the file holds before overwriting any of it
+            const uint32_t incomplete = 0;
+            writeAt(fd, &incomplete, sizeof(incomplete), offsetof(SnapshotHeader, complete), path);
+            syncData(fd, path);
+
+            // Coalesce runs of dirty slots into single writes per arena
+            size_t slot = 0;
+            while (slot < size_) {
+                if (incremental && !isDirty(slot)) {
+                    slot++;
+                    continue;
+                }
+                size_t end = slot + 1;
+                while (end < size_ && (!incremental || isDirty(end))) {
+                    end++;
+                }
+                writeSlots(fd, layout, slot, end, path);
+                slot = end;
+            }
+
+            // Heap order changes on every admission, so the key section is rewritten whole
+            if (mode_ == ReservoirMode::WEIGHTED && !key_heap_.empty()) {
+                std::vector<SnapshotKey> keys(key_heap_.size());
+                for (size_t i = 0; i < key_heap_.size(); i++) {
+                    keys[i] = {key_heap_[i].first, 0, key_heap_[i].second};
+                }
+                writeAt(fd, keys.data(), keys.size() * sizeof(SnapshotKey), layout.keys_offset, path);
+            }
+            syncData(fd, path);
+
+            std::ostringstream rng_state;
+            rng_state << rng_;
+            std::string state = rng_state.str();
+            if (sizeof(SnapshotHeader) + state.size() > SNAPSHOT_HEADER_BYTES) {
+                throw std::runtime_error("RNG state does not fit in the snapshot header");
+            }
+            layout.rng_state_bytes = static_cast<uint32_t>(state.size());
+            layout.complete = 1;
+            std::vector<uint8_t> header_block(SNAPSHOT_HEADER_BYTES, 0);
+            std::memcpy(header_block.data(), &layout, sizeof(SnapshotHeader));
+            std::memcpy(header_block.data() + sizeof(SnapshotHeader), state.data(), state.size());
+            writeAt(fd, header_block.data(), header_block.size(), 0, path);
+            syncData(fd, path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+
+        std::fill(dirty_.begin(), dirty_.end(), 0);
+        snapshot_path_ = path;
+        rememberSnapshotFile();
+    }
+
+    bool cloneSnapshot(const std::string& previous, const std::string& path) override {
+        struct stat st;
+        if (snapshot_path_.empty() || ::stat(previous.c_str(), &st) != 0 ||
+            st.st_dev != snapshot_device_ || st.st_ino != snapshot_inode_) {
+            return false;
+        }
+        cloneFile(previous, path);
+        snapshot_path_ = path;
+        rememberSnapshotFile();
+        return true;
+    }
+
+    // Load a snapshot by mapping it copy-on-write; the arenas are used in place.
+    // Capacity, dimensions, precision and mode are taken from the file.
+    void restore(const std::string& path) override {
+        MappedFile map(path, MappedFile::Mode::COPY_ON_WRITE);
+        if (map.size() < SNAPSHOT_HEADER_BYTES) {
+            throw std::runtime_error("Snapshot '" + path + "' is truncated");
+        }
+
+        SnapshotHeader header;
+        std::memcpy(&header, map.data(), sizeof(SnapshotHeader));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+            header.version != SNAPSHOT_VERSION || map.size() < header.file_size) {
+            throw std::runtime_error("'" + path + "' is not a valid reservoir snapshot");
+        }
+        if (!header.complete) {
+            throw std::runtime_error("Snapshot '" + path + "' was interrupted before it completed");
+        }
+
+        capacity_ = header.capacity;
+        feature_size_ = header.feature_size;
+        target_size_ = header.target_size;
+        precision_ = static_cast<ArenaPrecision>(header.precision);
+        mode_ = static_cast<ReservoirMode>(header.mode);
+        element_size_ = precision_ == ArenaPrecision::FP32 ? sizeof(float) : sizeof(uint16_t);
+        size_ = header.size;
+        count_ = header.count;
+
+        std::istringstream rng_state(std::string(
+            reinterpret_cast<const char*>(map.data()) + sizeof(SnapshotHeader), header.rng_state_bytes));
+        rng_state >> rng_;
+
+        key_heap_.clear();
+        if (mode_ == ReservoirMode::WEIGHTED) {
+            const SnapshotKey* keys = reinterpret_cast<const SnapshotKey*>(map.data() + header.keys_offset);
+            key_heap_.reserve(size_);
+            for (size_t i = 0; i < size_; i++) {
+                key_heap_.emplace_back(keys[i].key, keys[i].slot);
+            }
+        }
+
+        owned_features_ = std::vector<uint8_t>();
+        owned_targets_ = std::vector<uint8_t>();
+        owned_weights_ = std::vector<float>();
+        snapshot_map_ = std::move(map);
+        features_ = snapshot_map_.data() + header.features_offset;
+        targets_ = snapshot_map_.data() + header.targets_offset;
+        weights_ = reinterpret_cast<float*>(snapshot_map_.data() + header.weights_offset);
+
+        dirty_.assign((capacity_ + 63) / 64, 0);
+        snapshot_path_ = path;
+        rememberSnapshotFile();
+    }
+
+    size_t size() const override { return size_; }
+    size_t capacity() const override { return capacity_; }
+    size_t count() const override { return count_; }
+    size_t featureSize() const override { return feature_size_; }
+    size_t targetSize() const override { return target_size_; }
+    ArenaPrecision precision() const { return precision_; }
+    ReservoirMode mode() const { return mode_; }
+
+    void seed(uint64_t seed) override { rng_.seed(static_cast<std::mt19937::result_type>(seed ^ (seed >> 32))); }
+
+    void clear() override {
+        snapshot_map_.unmap();
+        owned_features_.clear();
+        owned_targets_.clear();
+        owned_weights_.clear();
+        features_ = nullptr;
+        targets_ = nullptr;
+        weights_ = nullptr;
+        key_heap_.clear();
+        dirty_.clear();
+        snapshot_path_.clear();
+        size_ = 0;
+        count_ = 0;
+    }
+};
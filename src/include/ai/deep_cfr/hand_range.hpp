@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "card.hpp"
+#include "philox.hpp"
+
+// A distribution over an opponent's two hole cards: one weight per each of the 1326
+// two-card combos. Cards are indexed rank * 4 + suit over "23456789TJQKA" x "shdc".
+class HandRange {
+public:
+    static constexpr size_t NUM_CARDS = 52;
+    static constexpr size_t NUM_COMBOS = 1326;
+
+    // Uniform over every combo
+    HandRange();
+
+    static const std::vector<Card>& deck();
+    static int cardIndex(const Card& card);
+    static const std::pair<int, int>& combo(size_t index);
+    static std::vector<Card> comboCards(size_t index);
+    static size_t comboIndex(const Card& first, const Card& second);
+
+    float weight(size_t combo) const { return weights_[combo]; }
+    void setWeight(size_t combo, float weight) { weights_[combo] = weight; }
+    double total() const;
+
+    // Zero every combo holding one of cards, e.g. cards seen on the board
+    void removeCards(const std::vector<Card>& cards);
+
+    // Combos with positive weight
+    std::vector<size_t> liveCombos() const;
+
+    // Probability that hole beats a hand drawn from the range, ties counting half. With the
+    // board complete the range is enumerated exactly; otherwise runouts boards are completed
+    // from rng, each combo counting only on runouts it does not collide with.
+    double equity(const std::vector<Card>& hole, const std::vector<Card>& board, int runouts, Philox4x32& rng) const;
+
+private:
+    std::array<float, NUM_COMBOS> weights_;
+};
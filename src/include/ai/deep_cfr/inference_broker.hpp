@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Coalesces single-row inference requests from many threads into batched forward passes.
+//
+// Callers submit a feature row and wait on the returned future. A dedicated thread
+// collects pending rows into one batch, which is dispatched once it reaches
+// max_batch_size or once the oldest request has waited max_delay, and runs it
+// through the batch function (e.g. NeuralNet::predictBatch). The network behind the
+// function must not be trained while a broker is serving it.
+class InferenceBroker {
+public:
+    // Maps num_rows row-major input rows to num_rows row-major output rows
+    using BatchFunction = std::function<std::vector<float>(const float* rows, int64_t num_rows)>;
+
+private:
+    struct Request {
+        std::vector<float> features;
+        std::promise<std::vector<float>> result;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    BatchFunction predict_batch_;
+    size_t input_size_;
+    size_t output_size_;
+    size_t max_batch_size_;
+    std::chrono::microseconds max_delay_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> queue_;
+    bool stopping_;
+
+    std::atomic<size_t> batches_;
+    std::atomic<size_t> requests_;
+
+    std::thread worker_;
+
+    void run();
+
+public:
+    InferenceBroker(BatchFunction predict_batch,
+                    size_t input_size,
+                    size_t output_size,
+                    size_t max_batch_size = 256,
+                    std::chrono::microseconds max_delay = std::chrono::microseconds(200));
+    ~InferenceBroker();
+
+    InferenceBroker(const InferenceBroker&) = delete;
+    InferenceBroker& operator=(const InferenceBroker&) = delete;
+
+    // Queue a feature row for inference
+    std::future<std::vector<float>> submit(std::vector<float> features);
+
+    // Blocking convenience wrapper around submit()
+    std::vector<float> predict(const std::vector<float>& features) { return submit(features).get(); }
+
+    // Stop accepting work; pending requests are still served
+    void stop();
+
+    size_t batchesRun() const { return batches_.load(std::memory_order_relaxed); }
+    size_t requestsServed() const { return requests_.load(std::memory_order_relaxed); }
+    double averageBatchSize() const {
+        size_t batches = batchesRun();
+        return batches ? static_cast<double>(requestsServed()) / batches : 0.0;
+    }
+};
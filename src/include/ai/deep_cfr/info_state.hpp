@@ -56,5 +56,13 @@ public:
     const std::vector<Card>& getHoleCards() const { return hole_cards_; }
     const std::vector<Card>& getBoardCards() const { return board_cards_; }
     HandPhase::Phase getPhase() const { return phase_; }
+
+    // The same public state seen with other hole cards, e.g. to query a strategy for every
+    // hand in an opponent's range
+    InfoState withHoleCards(const std::vector<Card>& hole_cards) const {
+        InfoState state = *this;
+        state.hole_cards_ = hole_cards;
+        return state;
+    }
 };
 
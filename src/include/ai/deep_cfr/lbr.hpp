@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "deep_cfr.hpp"
+#include "hand_range.hpp"
+#include "win_rate.hpp"
+
+// Local best response (Lisy and Bowling, 2017): a lower bound on how exploitable a
+// heads-up strategy is, found by playing against it.
+//
+// LBR tracks the strategy's range, updating it by Bayes' rule with the strategy's own
+// probabilities after every action it takes. At each of its decisions LBR computes its
+// equity against that range and takes the legal action with the highest value
+//
+//   fold        0
+//   check/call  wp * pot - (1 - wp) * to_call
+//   raise       fp * pot + (1 - fp) * (wp * (pot + cost) - (1 - wp) * cost)
+//
+// where fp is the range's probability of folding to the raise. Each strategy decision and
+// each fold probability is one batched getActionProbabilities query over the range.
+struct LbrConfig {
+    int hands = 10000;
+    int starting_chips = 1000;
+    int small_blind = 10;
+    int big_blind = 20;
+    int runouts = 32;     // Boards sampled for equity before the river
+    uint64_t seed = 0;
+    size_t threads = 0;   // 0 = one per core
+};
+
+class LocalBestResponse {
+public:
+    LocalBestResponse(DeepCFR& strategy, const LbrConfig& config);
+
+    // Play config.hands independent hands across the thread pool, the button alternating.
+    // Returns LBR's win rate: the strategy is exploitable by at least this much. Hands are
+    // dealt from Philox streams keyed by (seed, hand), so the result does not depend on
+    // the thread count.
+    WinRate evaluate();
+
+    // LBR's winnings in chips on one hand
+    double playHand(size_t hand);
+
+private:
+    static constexpr int LBR_SEAT = 0;
+    static constexpr int STRATEGY_SEAT = 1;
+
+    DeepCFR& strategy_;
+    LbrConfig config_;
+
+    Action bestResponse(const Game& game, const std::vector<Action>& legal_actions, const HandRange& range,
+                        Philox4x32& rng);
+
+    // Probability the strategy folds in game (at its decision), over range
+    double foldProbability(const Game& game, const HandRange& range);
+};
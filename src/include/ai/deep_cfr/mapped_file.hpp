@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+// RAII wrapper around a file mapped into memory with mmap
+class MappedFile {
+private:
+    int fd_ = -1;
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool writable_ = false;
+
+    [[noreturn]] static void fail(const std::string& what, const std::string& path) {
+        throw std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+    }
+
+public:
+    enum class Mode {
+        READ_ONLY,     // Shared read-only mapping of an existing file
+        READ_WRITE,    // Shared writable mapping; stores reach the file
+        COPY_ON_WRITE  // Private writable mapping; stores stay in this process
+    };
+
+    MappedFile() = default;
+
+    // Map path, creating/resizing it to size bytes when size > 0 and the mode is READ_WRITE.
+    // A size of 0 maps the whole existing file.
+    MappedFile(const std::string& path, Mode mode, size_t size = 0) {
+        writable_ = mode != Mode::READ_ONLY;
+        int flags = mode == Mode::READ_WRITE ? (O_RDWR | O_CREAT) : O_RDONLY;
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0) fail("Failed to open", path);
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) fail("Failed to stat", path);
+
+        if (size == 0) {
+            size = static_cast<size_t>(st.st_size);
+        } else if (static_cast<size_t>(st.st_size) < size) {
+            if (mode != Mode::READ_WRITE) {
+                errno = EINVAL;
+                fail("File is smaller than requested mapping", path);
+            }
+            // Sparse extension: disk blocks are only allocated once written
+            if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) fail("Failed to resize", path);
+        }
+        if (size == 0) {
+            errno = EINVAL;
+            fail("Cannot map empty file", path);
+        }
+
+        int prot = writable_ ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        int map_flags = mode == Mode::COPY_ON_WRITE ? MAP_PRIVATE : MAP_SHARED;
+        void* addr = ::mmap(nullptr, size, prot, map_flags, fd_, 0);
+        if (addr == MAP_FAILED) fail("Failed to map", path);
+
+        data_ = static_cast<uint8_t*>(addr);
+        size_ = size;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            fd_ = other.fd_;
+            data_ = other.data_;
+            size_ = other.size_;
+            writable_ = other.writable_;
+            other.fd_ = -1;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    void unmap() {
+        if (data_) {
+            ::munmap(data_, size_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        size_ = 0;
+    }
+
+    // Page-granular access pattern hint for [offset, offset + length)
+    void advise(size_t offset, size_t length, int advice) const {
+        if (!data_ || length == 0) return;
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t begin = offset & ~(page - 1);
+        size_t end = std::min(offset + length, size_);
+        ::madvise(data_ + begin, end - begin, advice);
+    }
+
+    // Flush dirty pages of a shared mapping to the file
+    void sync(bool async = false) const {
+        if (data_ && writable_) {
+            ::msync(data_, size_, async ? MS_ASYNC : MS_SYNC);
+        }
+    }
+
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool isOpen() const { return data_ != nullptr; }
+};
+
+// Copy from to to. Filesystems with reflinks (btrfs, XFS) share the extents copy-on-write,
+// so the copy is O(1) and only blocks later rewritten in either file take new space.
+inline void cloneFile(const std::string& from, const std::string& to) {
+#ifdef FICLONE
+    int src = ::open(from.c_str(), O_RDONLY);
+    if (src >= 0) {
+        int dst = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool cloned = dst >= 0 && ::ioctl(dst, FICLONE, src) == 0;
+        if (dst >= 0) ::close(dst);
+        ::close(src);
+        if (cloned) return;
+    }
+#endif
+    std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing);
+}
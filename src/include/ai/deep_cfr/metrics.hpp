@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+// Training telemetry: time spent in each phase of Deep CFR and counts of the work done.
+//
+// Hot paths record into a MetricsCounts of their own (a traversal's context, a training
+// call) with plain arithmetic and merge it into the shared Metrics at a natural boundary,
+// so instrumentation adds no cross-thread traffic per node. Phase times are summed over
+// threads and nest (a traversal includes its encoding and inference), so they are
+// thread-seconds rather than shares of wall time.
+enum class Phase : size_t {
+    TRAVERSAL,       // Whole traversals, on the workers
+    ENCODING,        // InfoState construction and feature encoding
+    INFERENCE,       // Advantage network forward passes during traversals
+    BUFFER_INSERT,   // Flushing staged samples into the reservoir buffers
+    BATCH_ASSEMBLY,  // Gathering training minibatches, on the prefetch thread
+    SGD,             // Network updates, including waits for batches
+    COUNT
+};
+
+enum class Counter : size_t {
+    TRAVERSALS,
+    NODES,
+    ADVANTAGE_SAMPLES,
+    STRATEGY_SAMPLES,
+    INFERENCE_CALLS,
+    TRAINING_STEPS,
+    TRAINING_ROWS,
+    COUNT
+};
+
+const char* phaseName(Phase phase);
+const char* counterName(Counter counter);
+
+constexpr size_t NUM_PHASES = static_cast<size_t>(Phase::COUNT);
+constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter::COUNT);
+
+struct MetricsCounts {
+    std::array<uint64_t, NUM_PHASES> phase_nanos{};
+    std::array<uint64_t, NUM_PHASES> phase_calls{};
+    std::array<uint64_t, NUM_COUNTERS> counters{};
+
+    void add(Counter counter, uint64_t n = 1) { counters[static_cast<size_t>(counter)] += n; }
+    void addTime(Phase phase, uint64_t nanos) {
+        phase_nanos[static_cast<size_t>(phase)] += nanos;
+        phase_calls[static_cast<size_t>(phase)]++;
+    }
+
+    uint64_t count(Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+    uint64_t calls(Phase phase) const { return phase_calls[static_cast<size_t>(phase)]; }
+    double seconds(Phase phase) const { return phase_nanos[static_cast<size_t>(phase)] * 1e-9; }
+
+    MetricsCounts& operator+=(const MetricsCounts& other);
+    MetricsCounts operator-(const MetricsCounts& other) const;  // Counts since an earlier total
+    void clear() { *this = MetricsCounts(); }
+};
+
+// Run totals, merged into from any thread
+class Metrics {
+public:
+    void merge(const MetricsCounts& counts) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        total_ += counts;
+    }
+
+    MetricsCounts total() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    MetricsCounts total_;
+};
+
+// Adds the time until it goes out of scope to a phase; a null target makes it free apart
+// from one branch, which is how disabled metrics cost nothing
+class ScopedTimer {
+public:
+    ScopedTimer(MetricsCounts* counts, Phase phase) : counts_(counts), phase_(phase) {
+        if (counts_) start_ = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() { stop(); }
+
+    // Record now rather than at scope exit, for phases that end before their variables do
+    void stop() {
+        if (counts_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            counts_->addTime(phase_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            counts_ = nullptr;
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    MetricsCounts* counts_;
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// JSONL metrics stream: one object per write, with per-phase seconds and calls, the
+// counters and the derived rates, e.g.
+//
+//   {"iteration":3,"wall_seconds":41.2,"phases":{"traversal":{"seconds":..,"calls":..},..},
+//    "counters":{"nodes":..,..},"nodes_per_second":..,"samples_per_second":..,
+//    "mean_training_batch":..}
+class MetricsLog {
+public:
+    // Append to path, so a resumed run continues the same stream
+    explicit MetricsLog(const std::string& path);
+
+    void write(int iteration, double wall_seconds, const MetricsCounts& counts);
+
+private:
+    std::string path_;
+    std::ofstream out_;
+};
+
+// Human-readable summary: each phase's thread-seconds, calls and share of wall time, then
+// the counters and rates
+std::string formatMetricsTable(const MetricsCounts& counts, double wall_seconds);
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "half.hpp"
+#include "mapped_file.hpp"
+#include "sample_buffer.hpp"
+
+// Disk-backed reservoir buffer. Samples are stored as fixed-size compressed
+// records in a memory-mapped file, so capacity is bounded by disk rather than RAM:
+//
+//   [fp16 features x feature_size][int8 targets x target_size][pad][float target scale][float weight]
+//
+// Targets are quantized symmetrically per record (scale = max|target| / 127).
+// Reservoir replacement is a random-access write into the mapping and sampling
+// gathers the selected records after issuing readahead hints for their pages.
+// Reopening an existing file with the same dimensions resumes the reservoir.
+class MmapReservoirBuffer : public SampleBuffer {
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t capacity;
+        uint64_t feature_size;
+        uint64_t target_size;
+        uint64_t size;
+        uint64_t count;
+    };
+
+    static constexpr char MAGIC[8] = {'P', 'K', 'R', 'S', 'V', 'O', 'I', 'R'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 4096;
+    static constexpr size_t RECORD_ALIGNMENT = 64;
+
+    MappedFile file_;
+    Header* header_;
+    size_t capacity_;
+    size_t feature_size_;
+    size_t target_size_;
+    size_t targets_offset_;
+    size_t scale_offset_;
+    size_t weight_offset_;
+    size_t record_size_;
+    std::mt19937 rng_;
+
+    uint8_t* record(size_t slot) { return file_.data() + HEADER_BYTES + slot * record_size_; }
+    const uint8_t* record(size_t slot) const { return file_.data() + HEADER_BYTES + slot * record_size_; }
+
+    void store(size_t slot, const float* features, const float* targets, size_t num_targets, float weight) {
+        uint8_t* rec = record(slot);
+        num_targets = std::min(num_targets, target_size_);
+
+        // Records start on RECORD_ALIGNMENT boundaries, so the fp16 row is suitably aligned
+        uint16_t* feature_row = reinterpret_cast<uint16_t*>(rec);
+        for (size_t i = 0; i < feature_size_; i++) {
+            feature_row[i] = floatToHalf(features[i]);
+        }
+
+        float max_abs = 0.0f;
+        for (size_t i = 0; i < num_targets; i++) {
+            max_abs = std::max(max_abs, std::fabs(targets[i]));
+        }
+        float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+        int8_t* target_row = reinterpret_cast<int8_t*>(rec + targets_offset_);
+        for (size_t i = 0; i < target_size_; i++) {
+            float q = i < num_targets ? std::round(targets[i] / scale) : 0.0f;
+            target_row[i] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
+        }
+        std::memcpy(rec + scale_offset_, &scale, sizeof(float));
+        std::memcpy(rec + weight_offset_, &weight, sizeof(float));
+    }
+
+    // Coalesce the pages touched by the (sorted) slots into MADV_WILLNEED ranges
+    void prefetch(const std::vector<size_t>& sorted_slots) const {
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t range_begin = 0;
+        size_t range_end = 0;
+        for (size_t slot : sorted_slots) {
+            size_t begin = (HEADER_BYTES + slot * record_size_) & ~(page - 1);
+            size_t end = HEADER_BYTES + (slot + 1) * record_size_;
+            if (range_end > 0 && begin <= range_end) {
+                range_end = std::max(range_end, end);
+                continue;
+            }
+            if (range_end > 0) {
+                file_.advise(range_begin, range_end - range_begin, MADV_WILLNEED);
+            }
+            range_begin = begin;
+            range_end = end;
+        }
+        if (range_end > 0) {
+            file_.advise(range_begin, range_end - range_begin, MADV_WILLNEED);
+        }
+    }
+
+public:
+    MmapReservoirBuffer(const std::string& path, size_t capacity, size_t feature_size, size_t target_size)
+        : capacity_(capacity),
+          feature_size_(feature_size),
+          target_size_(target_size),
+          rng_(std::random_device{}()) {
+        targets_offset_ = feature_size_ * sizeof(uint16_t);
+        scale_offset_ = (targets_offset_ + target_size_ + alignof(float) - 1) & ~(alignof(float) - 1);
+        weight_offset_ = scale_offset_ + sizeof(float);
+        record_size_ = (weight_offset_ + sizeof(float) + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+
+        file_ = MappedFile(path, MappedFile::Mode::READ_WRITE, HEADER_BYTES + capacity_ * record_size_);
+        header_ = reinterpret_cast<Header*>(file_.data());
+
+        if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) == 0) {
+            if (header_->version != VERSION || header_->record_size != record_size_ ||
+                header_->capacity != capacity_ || header_->feature_size != feature_size_ ||
+                header_->target_size != target_size_) {
+                throw std::runtime_error("Reservoir file '" + path + "' has a different layout");
+            }
+        } else {
+            std::memcpy(header_->magic, MAGIC, sizeof(MAGIC));
+            header_->version = VERSION;
+            header_->record_size = static_cast<uint32_t>(record_size_);
+            header_->capacity = capacity_;
+            header_->feature_size = feature_size_;
+            header_->target_size = target_size_;
+            header_->size = 0;
+            header_->count = 0;
+        }
+
+        // Replacement writes and batch reads are scattered; kernel readahead would only waste I/O
+        file_.advise(HEADER_BYTES, capacity_ * record_size_, MADV_RANDOM);
+    }
+
+    using SampleBuffer::add;
+    using SampleBuffer::sample;
+
+    // Add a sample using reservoir sampling (Algorithm R)
+    void add(const float* features, const float* targets, size_t num_targets, float weight) override {
+        if (header_->size < capacity_) {
+            store(header_->size, features, targets, num_targets, weight);
+            header_->size++;
+        } else {
+            size_t j = std::uniform_int_distribution<size_t>(0, header_->count)(rng_);
+            if (j < capacity_) {
+                store(j, features, targets, num_targets, weight);
+            }
+        }
+        header_->count++;
+    }
+
+    size_t sample(size_t batch_size, float* features_out, float* targets_out, float* weights_out) override {
+        std::vector<size_t> slots;
+        sampleDistinctIndices(header_->size, batch_size, rng_, slots);
+
+        // Visit records in file order so neighbouring slots share page faults
+        std::sort(slots.begin(), slots.end());
+        prefetch(slots);
+
+        for (size_t r = 0; r < slots.size(); r++) {
+            const uint8_t* rec = record(slots[r]);
+
+            const uint16_t* feature_src = reinterpret_cast<const uint16_t*>(rec);
+            float* feature_row = features_out + r * feature_size_;
+            for (size_t i = 0; i < feature_size_; i++) {
+                feature_row[i] = halfToFloat(feature_src[i]);
+            }
+
+            float scale;
+            std::memcpy(&scale, rec + scale_offset_, sizeof(float));
+            const int8_t* target_src = reinterpret_cast<const int8_t*>(rec + targets_offset_);
+            float* target_row = targets_out + r * target_size_;
+            for (size_t i = 0; i < target_size_; i++) {
+                target_row[i] = target_src[i] * scale;
+            }
+
+            if (weights_out) {
+                std::memcpy(&weights_out[r], rec + weight_offset_, sizeof(float));
+            }
+        }
+        return slots.size();
+    }
+
+    // Write dirty pages back to disk
+    void flush() const { file_.sync(); }
+
+    // The mapped file already is the durable copy; a snapshot only has to flush it
+    void snapshot(const std::string&) override { flush(); }
+    void restore(const std::string&) override {}
+    bool isPersistent() const override { return true; }
+    void seed(uint64_t seed) override { rng_.seed(static_cast<std::mt19937::result_type>(seed ^ (seed >> 32))); }
+
+    size_t size() const override { return header_->size; }
+    size_t capacity() const override { return capacity_; }
+    size_t count() const override { return header_->count; }
+    size_t featureSize() const override { return feature_size_; }
+    size_t targetSize() const override { return target_size_; }
+    size_t recordSize() const { return record_size_; }
+
+    void clear() override {
+        header_->size = 0;
+        header_->count = 0;
+    }
+};
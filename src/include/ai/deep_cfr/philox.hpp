@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// What a random stream is used for; part of the stream key so that, say, drawing one more
+// chance outcome in a traversal never shifts the cards that traversal is dealt
+enum class RngPurpose : uint32_t {
+    TRAVERSER = 0,  // Which player a strategy traversal runs for
+    DEAL = 1,       // Deck shuffle
+    ACTION = 2,     // Sampling opponent and chance actions
+    RESERVOIR = 3,  // Reservoir buffer replacement and minibatch draws
+    SAMPLING = 4,   // Anything else a traversal samples
+};
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy
+// as 1, 2, 3"). Output block n of a stream is a pure function of (key, counter, n), so a
+// stream keyed by (run seed, iteration, player, traversal index, purpose) yields the same
+// numbers whichever thread runs the traversal and in whatever order. Satisfies
+// UniformRandomBitGenerator; uniform() and below() are portable replacements for the
+// <random> distributions, whose output differs between standard libraries.
+class Philox4x32 {
+public:
+    using result_type = uint32_t;
+
+    Philox4x32(uint64_t seed, uint32_t iteration, uint32_t player, uint32_t index, RngPurpose purpose)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+          counter_{0, index, iteration, (player << 8) | static_cast<uint32_t>(purpose)},
+          output_{},
+          next_(4) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (next_ == 4) {
+            output_ = block(counter_, key_);
+            counter_[0]++;  // 2^32 blocks per stream, far beyond any traversal
+            next_ = 0;
+        }
+        return output_[next_++];
+    }
+
+    uint64_t next64() {
+        uint64_t hi = (*this)();
+        return (hi << 32) | (*this)();
+    }
+
+    // Uniform float in [0, 1) with 24 random bits
+    float uniform() {
+        return static_cast<float>((*this)() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Uniform integer in [0, bound), bound > 0, without modulo bias (Lemire's method)
+    uint32_t below(uint32_t bound) {
+        uint64_t m = static_cast<uint64_t>((*this)()) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>((*this)()) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    using Block = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    // The raw bijection: ten rounds of Philox4x32 over counter under key
+    static Block block(Block counter, Key key) {
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = static_cast<uint64_t>(MULTIPLIER_0) * counter[0];
+            uint64_t p1 = static_cast<uint64_t>(MULTIPLIER_1) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(p0)};
+            key[0] += WEYL_0;
+            key[1] += WEYL_1;
+        }
+        return counter;
+    }
+
+private:
+    static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53;
+    static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+    static constexpr uint32_t WEYL_0 = 0x9E3779B9;
+    static constexpr uint32_t WEYL_1 = 0xBB67AE85;
+
+    Key key_;
+    Block counter_;
+    Block output_;
+    int next_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "fast_mlp.hpp"
+
+// Accuracy and footprint of a quantized network against its fp32 original
+struct QuantizationReport {
+    size_t samples;
+    double mean_abs_error;
+    double max_abs_error;
+    double mean_abs_output;   // Mean |fp32 output|, to read the errors against
+    double argmax_agreement;  // Fraction of rows where both networks rank the same output first
+    size_t fp32_bytes;
+    size_t quantized_bytes;
+};
+
+// Post-training quantized copy of the Deep CFR MLP for CPU play.
+//
+// INT8: every layer's inputs are scaled per feature by the largest magnitude seen on the
+// calibration rows and those scales are folded into the weights, so one-hot features and
+// raw chip counts each keep the full int8 range. Weights are then quantized symmetrically
+// per output channel and dot products accumulate in int32.
+// FP16: weights are stored as halves and widened on the fly; activations stay fp32.
+//
+// save() writes a versioned file in the style of weight_file.hpp: a 4 KB header with the
+// precision and a layer table, then each layer's quantized weights, scales and bias on
+// 64-byte boundaries. load() rebuilds the network from it without the fp32 layers or
+// calibration rows.
+constexpr uint32_t QUANTIZED_WEIGHT_FILE_VERSION = 1;
+
+class QuantizedMLP {
+public:
+    enum class Precision { INT8, FP16 };
+
+    // calibration_rows holds num_rows x input size activations; only INT8 needs them
+    QuantizedMLP(const std::vector<DenseLayer>& layers,
+                 const float* calibration_rows,
+                 size_t num_rows,
+                 Precision precision = Precision::INT8);
+
+    // Forward pass over rows contiguous input rows; writes rows x outputSize() floats
+    void forward(const float* inputs, size_t rows, float* outputs) const;
+    std::vector<float> predict(const std::vector<float>& features) const;
+
+    // Compare against the fp32 layers this network was built from on num_rows held-out rows
+    QuantizationReport evaluate(const std::vector<DenseLayer>& reference, const float* rows, size_t num_rows) const;
+
+    Precision precision() const { return precision_; }
+    size_t inputSize() const { return layers_.empty() ? 0 : layers_.front().input_size; }
+    size_t outputSize() const { return layers_.empty() ? 0 : layers_.back().output_size; }
+    size_t weightBytes() const;
+
+    // Write the quantized network to path, replacing any previous file atomically
+    void save(const std::string& path) const;
+    static QuantizedMLP load(const std::string& path);
+
+private:
+    struct Layer {
+        size_t input_size;
+        size_t output_size;
+        size_t stride;                    // Input length padded for the SIMD kernels
+        std::vector<int8_t> weights_q;    // INT8: output_size x stride
+        std::vector<uint16_t> weights_h;  // FP16: output_size x stride
+        std::vector<float> input_scale;   // INT8: per input, maps x to the int8 grid
+        std::vector<float> output_scale;  // INT8: per output channel, maps the int32 sum back to float
+        std::vector<float> bias;
+    };
+
+    std::vector<Layer> layers_;
+    Precision precision_;
+    bool use_simd_;
+
+    explicit QuantizedMLP(Precision precision) : precision_(precision), use_simd_(false) {}
+    void forwardRow(const float* input, float* output) const;
+};
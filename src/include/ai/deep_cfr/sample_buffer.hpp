@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+// Common interface of the reservoir buffers that hold encoded training samples.
+// A sample is a feature row, a target row (zero-padded to targetSize()) and a weight.
+class SampleBuffer {
+public:
+    virtual ~SampleBuffer() = default;
+
+    // Offer a sample to the reservoir
+    virtual void add(const float* features, const float* targets, size_t num_targets, float weight) = 0;
+
+    // Sample up to batch_size rows into row-major outputs; returns the number of rows written
+    virtual size_t sample(size_t batch_size, float* features_out, float* targets_out, float* weights_out) = 0;
+
+    virtual size_t size() const = 0;
+    virtual size_t capacity() const = 0;
+    virtual size_t count() const = 0;
+    virtual size_t featureSize() const = 0;
+    virtual size_t targetSize() const = 0;
+    virtual void clear() = 0;
+
+    // Persist the contents to path so that restore() can bring them back after a restart
+    virtual void snapshot(const std::string& path) {
+        throw std::logic_error("Snapshots are not supported by this buffer: " + path);
+    }
+    virtual void restore(const std::string& path) {
+        throw std::logic_error("Snapshots are not supported by this buffer: " + path);
+    }
+
+    // Start path as a copy of previous, the file this buffer was last snapshotted to or
+    // restored from (even if since renamed), so that the next snapshot(path) only writes
+    // what changed. False, leaving path alone, when previous is not that file.
+    virtual bool cloneSnapshot(const std::string&, const std::string&) { return false; }
+
+    // Buffers living in their own file survive restarts without snapshots
+    virtual bool isPersistent() const { return false; }
+
+    // Reseed replacement and sampling so a run with a fixed seed is reproducible
+    virtual void seed(uint64_t) {}
+
+    void add(const std::vector<float>& features, const std::vector<float>& targets, float weight = 1.0f) {
+        if (features.size() != featureSize()) {
+            throw std::invalid_argument("Feature vector size does not match buffer feature size");
+        }
+        add(features.data(), targets.data(), targets.size(), weight);
+    }
+
+    size_t sample(size_t batch_size, float* features_out, float* targets_out) {
+        return sample(batch_size, features_out, targets_out, nullptr);
+    }
+};
+
+// Draw k distinct indices from [0, n) in O(k) using Floyd's algorithm
+template <typename RNG>
+void sampleDistinctIndices(size_t n, size_t k, RNG& rng, std::vector<size_t>& indices) {
+    indices.clear();
+    k = std::min(k, n);
+    if (k == 0) return;
+
+    indices.reserve(k);
+    std::unordered_set<size_t> chosen;
+    chosen.reserve(k * 2);
+    for (size_t j = n - k; j < n; j++) {
+        size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+        size_t pick = chosen.insert(t).second ? t : j;
+        if (pick == j) {
+            chosen.insert(j);
+        }
+        indices.push_back(pick);
+    }
+}
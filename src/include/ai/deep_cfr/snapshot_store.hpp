@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "fast_mlp.hpp"
+
+// On-disk history of per-iteration advantage networks for Single Deep CFR.
+//
+// Every snapshot is a flat weight file (iter_<t>_player_<p>.bin) mapped read-only, so the
+// store costs page cache rather than heap and is shared by every process playing from it.
+// index.txt lists "<iteration> <player> <weight>" per snapshot and is appended only after
+// the weight file is in place, so a crash can leave an unlisted file but never a listed
+// missing one. Reads are safe from many threads; add() must not run concurrently with them.
+class SnapshotStore {
+public:
+    // Open directory, creating it if needed and mapping every snapshot already indexed
+    explicit SnapshotStore(const std::string& directory);
+
+    // Persist layers as player's advantage network after iteration, with its average-strategy weight
+    void add(int iteration, int player, float weight, const std::vector<DenseLayer>& layers);
+
+    // Forget every snapshot taken after iteration, as when resuming an earlier checkpoint.
+    // The index is rewritten and renamed into place; the orphaned files are overwritten as
+    // those iterations are trained again.
+    void truncate(int iteration);
+
+    size_t size(int player) const;
+    const std::string& directory() const { return directory_; }
+
+    // Snapshot index drawn with probability proportional to its weight, given u in [0, 1)
+    size_t sample(int player, float u) const;
+
+    const FastMLP& net(int player, size_t index) const;
+    float weight(int player, size_t index) const;
+    int iteration(int player, size_t index) const;
+
+private:
+    struct Entry {
+        int iteration;
+        float weight;
+        std::shared_ptr<const FastMLP> net;
+    };
+
+    struct PlayerSnapshots {
+        std::vector<Entry> entries;
+        std::vector<double> cumulative_weights;
+    };
+
+    std::string directory_;
+    std::vector<PlayerSnapshots> players_;
+
+    std::string path(int iteration, int player) const;
+    void append(int iteration, int player, float weight);
+    const PlayerSnapshots& snapshots(int player) const;
+};
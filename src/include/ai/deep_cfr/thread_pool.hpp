@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with per-worker task deques and work stealing.
+//
+// parallelFor splits an index range into chunks dealt round-robin onto the workers'
+// deques. A worker pops from the back of its own deque and, once that runs dry, steals
+// from the front of the others, so uneven traversal costs (deep all-in trees next to
+// instant folds) even out without a central queue becoming the bottleneck.
+class ThreadPool {
+public:
+    // fn(index, worker) runs on a pool thread; worker identifies it in [0, size())
+    using IndexFunction = std::function<void(size_t index, size_t worker)>;
+
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run fn for every index in [begin, end) in chunks of grain indices and wait for all of
+    // them. The first exception thrown by fn is rethrown here once the range has drained.
+    void parallelFor(size_t begin, size_t end, size_t grain, const IndexFunction& fn);
+
+    size_t size() const { return workers_.size(); }
+
+    // Chunks a worker took from another worker's deque, summed over the pool's lifetime
+    size_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_;
+    bool stopping_;
+
+    std::mutex submit_mutex_;  // One parallelFor at a time
+    const IndexFunction* job_;
+    std::atomic<size_t> remaining_;
+    std::exception_ptr error_;
+    std::atomic<size_t> steals_;
+
+    bool takeChunk(size_t worker, Chunk& chunk);
+    void workerLoop(size_t worker);
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "fast_mlp.hpp"
+#include "win_rate.hpp"
+
+// Heads-up round robin between saved models (directories written by DeepCFR::saveModels).
+//
+// Every model's strategy_net.bin is mapped once and shared read-only by all the matches it
+// plays. Each pair plays config.tables tables in lockstep: every step gathers the pending
+// decisions of all tables by model and runs them through that model's FastMLP as one batch,
+// so inference cost is per batch rather than per decision. Hands are dealt in seat-swapped
+// duplicate pairs from Philox streams keyed by (seed, pair, deal).
+struct TournamentConfig {
+    int deals = 10000;       // Per pair of models, each dealt twice
+    size_t tables = 256;     // Concurrent tables per pair
+    int starting_chips = 1000;
+    int small_blind = 10;
+    int big_blind = 20;
+    uint64_t seed = 0;
+    size_t threads = 0;      // 0 = one per core; pairs are spread across them
+};
+
+struct TournamentResult {
+    std::vector<std::string> names;
+    std::vector<std::vector<WinRate>> matrix;  // [row][column]: row's win rate against column
+
+    // Mean mbb/g of a model against the rest of the field
+    double score(size_t model) const;
+
+    // Models from best to worst score
+    std::vector<size_t> ranking() const;
+
+    std::string toString() const;
+    std::string toCsv() const;
+};
+
+class Tournament {
+public:
+    explicit Tournament(const std::vector<std::string>& model_directories, const TournamentConfig& config = {});
+
+    TournamentResult run();
+
+    // Duplicate pair averages of a's winnings against b in chips, one per deal
+    std::vector<double> playPair(size_t a, size_t b);
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::shared_ptr<const FastMLP>> nets_;
+    TournamentConfig config_;
+};
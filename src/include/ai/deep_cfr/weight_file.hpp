@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "fast_mlp.hpp"
+
+// Flat, versioned weight file that FastMLP maps and runs in place:
+//
+//   [4 KB header: magic, version, byte order, panel width, layer table]
+//   [layer 0 packed weights][layer 0 bias][layer 1 packed weights]...
+//
+// Sections hold FastMLP's packed panel layout and start on 64-byte boundaries, so loading
+// is an mmap plus header validation with no parsing or copying, and every process that
+// maps the same file shares one page-cache copy. Files are written under a temporary name
+// and renamed into place: readers never observe a partial file, and processes still
+// mapping the previous version keep using it until they reload.
+constexpr uint32_t WEIGHT_FILE_VERSION = 1;
+
+// Write layers (as exported by NeuralNet::exportLayers) to path
+void writeWeightFile(const std::string& path, const std::vector<DenseLayer>& layers);
+
+// Map path read-only and wrap it in a FastMLP that uses the mapping directly
+FastMLP mapWeightFile(const std::string& path);
+
+// Write image under a temporary name, fsync it and rename it over path
+void writeFileAtomically(const std::string& path, const std::vector<uint8_t>& image);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Win rate of a player over independent hands, in milli-big-blinds per game with a normal
+// 95% confidence interval on the mean
+struct WinRate {
+    size_t hands = 0;
+    double mbb_per_game = 0.0;
+    double std_error = 0.0;  // Of the mean, in mbb/g
+    double ci95_low = 0.0;
+    double ci95_high = 0.0;
+
+    // From per-hand winnings in chips
+    static WinRate fromWinnings(const std::vector<double>& chips, int big_blind);
+
+    // "12.3 +/- 4.5 mbb/g over 1000 hands"
+    std::string toString() const;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include "game.hpp"
+
+// Bet abstraction for the tabular solver: fold, check or call, a few pot-fraction raises
+// and all-in. Actions come out in a fixed order, so an action's index is stable within an
+// info set and can address its regret slot.
+class BetAbstraction {
+public:
+    static constexpr int MAX_ACTIONS = 8;
+
+    // Raise sizes as fractions of the pot after calling; at most max_raises raises per street
+    // before only fold, call and all-in remain
+    explicit BetAbstraction(std::vector<float> pot_fractions = {0.5f, 1.0f, 2.0f}, int max_raises = 3);
+
+    std::vector<Action> actions(const Game& game, int raises_this_street) const;
+
+    static bool isRaise(const Action& action) {
+        return action.getActionType() == ActionType::RAISE || action.getActionType() == ActionType::ALL_IN;
+    }
+
+private:
+    std::vector<float> pot_fractions_;
+    int max_raises_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "card.hpp"
+#include "hand_phase.hpp"
+#include "philox.hpp"
+
+// Card abstraction for the tabular solver: the 169 strategically distinct starting hands
+// preflop (lossless up to suit isomorphism) and equal-width hand strength buckets after the
+// flop. Hand strength is the probability of beating a uniformly random opponent hand at
+// showdown, estimated from sampled opponent hands and runouts.
+class CardAbstraction {
+public:
+    static constexpr int PREFLOP_CLASSES = 169;
+
+    explicit CardAbstraction(int postflop_buckets = 50, int samples = 64);
+
+    // Pairs are 0..12, then suited and offsuit pairs of distinct ranks
+    static int preflopClass(const Card& a, const Card& b);
+
+    // Bucket of hole on board; preflop this is preflopClass
+    int bucket(const std::vector<Card>& hole, const std::vector<Card>& board, Philox4x32& rng) const;
+
+    int numBuckets(HandPhase::Phase phase) const;
+
+    // Hand strength against a uniformly random opponent hand, over samples deals of the
+    // opponent's cards and the rest of the board (exact enumeration is left to callers
+    // that can afford it)
+    double handStrength(const std::vector<Card>& hole, const std::vector<Card>& board, Philox4x32& rng) const;
+
+private:
+    int postflop_buckets_;
+    int samples_;
+};
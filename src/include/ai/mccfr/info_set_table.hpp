@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "regret_table.hpp"
+
+// In-memory RegretTable with int32 regrets and float strategy sums in flat arrays indexed by
+// slot. The arrays are lazily zeroed anonymous memory, so capacity that is never touched
+// costs no RAM and a big-memory machine can be sized for billions of info sets up front.
+class InfoSetTable : public RegretTable {
+public:
+    // Capacity is rounded up to a power of two
+    explicit InfoSetTable(size_t capacity);
+    ~InfoSetTable() override;
+
+    void regrets(size_t slot, size_t num_actions, float* out) const override;
+    void addRegrets(size_t slot, size_t num_actions, const double* deltas, double floor, Philox4x32& rng) override;
+    void strategySums(size_t slot, size_t num_actions, float* out) const override;
+    void addStrategy(size_t slot, size_t num_actions, const float* probabilities) override;
+    void scale(size_t slot, double factor) override;
+
+private:
+    size_t bytes_;
+    void* memory_;
+    std::atomic<int32_t>* regrets_;
+    std::atomic<float>* strategy_;
+    std::atomic<uint64_t> size_{0};
+};
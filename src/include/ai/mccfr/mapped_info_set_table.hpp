@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "mapped_file.hpp"
+#include "regret_table.hpp"
+
+// RegretTable in a memory-mapped file, so regrets survive restarts and the table can be
+// larger than RAM with the page cache keeping the hot info sets resident:
+//
+//   [4 KB header][keys u64 x capacity][regret codes i16 x capacity x WIDTH][strategy sums f32 x capacity x WIDTH]
+//
+// Regrets are 16-bit log-compressed codes, |regret| = exp(|code| / REGRET_CODE_SCALE) - 1
+// chips: about 0.06% relative precision from fractions of a chip to well past the regret
+// floor, at half the size of int32. Updates round stochastically between the two codes that
+// bracket the exact result, so a stored regret is an unbiased estimate of the exact one.
+//
+// Capacity is fixed while a table is open. rebuild() rehashes it into a new file offline,
+// to grow a table nearing full or to compact one by dropping info sets that never
+// accumulated anything.
+class MappedInfoSetTable : public RegretTable {
+public:
+    static constexpr double REGRET_CODE_SCALE = 1600.0;
+    static constexpr int16_t MAX_CODE = 32767;
+
+    // Open path, creating it with capacity slots (rounded up to a power of two) if it does
+    // not exist yet. An existing table keeps the capacity it was created with.
+    explicit MappedInfoSetTable(const std::string& path, size_t capacity = 0);
+
+    void regrets(size_t slot, size_t num_actions, float* out) const override;
+    void addRegrets(size_t slot, size_t num_actions, const double* deltas, double floor, Philox4x32& rng) override;
+    void strategySums(size_t slot, size_t num_actions, float* out) const override;
+    void addStrategy(size_t slot, size_t num_actions, const float* probabilities) override;
+    void scale(size_t slot, double factor) override;
+
+    uint64_t iterations() const override { return header_->iterations; }
+    void setIterations(uint64_t iterations) override { header_->iterations = iterations; }
+    bool isPersistent() const override { return true; }
+    void sync(bool async = false) override { file_.sync(async); }
+
+    double loadFactor() const { return static_cast<double>(size()) / capacity(); }
+
+    struct RebuildStats {
+        size_t kept = 0;
+        size_t dropped = 0;
+        size_t capacity = 0;
+    };
+
+    // Rehash the table at from into a new table at to (which may be from itself) with
+    // capacity slots, or with the smallest power of two keeping the load at most max_load
+    // when capacity is 0. With drop_empty, info sets whose regrets and strategy sums are
+    // all zero are left out. No solver may have from open.
+    static RebuildStats rebuild(const std::string& from, const std::string& to, size_t capacity = 0,
+                                bool drop_empty = false, double max_load = 0.5);
+
+    static float decodeRegret(int16_t code);
+
+    // One of the two codes bracketing regret, the upper with the probability that makes the
+    // decoded value unbiased given u uniform in [0, 1)
+    static int16_t encodeRegret(double regret, float u);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t width;
+        uint64_t capacity;
+        std::atomic<uint64_t> size;
+        uint64_t iterations;
+    };
+
+    static constexpr char MAGIC[8] = {'P', 'K', 'R', 'I', 'N', 'F', 'O', 'S'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 4096;
+
+    MappedFile file_;
+    Header* header_;
+    std::atomic<int16_t>* regrets_;
+    std::atomic<float>* strategy_;
+
+    static size_t fileSize(size_t capacity);
+};
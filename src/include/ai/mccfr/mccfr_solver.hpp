@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bet_abstraction.hpp"
+#include "card_abstraction.hpp"
+#include "regret_table.hpp"
+#include "thread_pool.hpp"
+
+struct MCCFRConfig {
+    int num_players = 2;
+    int starting_chips = 1000;
+    int small_blind = 10;
+    int big_blind = 20;
+
+    int postflop_buckets = 50;
+    int strength_samples = 64;
+    std::vector<float> raise_fractions = {0.5f, 1.0f, 2.0f};
+    int max_raises = 3;
+
+    size_t table_capacity = size_t(1) << 24;  // Info-set slots of a new table
+    std::string table_path;        // Keep regrets in a MappedInfoSetTable there instead of RAM
+    int discount_interval = 1000;  // Iterations between Linear CFR discounts
+    int linear_until = 400000;     // No discounting after this many iterations
+    uint64_t seed = 0;
+    size_t threads = 0;            // 0 = one per core
+};
+
+// Tabular external-sampling MCCFR over the engine with card and bet abstraction, in the
+// style of Pluribus.
+//
+// Every iteration deals one hand and traverses it once per player: the traverser's actions
+// are all expanded, everyone else's are sampled from their current (regret-matched)
+// strategy, whose probabilities are also added to the average strategy. Iterations run in
+// parallel on the ThreadPool against one shared RegretTable with benign-race updates: an
+// InfoSetTable in RAM, or a MappedInfoSetTable at config.table_path that training resumes
+// from, the iteration count included.
+//
+// Regrets are in chips and floored at REGRET_FLOOR, so an action that keeps losing can
+// recover quickly once it starts to pay. Linear CFR is applied by discount: after every
+// discount_interval iterations (up to linear_until) all regrets and strategy sums are scaled
+// by d / (d + 1), d being the number of intervals so far.
+class MCCFRSolver {
+public:
+    static constexpr int32_t REGRET_FLOOR = -310000000;
+
+    explicit MCCFRSolver(const MCCFRConfig& config);
+
+    // Run iterations more iterations, reporting throughput after each discount interval
+    void train(int iterations);
+
+    int iterations() const { return iteration_; }
+    const RegretTable& table() const { return *table_; }
+    const CardAbstraction& cards() const { return cards_; }
+    const BetAbstraction& bets() const { return bets_; }
+
+    // Regret-matched strategy and normalized average strategy of an info set over its first
+    // num_actions actions (uniform for info sets never visited)
+    std::vector<float> currentStrategy(uint64_t key, size_t num_actions) const;
+    std::vector<float> averageStrategy(uint64_t key, size_t num_actions) const;
+
+    // Info-set keys: the public action history hashed action by action (with a marker per
+    // street), combined with the acting player and that player's card buckets so far
+    static uint64_t combine(uint64_t hash, uint64_t value);
+    static uint64_t infoSetKey(uint64_t history, int player, const std::vector<int>& buckets);
+
+private:
+    // The dealt hand's card buckets, filled in the first time a street is reached
+    struct Hand {
+        std::vector<std::array<int, 4>> buckets;  // [player][street], -1 until computed
+        uint32_t iteration = 0;
+    };
+
+    MCCFRConfig config_;
+    CardAbstraction cards_;
+    BetAbstraction bets_;
+    std::unique_ptr<RegretTable> table_;
+    ThreadPool pool_;
+    int iteration_ = 0;
+
+    void runIteration(uint32_t iteration);
+    double traverse(Game& game, int traverser, Hand& hand, uint64_t history, int raises, HandPhase::Phase street,
+                    Philox4x32& rng);
+    std::vector<int> bucketPath(const Game& game, int player, Hand& hand) const;
+    void regretMatching(size_t slot, size_t num_actions, float* strategy) const;
+    void discount(double factor);
+};
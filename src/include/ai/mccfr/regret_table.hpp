@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "bet_abstraction.hpp"
+#include "philox.hpp"
+
+// Common interface of the info-set stores MCCFRSolver keeps regrets and average-strategy
+// sums in: a fixed-capacity open-addressing map from 64-bit info-set keys to slots of WIDTH
+// actions, whose storage the implementations provide.
+//
+// Lock-free: inserting claims a key with one compare-and-swap on linear probing. Regret and
+// strategy updates are relaxed load-modify-store sequences on atomic fields, so two threads
+// updating the same info set at once can lose one update (the benign race Pluribus accepts)
+// but never tear a value or corrupt the map.
+class RegretTable {
+public:
+    static constexpr int WIDTH = BetAbstraction::MAX_ACTIONS;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    RegretTable() = default;
+    virtual ~RegretTable() = default;
+
+    RegretTable(const RegretTable&) = delete;
+    RegretTable& operator=(const RegretTable&) = delete;
+
+    // Slot of key, claiming an empty one if key is new; throws once the table is full
+    size_t findOrInsert(uint64_t key);
+    size_t find(uint64_t key) const;
+
+    // Key in slot, 0 if the slot is empty
+    uint64_t key(size_t slot) const { return keys_[slot].load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return static_cast<size_t>(size_->load(std::memory_order_relaxed)); }
+
+    // Regrets in chips of the first num_actions actions
+    virtual void regrets(size_t slot, size_t num_actions, float* out) const = 0;
+
+    // Add deltas to the first num_actions regrets, flooring at floor. Tables that store
+    // regrets at reduced precision round stochastically with rng, so updates stay unbiased.
+    virtual void addRegrets(size_t slot, size_t num_actions, const double* deltas, double floor, Philox4x32& rng) = 0;
+
+    virtual void strategySums(size_t slot, size_t num_actions, float* out) const = 0;
+    virtual void addStrategy(size_t slot, size_t num_actions, const float* probabilities) = 0;
+
+    // Scale every regret and strategy sum of slot (Linear CFR discounting)
+    virtual void scale(size_t slot, double factor) = 0;
+
+    // Iterations the contents are the result of, kept by tables that outlive the solver
+    virtual uint64_t iterations() const { return 0; }
+    virtual void setIterations(uint64_t) {}
+
+    // Tables living in their own file survive restarts; sync writes the contents back,
+    // waiting for the disk unless async
+    virtual bool isPersistent() const { return false; }
+    virtual void sync(bool = false) {}
+
+    // 0 marks empty slots, so key 0 is stored as another value
+    static uint64_t storedKey(uint64_t key) { return key == 0 ? 0x9e3779b97f4a7c15ULL : key; }
+
+    // Capacities are powers of two so probing can mask instead of divide
+    static size_t roundCapacity(size_t capacity);
+
+protected:
+    // Implementations hand over their key array (zeroed means empty) and entry counter
+    void attach(std::atomic<uint64_t>* keys, size_t capacity, std::atomic<uint64_t>* size);
+
+private:
+    std::atomic<uint64_t>* keys_ = nullptr;
+    std::atomic<uint64_t>* size_ = nullptr;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+
+    size_t home(uint64_t key) const;
+};
@@ -32,7 +32,7 @@ public:
     int getAmount() const { return amount_; }   
 };
 
-std::string actionTypeToString(ActionType type) {
+inline std::string actionTypeToString(ActionType type) {
     switch (type) {
         case ActionType::RAISE: return "RAISE";
         case ActionType::ALL_IN: return "ALL_IN";
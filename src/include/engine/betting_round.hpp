@@ -5,6 +5,7 @@
 #include "hand_phase.hpp"
 #include "action.hpp"
 #include "game_state.hpp"
+#include <climits>
 #include <functional>
 #include <deque>
 #include <unordered_map>
@@ -30,10 +31,15 @@ class BettingRound {
         int last_to_act_;
         int all_in_count_ = 0;
         
-        void _move_to_next_player() {
+        // Returns whether the turn reached or skipped past last_to_act_, which closes the
+        // round even when that player has since folded or gone all-in
+        bool _move_to_next_player() {
+            bool closed = false;
             do {
                 current_player_ = (current_player_ + 1) % players_.size();
+                closed = closed || current_player_ == last_to_act_;
             } while (!players_[current_player_]->isActive());
+            return closed;
         }
         
         
@@ -154,12 +160,15 @@ class BettingRound {
                 size_t num_players = players_.size();
                 current_player_ = (last_to_act_ + 1) % num_players;
                 for (size_t i = 0; i < num_players; i++) {
-                    auto player = players_[(i + last_to_act_ + 1) % num_players];
-                    if (player->isActive()) {
-                        active_players_.emplace_back(i);
+                    int seat = (i + last_to_act_ + 1) % num_players;
+                    if (players_[seat]->isActive()) {
+                        active_players_.emplace_back(seat);
                     }
                 }
-                
+                // Folded and all-in seats do not get to act
+                if (!active_players_.empty() && !players_[current_player_]->isActive()) {
+                    _move_to_next_player();
+                }
             }
 
         void post_player_bets(int player_idx, int amount) {
@@ -225,9 +234,18 @@ class BettingRound {
             if (everyoneAllIn()) {
                 return true;
             }
-            _move_to_next_player();
-            
-            return current_player_ == last_to_act_;
+            return _move_to_next_player();
+        }
+
+        // This round acting on players (same seats) and on pot_copy's copy of each of our pots
+        BettingRound rebound(const std::vector<std::shared_ptr<Player>>& players,
+                             const std::function<std::shared_ptr<Pot>(const std::shared_ptr<Pot>&)>& pot_copy) const {
+            BettingRound copy(*this);
+            copy.players_ = players;
+            for (auto& pot : copy.pots_) {
+                pot = pot_copy(pot);
+            }
+            return copy;
         }
 
         int getCurrentPlayer() {
@@ -2,6 +2,8 @@
 #include "card.hpp"
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <utility>
 
 class Deck {
 private:
@@ -11,7 +13,32 @@ private:
 
 public:
     Deck();
+
+    // Deck shuffled by gen, so a seeded generator deals a reproducible hand
+    template <class URBG>
+    explicit Deck(URBG& gen) : cards_(getFullDeck()) {
+        shuffle(gen);
+    }
+
     void shuffle();
+
+    // Fisher-Yates driven by gen's 32-bit output. Unlike std::shuffle the resulting order
+    // is the same on every standard library.
+    template <class URBG>
+    void shuffle(URBG& gen) {
+        static_assert(URBG::max() - URBG::min() == 0xFFFFFFFFu, "Deck::shuffle needs a 32-bit generator");
+        for (size_t i = cards_.size(); i > 1; i--) {
+            uint32_t bound = static_cast<uint32_t>(i);
+            uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>(gen() - URBG::min())) * bound;
+            uint32_t low = static_cast<uint32_t>(m);
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(static_cast<uint32_t>(gen() - URBG::min())) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+            std::swap(cards_[i - 1], cards_[m >> 32]);
+        }
+    }
     std::vector<Card> draw(size_t num = 1);
     std::string toString() const;
     size_t size() const { return cards_.size(); }
@@ -43,10 +43,20 @@ private:
 public:
     
     Game(int num_players, int starting_chips, int small_blind, int big_blind);
+
+    // Deep copy: the copy owns its players, pots and betting round, so acting on it leaves
+    // the original hand untouched (traversals expand each action on a copy)
+    Game(const Game& other);
+    Game& operator=(const Game& other);
+    Game(Game&&) = default;
+    Game& operator=(Game&&) = default;
     
     // Core game flow methods
     GameState startHand(int btn_loc = -1);
 
+    // Start a hand dealt from deck, e.g. one shuffled by a seeded generator
+    GameState startHand(Deck deck, int btn_loc = -1);
+
     GameState takeAction(Action action);
     bool isHandOver() const;
     bool isHandComplete() const;
@@ -57,6 +67,15 @@ public:
     const std::vector<std::shared_ptr<Pot>>& getPots() const { return pots_; }
     int getCurrentPlayer() const { return current_player_; }
     HandPhase::Phase getPhase() const { return phase_; }
+
+    // Chips all players held when the hand started
+    int getInitialStackTotal() const {
+        int total = 0;
+        for (const auto& player : players_) {
+            total += player->getInitialStack();
+        }
+        return total;
+    }
     
     void printState() const;
 
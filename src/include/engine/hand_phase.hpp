@@ -29,7 +29,7 @@ inline const bool HandPhase::IS_BETTING_ROUND[] = {
     false, true, true, true, true, false
 };
 
-std::string phaseToString(HandPhase::Phase phase) {
+inline std::string phaseToString(HandPhase::Phase phase) {
     switch (phase) {
         case HandPhase::Phase::PREHAND: return "PREHAND";
         case HandPhase::Phase::PREFLOP: return "PREFLOP";
@@ -9,7 +9,7 @@ enum class PlayerState {
     ALL_IN   // Player is all-in, no more actions possible
 };
 
-std::string playerStateToString(PlayerState state) {
+inline std::string playerStateToString(PlayerState state) {
     switch (state) {
         case PlayerState::SKIP: return "SKIP";
         case PlayerState::OUT: return "OUT";
@@ -45,9 +45,13 @@ namespace poker {
         // Start the server
         bool start();
 
-        // Stop the server
+        // Stop the server, writing the trace if enableTracing() was called
         void stop();
 
+        // Record TRACE_SCOPE spans from now on and dump them as Chrome trace JSON to path
+        // when the server stops; spans only exist in builds with POKERAI_ENABLE_TRACING
+        void enableTracing(const std::string& path);
+
         // Run the game loop
         void run();
 
@@ -91,6 +95,9 @@ namespace poker {
 
         // Poker game engine instance
         std::unique_ptr<Game> game_;
+
+        // Chrome trace output, empty when tracing is off
+        std::string tracePath_;
     };
 
 } // namespace poker 
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Span tracing for the training and server hot paths, exported as Chrome trace JSON (open
+// it in chrome://tracing or ui.perfetto.dev).
+//
+//   TRACE_SCOPE("DeepCFR::traverseCFR");
+//
+// records a span from that point to the end of the enclosing scope. Spans go to a ring
+// buffer owned by the recording thread, so recording takes no shared lock; when a ring is
+// full its oldest spans are overwritten. Buffers outlive their threads, so spans from
+// finished threads still make it into the dump; a thread only allocates its ring once it
+// records a span, but short-lived threads that record each keep one.
+//
+// TRACE_SCOPE compiles to nothing unless POKERAI_ENABLE_TRACING is defined (the CMake
+// option of the same name); when compiled in, spans are only recorded between
+// Tracer::start() and Tracer::stop(). Span names must be string literals.
+class Tracer {
+public:
+#ifdef POKERAI_ENABLE_TRACING
+    static constexpr bool compiledIn() { return true; }
+#else
+    static constexpr bool compiledIn() { return false; }
+#endif
+
+    // Begin recording, keeping the newest events_per_thread spans of every thread
+    static void start(size_t events_per_thread = 1 << 16) {
+        Tracer& tracer = instance();
+        std::lock_guard<std::mutex> lock(tracer.mutex_);
+        tracer.capacity_ = std::max<size_t>(1, events_per_thread);
+        for (const auto& buffer : tracer.buffers_) {
+            buffer->reset(tracer.capacity_);
+        }
+        tracer.epoch_ns_.store(steadyNanos(), std::memory_order_relaxed);
+        tracer.enabled_.store(true, std::memory_order_release);
+    }
+
+    static void stop() { instance().enabled_.store(false, std::memory_order_release); }
+
+    static bool enabled() { return instance().enabled_.load(std::memory_order_relaxed); }
+
+    // Label the calling thread in the trace viewer
+    static void setThreadName(const std::string& name) {
+        if (!compiledIn()) return;
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    // Nanoseconds since start()
+    static uint64_t now() {
+        return static_cast<uint64_t>(steadyNanos() - instance().epoch_ns_.load(std::memory_order_relaxed));
+    }
+
+    static void record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);  // Only contended while dumping
+        if (buffer.events.empty()) {
+            buffer.events.assign(buffer.capacity, Event{"", 0, 0});  // Threads pay for a ring once they record
+        }
+        buffer.events[buffer.next % buffer.events.size()] = {name, start_ns, end_ns - start_ns};
+        buffer.next++;
+    }
+
+    // Write every thread's recorded spans as a Chrome trace; safe while spans are recorded
+    static void writeChromeTrace(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to open trace file '" + path + "'");
+        }
+
+        Tracer& tracer = instance();
+        std::lock_guard<std::mutex> lock(tracer.mutex_);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : tracer.buffers_) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"" << escape(buffer->name) << "\"}}";
+            first = false;
+
+            size_t size = std::min(buffer->next, buffer->events.size());
+            for (size_t i = buffer->next - size; i < buffer->next; i++) {
+                const Event& event = buffer->events[i % buffer->events.size()];
+                // Microseconds with nanosecond decimals, as the format expects
+                out << ",\n{\"name\":\"" << escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"ts\":" << event.start_ns / 1000 << '.' << pad3(event.start_ns % 1000)
+                    << ",\"dur\":" << event.duration_ns / 1000 << '.' << pad3(event.duration_ns % 1000) << '}';
+            }
+        }
+        out << "\n]}\n";
+        if (!out.flush()) {
+            throw std::runtime_error("Failed to write trace file '" + path + "'");
+        }
+    }
+
+private:
+    struct Event {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t duration_ns;
+    };
+
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<Event> events;
+        size_t capacity = 0;
+        size_t next = 0;  // Total spans recorded; the ring slot is next % capacity
+        uint32_t tid = 0;
+        std::string name;
+
+        void reset(size_t capacity) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.clear();
+            this->capacity = capacity;
+            next = 0;
+        }
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<int64_t> epoch_ns_{steadyNanos()};
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    size_t capacity_ = 1 << 16;
+
+    static int64_t steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static ThreadBuffer& threadBuffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = registerThread();
+        return *buffer;
+    }
+
+    static std::shared_ptr<ThreadBuffer> registerThread() {
+        Tracer& tracer = instance();
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(tracer.mutex_);
+        buffer->tid = static_cast<uint32_t>(tracer.buffers_.size() + 1);
+        buffer->name = "thread " + std::to_string(buffer->tid);
+        buffer->capacity = tracer.capacity_;
+        tracer.buffers_.push_back(buffer);
+        return buffer;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+        }
+        return escaped;
+    }
+
+    static std::string pad3(uint64_t value) {
+        std::string digits = std::to_string(value);
+        return std::string(3 - digits.size(), '0') + digits;
+    }
+};
+
+// Records its lifetime as a span while tracing is running
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name_(Tracer::enabled() ? name : nullptr) {
+        if (name_) start_ = Tracer::now();
+    }
+
+    ~TraceSpan() {
+        if (name_) Tracer::record(name_, start_, Tracer::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_ = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef POKERAI_ENABLE_TRACING
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <algorithm>
 #include "server/poker_server.h"
+#include "util/trace.hpp"
 
 
 
@@ -38,6 +39,22 @@ namespace poker {
 
         // Clean up game resources
         game_.reset();
+
+        if (!tracePath_.empty()) {
+            Tracer::stop();
+            try {
+                Tracer::writeChromeTrace(tracePath_);
+                std::cout << "Wrote trace to " << tracePath_ << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Error writing trace: " << e.what() << std::endl;
+            }
+            tracePath_.clear();
+        }
+    }
+
+    void PokerServer::enableTracing(const std::string& path) {
+        tracePath_ = path;
+        Tracer::start();
     }
 
     void PokerServer::run() {
@@ -64,6 +81,7 @@ namespace poker {
     }
 
     void PokerServer::handleMessage(int clientId, const std::string& message) {
+        TRACE_SCOPE("PokerServer::handleMessage");
         try {
             json jsonMsg = parseMessage(message);
 
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include "fast_mlp.hpp"
+
+// Layer with small normally distributed weights and biases, like a freshly initialized network
+inline DenseLayer randomLayer(size_t input_size, size_t output_size, std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    DenseLayer layer{input_size, output_size, std::vector<float>(input_size * output_size), std::vector<float>(output_size)};
+    for (float& w : layer.weight) w = dist(rng);
+    for (float& b : layer.bias) b = dist(rng);
+    return layer;
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "distributed.hpp"
+
+TEST(DistributedTest, SampleBatchesRoundTripSparseAndHalfPrecision) {
+    SampleBatch batch;
+    batch.feature_size = 500;
+    batch.target_size = 10;
+    for (int row = 0; row < 3; row++) {
+        std::vector<float> features(500, 0.0f);
+        features[row] = 1.0f;
+        features[100 + row] = 0.25f * (row + 1);
+        features[499] = -3.5f;
+        batch.features.insert(batch.features.end(), features.begin(), features.end());
+        for (int a = 0; a < 10; a++) batch.targets.push_back(0.125f * (a - row));
+        batch.weights.push_back(2.0f + row);
+        batch.buffers.push_back(row);
+    }
+
+    std::vector<uint8_t> payload = encodeSamples(batch);
+    EXPECT_LT(payload.size(), batch.features.size() * sizeof(float) / 10);
+
+    // Every value here is exact in fp16
+    SampleBatch decoded = decodeSamples(payload, 500, 10);
+    EXPECT_EQ(decoded.feature_size, 500u);
+    EXPECT_EQ(decoded.target_size, 10u);
+    EXPECT_EQ(decoded.features, batch.features);
+    EXPECT_EQ(decoded.targets, batch.targets);
+    EXPECT_EQ(decoded.weights, batch.weights);
+    EXPECT_EQ(decoded.buffers, batch.buffers);
+
+    EXPECT_THROW(decodeSamples(payload, 499, 10), std::runtime_error);
+    EXPECT_THROW(decodeSamples(payload, 500, 11), std::runtime_error);
+    payload.pop_back();
+    EXPECT_THROW(decodeSamples(payload, 500, 10), std::runtime_error);
+}
+
+TEST(DistributedTest, WeightsRoundTripExactly) {
+    WeightsMessage message;
+    message.iteration = 7;
+    message.net = 2;
+    message.layers.push_back({3, 2, {0.1f, -0.2f, 0.3f, 1e-7f, 5.0f, -6.0f}, {0.5f, -0.5f}});
+    message.layers.push_back({2, 1, {1.0f, 2.0f}, {3.0f}});
+
+    WeightsMessage decoded = decodeWeights(encodeWeights(message));
+    EXPECT_EQ(decoded.iteration, 7u);
+    EXPECT_EQ(decoded.net, 2);
+    ASSERT_EQ(decoded.layers.size(), 2u);
+    EXPECT_EQ(decoded.layers[0].weight, message.layers[0].weight);
+    EXPECT_EQ(decoded.layers[0].bias, message.layers[0].bias);
+    EXPECT_EQ(decoded.layers[1].input_size, 2u);
+    EXPECT_EQ(decoded.layers[1].weight, message.layers[1].weight);
+
+    // Dimensions whose product wraps around 2^64 are rejected, not allocated
+    std::vector<uint8_t> payload = encodeWeights(message);
+    uint64_t huge = uint64_t(1) << 32;
+    std::memcpy(payload.data() + 3 * sizeof(uint32_t), &huge, sizeof(huge));
+    std::memcpy(payload.data() + 3 * sizeof(uint32_t) + sizeof(uint64_t), &huge, sizeof(huge));
+    EXPECT_THROW(decodeWeights(payload), std::runtime_error);
+}
+
+TEST(DistributedTest, FramesCrossTcpAndUnixSockets) {
+    for (std::string endpoint : {"tcp://127.0.0.1:0", "unix:/tmp/distributed_test.sock"}) {
+        Listener listener(endpoint);
+        std::vector<uint8_t> large(3 << 20);
+        for (size_t i = 0; i < large.size(); i++) large[i] = static_cast<uint8_t>(i * 31);
+
+        std::thread worker([&]() {
+            Connection connection = Connection::connect(listener.endpoint());
+            connection.send(MessageType::HELLO, {});
+            connection.send(MessageType::SAMPLES, large);
+        });
+
+        Connection connection = listener.accept();
+        MessageType type;
+        std::vector<uint8_t> payload;
+        ASSERT_TRUE(connection.receive(type, payload));
+        EXPECT_EQ(type, MessageType::HELLO);
+        EXPECT_TRUE(payload.empty());
+        ASSERT_TRUE(connection.receive(type, payload));
+        EXPECT_EQ(type, MessageType::SAMPLES);
+        EXPECT_EQ(payload, large);
+
+        // Orderly close once the worker is gone
+        worker.join();
+        EXPECT_FALSE(connection.receive(type, payload));
+    }
+}
+
+TEST(DistributedTest, CloseWakesBlockedAccept) {
+    Listener listener("tcp://127.0.0.1:0");
+    std::thread closer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        listener.close();
+    });
+    EXPECT_THROW(listener.accept(), std::runtime_error);
+    closer.join();
+}
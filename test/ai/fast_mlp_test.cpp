@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "fast_mlp.hpp"
+#include "dense_layer_fixtures.hpp"
+
+namespace {
+
+// Straightforward row-major reference forward pass
+std::vector<float> referenceForward(const std::vector<DenseLayer>& layers, std::vector<float> x) {
+    for (size_t l = 0; l < layers.size(); l++) {
+        const DenseLayer& layer = layers[l];
+        std::vector<float> y(layer.output_size);
+        for (size_t o = 0; o < layer.output_size; o++) {
+            double acc = layer.bias[o];
+            for (size_t i = 0; i < layer.input_size; i++) {
+                acc += static_cast<double>(layer.weight[o * layer.input_size + i]) * x[i];
+            }
+            y[o] = l + 1 < layers.size() ? std::max(static_cast<float>(acc), 0.0f) : static_cast<float>(acc);
+        }
+        x = std::move(y);
+    }
+    return x;
+}
+
+}  // namespace
+
+TEST(FastMLPTest, MatchesReferenceForEveryKernel) {
+    std::mt19937 rng(7);
+    // Deep CFR shape with an action count that does not fill a whole panel
+    std::vector<DenseLayer> layers = {randomLayer(500, 256, rng), randomLayer(256, 256, rng), randomLayer(256, 10, rng)};
+
+    // Sparse one-hot style rows as produced by InfoState, then dense rows that take the blocked kernels
+    const size_t rows = 7;
+    std::vector<float> inputs(2 * rows * 500, 0.0f);
+    std::uniform_int_distribution<size_t> position(0, 499);
+    std::uniform_real_distribution<float> value(0.5f, 1.5f);
+    for (size_t r = 0; r < rows; r++) {
+        for (int k = 0; k < 40; k++) inputs[r * 500 + position(rng)] = 1.0f;
+        inputs[r * 500 + 200] = 37.5f;
+    }
+    for (size_t i = rows * 500; i < inputs.size(); i++) inputs[i] = value(rng);
+
+    for (FastMLP::Isa isa : {FastMLP::Isa::SCALAR, FastMLP::Isa::AVX2, FastMLP::Isa::AVX512}) {
+        FastMLP mlp(layers);
+        mlp.setIsa(isa);
+        ASSERT_EQ(mlp.inputSize(), 500);
+        ASSERT_EQ(mlp.outputSize(), 10);
+
+        std::vector<float> outputs(2 * rows * 10);
+        mlp.forward(inputs.data(), 2 * rows, outputs.data());
+
+        for (size_t r = 0; r < 2 * rows; r++) {
+            std::vector<float> row(inputs.begin() + r * 500, inputs.begin() + (r + 1) * 500);
+            std::vector<float> expected = referenceForward(layers, row);
+            std::vector<float> single = mlp.predict(row);
+            for (size_t o = 0; o < 10; o++) {
+                ASSERT_NEAR(outputs[r * 10 + o], expected[o], 1e-3f) << "isa " << static_cast<int>(mlp.isa());
+                ASSERT_NEAR(single[o], expected[o], 1e-3f);
+            }
+        }
+    }
+}
+
+TEST(FastMLPTest, RejectsMismatchedShapes) {
+    std::mt19937 rng(11);
+    EXPECT_THROW(FastMLP({randomLayer(8, 16, rng), randomLayer(12, 4, rng)}), std::invalid_argument);
+
+    FastMLP mlp({randomLayer(8, 4, rng)});
+    EXPECT_THROW(mlp.predict(std::vector<float>(7)), std::invalid_argument);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "hand_range.hpp"
+#include "win_rate.hpp"
+
+TEST(HandRangeTest, IndexesEveryComboOnce) {
+    for (size_t i = 0; i < HandRange::NUM_COMBOS; i++) {
+        std::vector<Card> cards = HandRange::comboCards(i);
+        EXPECT_EQ(HandRange::comboIndex(cards[0], cards[1]), i);
+        EXPECT_EQ(HandRange::comboIndex(cards[1], cards[0]), i);
+    }
+    EXPECT_EQ(HandRange::cardIndex(Card("2s")), 0);
+    EXPECT_EQ(HandRange::cardIndex(Card("Ac")), 51);
+
+    // A card belongs to 51 combos
+    HandRange range;
+    range.removeCards({Card("Ah")});
+    EXPECT_DOUBLE_EQ(range.total(), 1326.0 - 51.0);
+    EXPECT_EQ(range.weight(HandRange::comboIndex(Card("Ah"), Card("Kd"))), 0.0f);
+}
+
+TEST(HandRangeTest, RiverEquityIsExact) {
+    std::vector<Card> board = cardsFromStrings({"Ah", "Kh", "7d", "4c", "2s"});
+    Philox4x32 rng(1, 0, 0, 0, RngPurpose::SAMPLING);
+
+    // Only one opponent hand: a pair of kings loses to the aces below, beats queens
+    HandRange range;
+    for (size_t i = 0; i < HandRange::NUM_COMBOS; i++) range.setWeight(i, 0.0f);
+    range.setWeight(HandRange::comboIndex(Card("Kd"), Card("Ks")), 1.0f);
+    EXPECT_DOUBLE_EQ(range.equity(cardsFromStrings({"Ad", "As"}), board, 8, rng), 1.0);
+    EXPECT_DOUBLE_EQ(range.equity(cardsFromStrings({"Qd", "Qs"}), board, 8, rng), 0.0);
+
+    // Same hand class and kickers on board: a chop
+    range.setWeight(HandRange::comboIndex(Card("Kd"), Card("Ks")), 0.0f);
+    range.setWeight(HandRange::comboIndex(Card("3d"), Card("3s")), 1.0f);
+    EXPECT_DOUBLE_EQ(range.equity(cardsFromStrings({"3c", "3h"}), board, 8, rng), 0.5);
+}
+
+TEST(HandRangeTest, PreflopEquityFromRunouts) {
+    // Aces win about 85% against a random hand
+    HandRange range;
+    Philox4x32 rng(7, 0, 0, 0, RngPurpose::SAMPLING);
+    double equity = range.equity(cardsFromStrings({"Ad", "As"}), {}, 200, rng);
+    EXPECT_NEAR(equity, 0.85, 0.03);
+
+    // The same stream gives the same estimate
+    Philox4x32 again(7, 0, 0, 0, RngPurpose::SAMPLING);
+    EXPECT_EQ(range.equity(cardsFromStrings({"Ad", "As"}), {}, 200, again), equity);
+}
+
+TEST(WinRateTest, ReportsMeanAndInterval) {
+    WinRate rate = WinRate::fromWinnings({20.0, -20.0, 40.0, 0.0}, 20);
+    EXPECT_EQ(rate.hands, 4u);
+    EXPECT_DOUBLE_EQ(rate.mbb_per_game, 500.0);
+    // Sample sd of {1000, -1000, 2000, 0} mbb is sqrt(5/3) * 1000
+    EXPECT_NEAR(rate.std_error, std::sqrt(5.0 / 3.0) * 1000.0 / 2.0, 1e-9);
+    EXPECT_NEAR(rate.ci95_high - rate.ci95_low, 2 * 1.96 * rate.std_error, 1e-9);
+    EXPECT_EQ(WinRate::fromWinnings({}, 20).hands, 0u);
+    EXPECT_THROW(WinRate::fromWinnings({1.0}, 0), std::invalid_argument);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "inference_broker.hpp"
+
+namespace {
+
+// Two outputs per row: the row sum and the row sum doubled
+std::vector<float> sumRows(const float* rows, int64_t num_rows, size_t input_size) {
+    std::vector<float> outputs(static_cast<size_t>(num_rows) * 2);
+    for (int64_t r = 0; r < num_rows; r++) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < input_size; i++) {
+            sum += rows[r * input_size + i];
+        }
+        outputs[r * 2] = sum;
+        outputs[r * 2 + 1] = 2.0f * sum;
+    }
+    return outputs;
+}
+
+}  // namespace
+
+TEST(InferenceBrokerTest, ConcurrentSubmittersGetTheirOwnRows) {
+    const size_t input_size = 3;
+    const int num_threads = 8;
+    const int requests_per_thread = 200;
+    std::atomic<size_t> largest_batch{0};
+    InferenceBroker broker([&](const float* rows, int64_t num_rows) {
+        size_t seen = largest_batch.load();
+        while (static_cast<size_t>(num_rows) > seen && !largest_batch.compare_exchange_weak(seen, num_rows)) {}
+        return sumRows(rows, num_rows, input_size);
+    }, input_size, 2, 16, std::chrono::milliseconds(2));
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < requests_per_thread; i++) {
+                float value = static_cast<float>(t * requests_per_thread + i);
+                std::vector<float> result = broker.predict({value, 1.0f, -1.0f});
+                if (result.size() != 2 || result[0] != value || result[1] != 2.0f * value) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(mismatches.load(), 0);
+    ASSERT_EQ(broker.requestsServed(), static_cast<size_t>(num_threads * requests_per_thread));
+    ASSERT_LE(largest_batch.load(), 16u);
+    ASSERT_GT(broker.averageBatchSize(), 1.0);
+}
+
+TEST(InferenceBrokerTest, DeadlineStartsWhenTheRequestIsQueued) {
+    const auto delay = std::chrono::milliseconds(50);
+    InferenceBroker broker([](const float* rows, int64_t num_rows) { return sumRows(rows, num_rows, 1); },
+                           1, 2, 64, delay);
+
+    // A lone request is dispatched once it has waited max_delay, not held for a full batch
+    auto start = std::chrono::steady_clock::now();
+    std::future<std::vector<float>> first = broker.submit({1.0f});
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    std::future<std::vector<float>> second = broker.submit({2.0f});
+    ASSERT_EQ(first.get()[0], 1.0f);
+    ASSERT_EQ(second.get()[0], 2.0f);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_GE(elapsed, delay);
+    ASSERT_LT(elapsed, delay * 3);
+}
+
+TEST(InferenceBrokerTest, RejectsRowsOfTheWrongSize) {
+    InferenceBroker broker([](const float* rows, int64_t num_rows) { return sumRows(rows, num_rows, 2); }, 2, 2);
+    EXPECT_THROW(broker.submit({1.0f}), std::invalid_argument);
+    broker.stop();
+    EXPECT_THROW(broker.submit({1.0f, 2.0f}), std::runtime_error);
+}
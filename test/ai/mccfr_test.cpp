@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "card_abstraction.hpp"
+#include "info_set_table.hpp"
+#include "mapped_info_set_table.hpp"
+#include "mccfr_solver.hpp"
+
+TEST(InfoSetTableTest, ConcurrentInsertsAgreeOnSlots) {
+    InfoSetTable table(1000);
+    EXPECT_EQ(table.capacity(), 1024u);
+    EXPECT_EQ(table.find(42), InfoSetTable::NOT_FOUND);
+
+    // Every thread inserts the same keys; each must land in one slot exactly once
+    const uint64_t keys = 600;
+    std::vector<std::vector<size_t>> slots(8, std::vector<size_t>(keys));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < slots.size(); t++) {
+        threads.emplace_back([&, t]() {
+            for (uint64_t k = 0; k < keys; k++) {
+                uint64_t key = (k * 7919 + t * 13) % keys;
+                slots[t][key] = table.findOrInsert(key);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(table.size(), keys);
+    std::set<size_t> distinct;
+    for (uint64_t k = 0; k < keys; k++) {
+        for (size_t t = 1; t < slots.size(); t++) EXPECT_EQ(slots[t][k], slots[0][k]);
+        EXPECT_EQ(table.find(k), slots[0][k]);
+        EXPECT_EQ(table.key(slots[0][k]), InfoSetTable::storedKey(k));
+        distinct.insert(slots[0][k]);
+    }
+    EXPECT_EQ(distinct.size(), keys);
+
+    // Slots start zeroed; regrets are whole chips floored on update
+    size_t slot = table.findOrInsert(123456789);
+    float regrets[InfoSetTable::WIDTH];
+    float sums[InfoSetTable::WIDTH];
+    table.regrets(slot, InfoSetTable::WIDTH, regrets);
+    table.strategySums(slot, InfoSetTable::WIDTH, sums);
+    for (int a = 0; a < InfoSetTable::WIDTH; a++) {
+        EXPECT_EQ(regrets[a], 0.0f);
+        EXPECT_EQ(sums[a], 0.0f);
+    }
+
+    Philox4x32 rng(1, 0, 0, 0, RngPurpose::SAMPLING);
+    double deltas[3] = {10.4, -500.0, 2.6};
+    table.addRegrets(slot, 3, deltas, -100.0, rng);
+    table.scale(slot, 0.5);
+    table.regrets(slot, 3, regrets);
+    EXPECT_EQ(regrets[0], 5.0f);
+    EXPECT_EQ(regrets[1], -50.0f);
+    EXPECT_EQ(regrets[2], 1.0f);
+}
+
+TEST(InfoSetTableTest, ThrowsWhenFull) {
+    InfoSetTable table(4);
+    for (uint64_t key = 1; key <= 4; key++) table.findOrInsert(key);
+    EXPECT_EQ(table.findOrInsert(3), table.find(3));
+    EXPECT_THROW(table.findOrInsert(5), std::runtime_error);
+}
+
+TEST(MappedInfoSetTableTest, CompressedRegretsAreUnbiased) {
+    // Codes are exact at zero and within 0.1% across the whole range
+    EXPECT_EQ(MappedInfoSetTable::decodeRegret(0), 0.0f);
+    for (double regret : {0.75, -3.0, 125.0, -98765.0, 3.0e8}) {
+        double decoded = MappedInfoSetTable::decodeRegret(MappedInfoSetTable::encodeRegret(regret, 0.5f));
+        EXPECT_NEAR(decoded, regret, std::abs(regret) * 1e-3);
+    }
+    EXPECT_GT(-MappedInfoSetTable::decodeRegret(-MappedInfoSetTable::MAX_CODE), 310000000.0f);
+
+    // Stochastic rounding averages out to the exact value
+    Philox4x32 rng(2, 0, 0, 0, RngPurpose::SAMPLING);
+    double regret = 1234.567;
+    double total = 0.0;
+    const int draws = 20000;
+    for (int i = 0; i < draws; i++) {
+        total += MappedInfoSetTable::decodeRegret(MappedInfoSetTable::encodeRegret(regret, rng.uniform()));
+    }
+    EXPECT_NEAR(total / draws, regret, 0.01);
+}
+
+TEST(MappedInfoSetTableTest, PersistsAndRebuilds) {
+    std::string path = "/tmp/mapped_info_set_table_test.bin";
+    std::filesystem::remove(path);
+    Philox4x32 rng(3, 0, 0, 0, RngPurpose::SAMPLING);
+    float probabilities[2] = {0.25f, 0.75f};
+    double deltas[2] = {-40.0, 900.0};
+    {
+        MappedInfoSetTable table(path, 100);
+        EXPECT_EQ(table.capacity(), 128u);
+        for (uint64_t key = 1; key <= 60; key++) {
+            size_t slot = table.findOrInsert(key);
+            if (key % 2 == 0) {
+                table.addRegrets(slot, 2, deltas, -1000.0, rng);
+                table.addStrategy(slot, 2, probabilities);
+            }
+        }
+        table.setIterations(17);
+        EXPECT_TRUE(table.isPersistent());
+    }
+
+    auto check = [&](const MappedInfoSetTable& table, bool odd_keys) {
+        float regrets[2];
+        float sums[2];
+        for (uint64_t key = 1; key <= 60; key++) {
+            size_t slot = table.find(key);
+            if (key % 2 == 1) {
+                EXPECT_EQ(slot == MappedInfoSetTable::NOT_FOUND, !odd_keys);
+                continue;
+            }
+            ASSERT_NE(slot, MappedInfoSetTable::NOT_FOUND);
+            table.regrets(slot, 2, regrets);
+            table.strategySums(slot, 2, sums);
+            EXPECT_NEAR(regrets[0], -40.0f, 0.05f);
+            EXPECT_NEAR(regrets[1], 900.0f, 1.0f);
+            EXPECT_EQ(sums[1], 0.75f);
+        }
+        EXPECT_EQ(table.iterations(), 17u);
+    };
+
+    // Reopening ignores the requested capacity and keeps the contents
+    {
+        MappedInfoSetTable table(path, 4096);
+        EXPECT_EQ(table.capacity(), 128u);
+        EXPECT_EQ(table.size(), 60u);
+        check(table, true);
+    }
+
+    // Growing keeps every info set; compacting drops the ones never updated
+    auto grown = MappedInfoSetTable::rebuild(path, path, 1024);
+    EXPECT_EQ(grown.kept, 60u);
+    EXPECT_EQ(grown.capacity, 1024u);
+    {
+        MappedInfoSetTable table(path);
+        EXPECT_EQ(table.capacity(), 1024u);
+        check(table, true);
+    }
+
+    auto compacted = MappedInfoSetTable::rebuild(path, path, 0, true, 0.5);
+    EXPECT_EQ(compacted.kept, 30u);
+    EXPECT_EQ(compacted.dropped, 30u);
+    EXPECT_EQ(compacted.capacity, 64u);
+    {
+        MappedInfoSetTable table(path);
+        EXPECT_EQ(table.size(), 30u);
+        check(table, false);
+    }
+    EXPECT_THROW(MappedInfoSetTable::rebuild(path, path, 16), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST(CardAbstractionTest, PreflopClassesAreSuitIsomorphic) {
+    const std::string ranks = "23456789TJQKA";
+    const std::string suits = "shdc";
+    std::set<int> classes;
+    for (char r1 : ranks) {
+        for (char r2 : ranks) {
+            for (char s1 : suits) {
+                for (char s2 : suits) {
+                    if (r1 == r2 && s1 == s2) continue;
+                    int c = CardAbstraction::preflopClass(Card(std::string{r1, s1}), Card(std::string{r2, s2}));
+                    EXPECT_GE(c, 0);
+                    EXPECT_LT(c, CardAbstraction::PREFLOP_CLASSES);
+                    classes.insert(c);
+                }
+            }
+        }
+    }
+    EXPECT_EQ(classes.size(), 169u);
+    EXPECT_EQ(CardAbstraction::preflopClass(Card("Ah"), Card("Kh")), CardAbstraction::preflopClass(Card("Ks"), Card("As")));
+    EXPECT_NE(CardAbstraction::preflopClass(Card("Ah"), Card("Kh")), CardAbstraction::preflopClass(Card("Ah"), Card("Kd")));
+}
+
+TEST(CardAbstractionTest, PostflopBucketsFollowHandStrength) {
+    CardAbstraction abstraction(10, 400);
+    Philox4x32 rng(3, 0, 0, 0, RngPurpose::SAMPLING);
+    std::vector<Card> board = {Card("Ah"), Card("Kd"), Card("7c")};
+    int nuts = abstraction.bucket({Card("As"), Card("Ac")}, board, rng);
+    int air = abstraction.bucket({Card("2s"), Card("3c")}, board, rng);
+    EXPECT_GE(nuts, 8);
+    EXPECT_LE(air, 2);
+    EXPECT_EQ(abstraction.numBuckets(HandPhase::Phase::FLOP), 10);
+    EXPECT_EQ(abstraction.numBuckets(HandPhase::Phase::PREFLOP), 169);
+}
+
+TEST(MCCFRSolverTest, TrainsHeadsUpPreflopStrategies) {
+    MCCFRConfig config;
+    config.starting_chips = 200;
+    config.postflop_buckets = 5;
+    config.strength_samples = 8;
+    config.raise_fractions = {1.0f};
+    config.max_raises = 1;
+    config.table_capacity = 1 << 18;
+    config.discount_interval = 100;
+    config.seed = 11;
+    config.threads = 2;
+    MCCFRSolver solver(config);
+    solver.train(300);
+    EXPECT_EQ(solver.iterations(), 300);
+    EXPECT_GT(solver.table().size(), 0u);
+
+    // The first to act preflop alternates with the button; its info sets are keyed by the
+    // empty history and its starting-hand class
+    Game game(2, config.starting_chips, config.small_blind, config.big_blind);
+    game.startHand(0);
+    size_t num_actions = solver.bets().actions(game, 0).size();
+    size_t visited = 0;
+    for (int player = 0; player < 2; player++) {
+        for (int c = 0; c < CardAbstraction::PREFLOP_CLASSES; c++) {
+            uint64_t key = MCCFRSolver::infoSetKey(0, player, {c});
+            if (solver.table().find(key) != RegretTable::NOT_FOUND) visited++;
+            std::vector<float> average = solver.averageStrategy(key, num_actions);
+            double total = 0.0;
+            for (float p : average) {
+                EXPECT_GE(p, 0.0f);
+                total += p;
+            }
+            EXPECT_NEAR(total, 1.0, 1e-4);
+        }
+    }
+    EXPECT_GT(visited, 100u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include "metrics.hpp"
+
+TEST(MetricsTest, TimersRecordOnlyWhenEnabled) {
+    MetricsCounts counts;
+    {
+        ScopedTimer timer(&counts, Phase::INFERENCE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    {
+        ScopedTimer timer(nullptr, Phase::INFERENCE);
+    }
+    EXPECT_EQ(counts.calls(Phase::INFERENCE), 1u);
+    EXPECT_GE(counts.seconds(Phase::INFERENCE), 0.002);
+
+    // stop() records once, and the destructor then does nothing
+    ScopedTimer timer(&counts, Phase::ENCODING);
+    timer.stop();
+    timer.stop();
+    EXPECT_EQ(counts.calls(Phase::ENCODING), 1u);
+}
+
+TEST(MetricsTest, MergesAndDiffsTotals) {
+    Metrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 100; i++) {
+                MetricsCounts counts;
+                counts.add(Counter::NODES, 10);
+                counts.addTime(Phase::TRAVERSAL, 5);
+                metrics.merge(counts);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    MetricsCounts total = metrics.total();
+    EXPECT_EQ(total.count(Counter::NODES), 4000u);
+    EXPECT_EQ(total.calls(Phase::TRAVERSAL), 400u);
+
+    MetricsCounts later = total;
+    later.add(Counter::NODES, 7);
+    later.addTime(Phase::SGD, 1000);
+    MetricsCounts delta = later - total;
+    EXPECT_EQ(delta.count(Counter::NODES), 7u);
+    EXPECT_EQ(delta.calls(Phase::SGD), 1u);
+    EXPECT_EQ(delta.calls(Phase::TRAVERSAL), 0u);
+}
+
+TEST(MetricsTest, WritesOneJsonObjectPerLine) {
+    std::string path = "/tmp/metrics_test.jsonl";
+    std::remove(path.c_str());
+
+    MetricsCounts counts;
+    counts.add(Counter::NODES, 500);
+    counts.add(Counter::ADVANTAGE_SAMPLES, 30);
+    counts.add(Counter::STRATEGY_SAMPLES, 20);
+    counts.add(Counter::TRAINING_STEPS, 4);
+    counts.add(Counter::TRAINING_ROWS, 512);
+    counts.addTime(Phase::SGD, 250000000);
+    {
+        MetricsLog log(path);
+        log.write(1, 2.0, counts);
+        log.write(2, 2.0, MetricsCounts());
+    }
+
+    std::ifstream in(path);
+    std::string first, second, extra;
+    ASSERT_TRUE(std::getline(in, first));
+    ASSERT_TRUE(std::getline(in, second));
+    EXPECT_FALSE(std::getline(in, extra));
+
+    EXPECT_EQ(first.front(), '{');
+    EXPECT_EQ(first.back(), '}');
+    EXPECT_NE(first.find("\"iteration\":1,"), std::string::npos);
+    EXPECT_NE(first.find("\"sgd\":{\"seconds\":0.25,\"calls\":1}"), std::string::npos);
+    EXPECT_NE(first.find("\"nodes\":500"), std::string::npos);
+    EXPECT_NE(first.find("\"nodes_per_second\":250,"), std::string::npos);
+    EXPECT_NE(first.find("\"samples_per_second\":25,"), std::string::npos);
+    EXPECT_NE(first.find("\"mean_training_batch\":128}"), std::string::npos);
+    EXPECT_NE(second.find("\"iteration\":2,"), std::string::npos);
+
+    std::string table = formatMetricsTable(counts, 2.0);
+    EXPECT_NE(table.find("batch_assembly"), std::string::npos);
+    EXPECT_NE(table.find("12.50"), std::string::npos);  // SGD share of wall time
+    std::remove(path.c_str());
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "philox.hpp"
+#include "deck.hpp"
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(PhiloxTest, MatchesReferenceVectors) {
+    // Known-answer vectors from the Random123 distribution (kat_vectors, philox4x32 10 rounds)
+    EXPECT_EQ(Philox4x32::block({0, 0, 0, 0}, {0, 0}),
+              (Philox4x32::Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Philox4x32::Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Philox4x32::Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(PhiloxTest, StreamsDependOnlyOnTheirKey) {
+    auto draw = [](uint32_t traversal) {
+        Philox4x32 rng(42, 3, 1, traversal, RngPurpose::ACTION);
+        std::vector<uint32_t> out(64);
+        for (auto& x : out) x = rng();
+        return out;
+    };
+
+    // Streams generated concurrently, in reverse order, match the sequential ones
+    std::vector<std::vector<uint32_t>> sequential(8), threaded(8);
+    for (uint32_t t = 0; t < 8; t++) sequential[t] = draw(t);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 8; t-- > 0;) {
+        threads.emplace_back([&, t]() { threaded[t] = draw(t); });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(sequential, threaded);
+
+    // Every key component selects a different stream
+    uint32_t base = Philox4x32(42, 3, 1, 0, RngPurpose::ACTION)();
+    EXPECT_NE(base, Philox4x32(43, 3, 1, 0, RngPurpose::ACTION)());
+    EXPECT_NE(base, Philox4x32(42, 4, 1, 0, RngPurpose::ACTION)());
+    EXPECT_NE(base, Philox4x32(42, 3, 2, 0, RngPurpose::ACTION)());
+    EXPECT_NE(base, Philox4x32(42, 3, 1, 1, RngPurpose::ACTION)());
+    EXPECT_NE(base, Philox4x32(42, 3, 1, 0, RngPurpose::DEAL)());
+}
+
+TEST(PhiloxTest, BoundedDrawsAreInRangeAndCoverIt) {
+    Philox4x32 rng(7, 0, 0, 0, RngPurpose::SAMPLING);
+    std::vector<int> counts(6, 0);
+    for (int i = 0; i < 60000; i++) {
+        uint32_t x = rng.below(6);
+        ASSERT_LT(x, 6u);
+        counts[x]++;
+    }
+    for (int c : counts) {
+        EXPECT_NEAR(c, 10000, 500);
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < 100000; i++) {
+        float u = rng.uniform();
+        ASSERT_GE(u, 0.0f);
+        ASSERT_LT(u, 1.0f);
+        sum += u;
+    }
+    EXPECT_NEAR(sum / 100000, 0.5, 0.01);
+}
+
+TEST(PhiloxTest, SeededDeckDealsReproducibly) {
+    Philox4x32 a(1, 0, 0, 5, RngPurpose::DEAL);
+    Philox4x32 b(1, 0, 0, 5, RngPurpose::DEAL);
+    Philox4x32 c(1, 0, 0, 6, RngPurpose::DEAL);
+    Deck first(a), second(b), other(c);
+    EXPECT_EQ(first.toString(), second.toString());
+    EXPECT_NE(first.toString(), other.toString());
+
+    // Still a permutation of the full deck
+    std::vector<Card> cards = first.draw(52);
+    std::set<int> distinct;
+    for (const Card& card : cards) distinct.insert(card.toInt());
+    EXPECT_EQ(distinct.size(), 52u);
+}
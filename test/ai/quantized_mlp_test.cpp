@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <fstream>
+#include "quantized_mlp.hpp"
+#include "dense_layer_fixtures.hpp"
+
+namespace {
+
+// One-hot blocks plus a pot-sized value, roughly what InfoState produces
+std::vector<float> infoStateLikeRows(size_t rows, std::mt19937& rng) {
+    std::vector<float> data(rows * 500, 0.0f);
+    std::uniform_int_distribution<size_t> position(0, 399);
+    std::uniform_real_distribution<float> pot(30.0f, 2000.0f);
+    for (size_t r = 0; r < rows; r++) {
+        for (int k = 0; k < 40; k++) data[r * 500 + position(rng)] = 1.0f;
+        data[r * 500 + 450] = pot(rng);
+    }
+    return data;
+}
+
+}  // namespace
+
+TEST(QuantizedMLPTest, Int8TracksFp32OnHeldOutRows) {
+    std::mt19937 rng(3);
+    std::vector<DenseLayer> layers = {randomLayer(500, 256, rng), randomLayer(256, 256, rng), randomLayer(256, 10, rng)};
+    std::vector<float> calibration = infoStateLikeRows(512, rng);
+    std::vector<float> holdout = infoStateLikeRows(256, rng);
+
+    QuantizedMLP int8(layers, calibration.data(), 512);
+    QuantizationReport report = int8.evaluate(layers, holdout.data(), 256);
+
+    EXPECT_EQ(report.samples, 256);
+    EXPECT_GT(report.argmax_agreement, 0.9);
+    EXPECT_LT(report.mean_abs_error, 0.02 * report.mean_abs_output);
+    EXPECT_LT(report.quantized_bytes * 3, report.fp32_bytes);
+}
+
+TEST(QuantizedMLPTest, Fp16IsNearlyExact) {
+    std::mt19937 rng(5);
+    std::vector<DenseLayer> layers = {randomLayer(500, 64, rng), randomLayer(64, 10, rng)};
+    std::vector<float> holdout = infoStateLikeRows(64, rng);
+
+    QuantizedMLP fp16(layers, nullptr, 0, QuantizedMLP::Precision::FP16);
+    QuantizationReport report = fp16.evaluate(layers, holdout.data(), 64);
+
+    EXPECT_EQ(report.argmax_agreement, 1.0);
+    EXPECT_LT(report.mean_abs_error, 0.002 * report.mean_abs_output);
+    EXPECT_LT(report.quantized_bytes * 3, report.fp32_bytes * 2);
+
+    std::vector<float> row(holdout.begin(), holdout.begin() + 500);
+    EXPECT_EQ(fp16.predict(row).size(), 10);
+}
+
+TEST(QuantizedMLPTest, Int8RequiresCalibration) {
+    std::mt19937 rng(9);
+    EXPECT_THROW(QuantizedMLP({randomLayer(8, 4, rng)}, nullptr, 0), std::invalid_argument);
+}
+
+TEST(QuantizedMLPTest, SavedNetworkReloadsWithoutCalibration) {
+    std::mt19937 rng(17);
+    std::vector<DenseLayer> layers = {randomLayer(500, 64, rng), randomLayer(64, 10, rng)};
+    std::vector<float> calibration = infoStateLikeRows(128, rng);
+    std::vector<float> rows = infoStateLikeRows(16, rng);
+    std::string path = "/tmp/quantized_mlp_test.qnet";
+
+    for (auto precision : {QuantizedMLP::Precision::INT8, QuantizedMLP::Precision::FP16}) {
+        QuantizedMLP original(layers, calibration.data(), 128, precision);
+        original.save(path);
+        QuantizedMLP loaded = QuantizedMLP::load(path);
+
+        ASSERT_EQ(loaded.precision(), precision);
+        ASSERT_EQ(loaded.inputSize(), 500);
+        ASSERT_EQ(loaded.outputSize(), 10);
+        ASSERT_EQ(loaded.weightBytes(), original.weightBytes());
+        std::vector<float> expected(16 * 10), actual(16 * 10);
+        original.forward(rows.data(), 16, expected.data());
+        loaded.forward(rows.data(), 16, actual.data());
+        ASSERT_EQ(actual, expected);
+    }
+
+    // A file cut short is rejected instead of read past its end
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    EXPECT_THROW(QuantizedMLP::load(path), std::runtime_error);
+    std::remove(path.c_str());
+}
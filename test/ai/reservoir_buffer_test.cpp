@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <set>
+#include <cstdio>
+#include <thread>
+#include "feature_reservoir_buffer.hpp"
+#include "mmap_reservoir_buffer.hpp"
+#include "concurrent_reservoir_buffer.hpp"
+
+TEST(HalfTest, RoundTripsRepresentableValues) {
+    for (float value : {0.0f, 1.0f, -1.0f, 0.5f, 0.25f, 1024.0f, -2048.0f, 6.103515625e-05f}) {
+        ASSERT_EQ(halfToFloat(floatToHalf(value)), value);
+    }
+    // Chip counts keep three significant digits
+    ASSERT_NEAR(halfToFloat(floatToHalf(1234.0f)), 1234.0f, 1.0f);
+}
+
+TEST(FeatureReservoirBufferTest, FillsUpToCapacity) {
+    FeatureReservoirBuffer buffer(100, 4, 3);
+    std::vector<float> features(4, 1.0f);
+    std::vector<float> targets = {0.5f, -0.5f};
+
+    for (int i = 0; i < 250; i++) {
+        buffer.add(features, targets, 1.0f);
+    }
+
+    ASSERT_EQ(buffer.size(), 100);
+    ASSERT_EQ(buffer.count(), 250);
+}
+
+TEST(FeatureReservoirBufferTest, GatherPadsTargets) {
+    for (ArenaPrecision precision : {ArenaPrecision::FP32, ArenaPrecision::FP16}) {
+        FeatureReservoirBuffer buffer(10, 3, 4, precision);
+        buffer.add({1.0f, 2.0f, 3.0f}, {0.25f, -0.75f}, 2.0f);
+
+        std::vector<float> features(3), targets(4), weights(1);
+        ASSERT_EQ(buffer.sample(8, features.data(), targets.data(), weights.data()), 1);
+        ASSERT_EQ(features, std::vector<float>({1.0f, 2.0f, 3.0f}));
+        ASSERT_EQ(targets, std::vector<float>({0.25f, -0.75f, 0.0f, 0.0f}));
+        ASSERT_EQ(weights[0], 2.0f);
+    }
+}
+
+TEST(FeatureReservoirBufferTest, SampleIndicesAreDistinct) {
+    FeatureReservoirBuffer buffer(1000, 1, 1);
+    for (int i = 0; i < 1000; i++) {
+        buffer.add({static_cast<float>(i)}, {0.0f});
+    }
+
+    std::vector<size_t> indices;
+    buffer.sampleIndices(500, indices);
+    ASSERT_EQ(indices.size(), 500);
+    ASSERT_EQ(std::set<size_t>(indices.begin(), indices.end()).size(), 500);
+    for (size_t index : indices) {
+        ASSERT_LT(index, buffer.size());
+    }
+}
+
+TEST(MmapReservoirBufferTest, CompressesAndPersistsRecords) {
+    std::string path = ::testing::TempDir() + "mmap_reservoir_test.rsv";
+    std::remove(path.c_str());
+    {
+        MmapReservoirBuffer buffer(path, 4, 3, 4);
+        buffer.add({1.0f, 0.0f, 640.0f}, {0.5f, -1.0f}, 3.0f);
+        ASSERT_EQ(buffer.recordSize() % 64, 0);
+    }
+
+    // Reopening the file resumes the reservoir
+    MmapReservoirBuffer buffer(path, 4, 3, 4);
+    ASSERT_EQ(buffer.size(), 1);
+    ASSERT_EQ(buffer.count(), 1);
+
+    std::vector<float> features(3), targets(4), weights(1);
+    ASSERT_EQ(buffer.sample(2, features.data(), targets.data(), weights.data()), 1);
+    ASSERT_EQ(features, std::vector<float>({1.0f, 0.0f, 640.0f}));
+    ASSERT_NEAR(targets[0], 0.5f, 1.0f / 127.0f);
+    ASSERT_FLOAT_EQ(targets[1], -1.0f);
+    ASSERT_EQ(targets[2], 0.0f);
+    ASSERT_EQ(weights[0], 3.0f);
+
+    for (int i = 0; i < 100; i++) {
+        buffer.add({0.0f, 1.0f, 2.0f}, {0.1f}, 1.0f);
+    }
+    ASSERT_EQ(buffer.size(), 4);
+    ASSERT_EQ(buffer.count(), 101);
+    std::remove(path.c_str());
+}
+
+TEST(ConcurrentReservoirBufferTest, ConcurrentAddsKeepReservoirStatistics) {
+    const size_t capacity = 1000;
+    const int num_threads = 4;
+    const int adds_per_thread = 25000;
+    ConcurrentReservoirBuffer buffer(capacity, 1, 1);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&buffer, t]() {
+            for (int i = 0; i < adds_per_thread; i++) {
+                float id = static_cast<float>(t * adds_per_thread + i);
+                float target = 1.0f;
+                buffer.add(&id, &target, 1, 1.0f);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(buffer.count(), num_threads * adds_per_thread);
+    ASSERT_EQ(buffer.size(), capacity);
+
+    // Every producer should be represented roughly in proportion to what it offered
+    std::vector<float> ids(capacity), targets(capacity);
+    ASSERT_EQ(buffer.sample(capacity, ids.data(), targets.data()), capacity);
+    std::vector<int> per_thread(num_threads, 0);
+    for (float id : ids) {
+        per_thread[static_cast<int>(id) / adds_per_thread]++;
+    }
+    for (int n : per_thread) {
+        ASSERT_NEAR(n, capacity / num_threads, 80);
+    }
+}
+
+TEST(ConcurrentReservoirBufferTest, SeededSingleWriterIsReproducible) {
+    auto fill = [](ConcurrentReservoirBuffer& buffer) {
+        buffer.seed(42);
+        for (int i = 0; i < 5000; i++) {
+            float id = static_cast<float>(i);
+            float target = 0.0f;
+            buffer.add(&id, &target, 1, 1.0f);
+        }
+    };
+    ConcurrentReservoirBuffer first(100, 1, 1), second(100, 1, 1);
+    fill(first);
+    fill(second);
+
+    // Sampling the whole reservoir draws the same slot order from both, so rows match one to one
+    std::vector<float> a(100), b(100), targets(100);
+    first.seed(7);
+    second.seed(7);
+    ASSERT_EQ(first.sample(100, a.data(), targets.data()), 100);
+    ASSERT_EQ(second.sample(100, b.data(), targets.data()), 100);
+    ASSERT_EQ(a, b);
+}
+
+TEST(FeatureReservoirBufferTest, WeightedModeFavoursHeavySamples) {
+    FeatureReservoirBuffer buffer(200, 1, 1, ArenaPrecision::FP32, ReservoirMode::WEIGHTED);
+    for (int i = 0; i < 20000; i++) {
+        bool heavy = i % 2 == 0;
+        buffer.add({heavy ? 1.0f : 0.0f}, {0.0f}, heavy ? 9.0f : 1.0f);
+    }
+    ASSERT_EQ(buffer.size(), 200);
+    ASSERT_EQ(buffer.count(), 20000);
+
+    std::vector<float> features(200), targets(200), weights(200);
+    ASSERT_EQ(buffer.sample(200, features.data(), targets.data(), weights.data()), 200);
+    int heavy = 0;
+    for (size_t i = 0; i < features.size(); i++) {
+        heavy += features[i] == 1.0f;
+        ASSERT_EQ(weights[i], 1.0f);  // Weight is already folded into admission
+    }
+    ASSERT_GT(heavy, 160);
+}
+
+TEST(FeatureReservoirBufferTest, SnapshotRestoreRoundTrip) {
+    std::string path = ::testing::TempDir() + "feature_reservoir_snapshot.bin";
+    std::remove(path.c_str());
+
+    FeatureReservoirBuffer buffer(64, 2, 2, ArenaPrecision::FP16);
+    for (int i = 0; i < 40; i++) {
+        buffer.add({static_cast<float>(i), 1.0f}, {0.5f}, 1.0f);
+    }
+    buffer.snapshot(path);
+
+    // Incremental snapshot after overwriting past capacity
+    for (int i = 40; i < 200; i++) {
+        buffer.add({static_cast<float>(i), 1.0f}, {0.5f}, 1.0f);
+    }
+    buffer.snapshot(path);
+
+    FeatureReservoirBuffer restored(1, 1, 1);
+    restored.restore(path);
+    ASSERT_EQ(restored.size(), buffer.size());
+    ASSERT_EQ(restored.count(), buffer.count());
+    ASSERT_EQ(restored.featureSize(), 2);
+    ASSERT_EQ(restored.precision(), ArenaPrecision::FP16);
+
+    std::vector<size_t> all(buffer.size());
+    for (size_t i = 0; i < all.size(); i++) all[i] = i;
+    std::vector<float> expected(all.size() * 2), actual(all.size() * 2), targets(all.size() * 2);
+    buffer.gather(all, expected.data(), targets.data());
+    restored.gather(all, actual.data(), targets.data());
+    ASSERT_EQ(expected, actual);
+
+    // The RNG state is restored, so both buffers make the same replacement decisions
+    for (int i = 200; i < 300; i++) {
+        buffer.add({static_cast<float>(i), 2.0f}, {0.5f}, 1.0f);
+        restored.add({static_cast<float>(i), 2.0f}, {0.5f}, 1.0f);
+    }
+    buffer.gather(all, expected.data(), targets.data());
+    restored.gather(all, actual.data(), targets.data());
+    ASSERT_EQ(expected, actual);
+
+    // Snapshotting back to the file the buffer is mapped from stays consistent
+    restored.snapshot(path);
+    FeatureReservoirBuffer reloaded(1, 1, 1);
+    reloaded.restore(path);
+    reloaded.gather(all, actual.data(), targets.data());
+    ASSERT_EQ(expected, actual);
+    std::remove(path.c_str());
+}
+
+TEST(FeatureReservoirBufferTest, ClonedSnapshotContinuesIncrementally) {
+    std::string first = ::testing::TempDir() + "feature_reservoir_first.bin";
+    std::string renamed = ::testing::TempDir() + "feature_reservoir_renamed.bin";
+    std::string second = ::testing::TempDir() + "feature_reservoir_second.bin";
+
+    FeatureReservoirBuffer buffer(32, 1, 1);
+    for (int i = 0; i < 100; i++) {
+        buffer.add({static_cast<float>(i)}, {0.0f}, 1.0f);
+    }
+    buffer.snapshot(first);
+    std::rename(first.c_str(), renamed.c_str());
+
+    // Only a file the buffer itself wrote can seed the next snapshot
+    FeatureReservoirBuffer other(32, 1, 1);
+    other.add({1.0f}, {0.0f}, 1.0f);
+    ASSERT_FALSE(other.cloneSnapshot(renamed, second));
+
+    for (int i = 100; i < 200; i++) {
+        buffer.add({static_cast<float>(i)}, {0.0f}, 1.0f);
+    }
+    ASSERT_TRUE(buffer.cloneSnapshot(renamed, second));
+    buffer.snapshot(second);
+
+    FeatureReservoirBuffer restored(1, 1, 1);
+    restored.restore(second);
+    std::vector<size_t> all(buffer.size());
+    for (size_t i = 0; i < all.size(); i++) all[i] = i;
+    std::vector<float> expected(all.size()), actual(all.size()), targets(all.size());
+    buffer.gather(all, expected.data(), targets.data());
+    restored.gather(all, actual.data(), targets.data());
+    ASSERT_EQ(expected, actual);
+
+    // The seeding file is left as it was
+    FeatureReservoirBuffer previous(1, 1, 1);
+    previous.restore(renamed);
+    ASSERT_EQ(previous.count(), 100);
+    std::remove(renamed.c_str());
+    std::remove(second.c_str());
+}
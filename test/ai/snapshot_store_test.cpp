@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <filesystem>
+#include "snapshot_store.hpp"
+
+namespace {
+
+std::vector<DenseLayer> randomNet(std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 0.5f);
+    std::vector<DenseLayer> layers = {{6, 8, std::vector<float>(48), std::vector<float>(8)},
+                                      {8, 3, std::vector<float>(24), std::vector<float>(3)}};
+    for (auto& layer : layers) {
+        for (float& w : layer.weight) w = dist(rng);
+        for (float& b : layer.bias) b = dist(rng);
+    }
+    return layers;
+}
+
+}  // namespace
+
+TEST(SnapshotStoreTest, PersistsAndSamplesByWeight) {
+    std::string directory = "/tmp/snapshot_store_test";
+    std::filesystem::remove_all(directory);
+    std::mt19937 rng(5);
+    std::vector<float> features = {1, 0, 0.5f, 0, 1, 0};
+
+    std::vector<std::vector<float>> outputs;
+    {
+        SnapshotStore store(directory);
+        for (int t = 1; t <= 3; t++) {
+            std::vector<DenseLayer> net = randomNet(rng);
+            outputs.push_back(FastMLP(net).predict(features));
+            store.add(t, 1, static_cast<float>(t), net);
+        }
+        EXPECT_EQ(store.size(0), 0u);
+        EXPECT_EQ(store.size(1), 3u);
+    }
+
+    // Reopening maps the indexed snapshots back
+    SnapshotStore store(directory);
+    ASSERT_EQ(store.size(1), 3u);
+    for (size_t s = 0; s < 3; s++) {
+        EXPECT_EQ(store.iteration(1, s), static_cast<int>(s + 1));
+        EXPECT_EQ(store.net(1, s).predict(features), outputs[s]);
+    }
+
+    // Weights 1:2:3 split [0, 1) into sixths
+    EXPECT_EQ(store.sample(1, 0.0f), 0u);
+    EXPECT_EQ(store.sample(1, 0.16f), 0u);
+    EXPECT_EQ(store.sample(1, 0.17f), 1u);
+    EXPECT_EQ(store.sample(1, 0.49f), 1u);
+    EXPECT_EQ(store.sample(1, 0.51f), 2u);
+    EXPECT_EQ(store.sample(1, 0.999f), 2u);
+    EXPECT_THROW(store.sample(0, 0.5f), std::out_of_range);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(SnapshotStoreTest, TruncateDropsLaterIterations) {
+    std::string directory = "/tmp/snapshot_store_truncate_test";
+    std::filesystem::remove_all(directory);
+    std::mt19937 rng(9);
+
+    {
+        SnapshotStore store(directory);
+        for (int t = 1; t <= 4; t++) {
+            store.add(t, 0, 1.0f, randomNet(rng));
+            store.add(t, 1, 1.0f, randomNet(rng));
+        }
+        store.truncate(2);
+        EXPECT_EQ(store.size(0), 2u);
+        EXPECT_EQ(store.size(1), 2u);
+        EXPECT_EQ(store.iteration(1, 1), 2);
+        EXPECT_EQ(store.sample(1, 0.999f), 1u);
+
+        // Training iteration 3 again replaces the orphaned file
+        store.add(3, 0, 1.0f, randomNet(rng));
+        EXPECT_EQ(store.size(0), 3u);
+    }
+
+    SnapshotStore store(directory);
+    EXPECT_EQ(store.size(0), 3u);
+    EXPECT_EQ(store.size(1), 2u);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "thread_pool.hpp"
+
+TEST(ThreadPoolTest, RunsEveryIndexExactlyOnce) {
+    ThreadPool pool(4);
+    for (size_t grain : {1, 7, 1000}) {
+        std::vector<std::atomic<int>> hits(1000);
+        std::atomic<bool> bad_worker{false};
+        pool.parallelFor(0, hits.size(), grain, [&](size_t i, size_t worker) {
+            hits[i].fetch_add(1);
+            if (worker >= pool.size()) bad_worker = true;
+        });
+        for (auto& h : hits) ASSERT_EQ(h.load(), 1);
+        ASSERT_FALSE(bad_worker.load());
+    }
+}
+
+TEST(ThreadPoolTest, PropagatesExceptionsAfterDraining) {
+    ThreadPool pool(3);
+    std::atomic<int> ran{0};
+    EXPECT_THROW(pool.parallelFor(0, 100, 5, [&](size_t i, size_t) {
+        ran++;
+        if (i == 42) throw std::runtime_error("boom");
+    }), std::runtime_error);
+    EXPECT_EQ(ran.load(), 100);
+
+    // The pool stays usable
+    std::atomic<int> again{0};
+    pool.parallelFor(0, 10, 1, [&](size_t, size_t) { again++; });
+    EXPECT_EQ(again.load(), 10);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "util/trace.hpp"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(TraceTest, ExportsSpansFromEveryThread) {
+    ASSERT_TRUE(Tracer::compiledIn());
+    Tracer::start(1024);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; t++) {
+        threads.emplace_back([t]() {
+            Tracer::setThreadName("worker " + std::to_string(t));
+            for (int i = 0; i < 10; i++) {
+                TRACE_SCOPE("outer");
+                TRACE_SCOPE("inner \"quoted\"");
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    Tracer::stop();
+    {
+        TRACE_SCOPE("after stop");
+    }
+
+    // Buffers of finished threads are still exported
+    std::string path = "/tmp/trace_test.json";
+    Tracer::writeChromeTrace(path);
+    std::string trace = readFile(path);
+    EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(countOf(trace, "\"name\":\"outer\""), 30u);
+    EXPECT_EQ(countOf(trace, "\"name\":\"inner \\\"quoted\\\"\""), 30u);
+    EXPECT_EQ(countOf(trace, "after stop"), 0u);
+    EXPECT_NE(trace.find("\"args\":{\"name\":\"worker 2\"}"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, RingKeepsTheNewestSpans) {
+    Tracer::start(4);
+    const char* names[] = {"s0", "s1", "s2", "s3", "s4", "s5"};
+    std::thread recorder([&]() {
+        for (const char* name : names) {
+            TraceSpan span(name);
+        }
+    });
+    recorder.join();
+    Tracer::stop();
+
+    std::string path = "/tmp/trace_ring_test.json";
+    Tracer::writeChromeTrace(path);
+    std::string trace = readFile(path);
+    EXPECT_EQ(trace.find("\"s1\""), std::string::npos);
+    EXPECT_NE(trace.find("\"s2\""), std::string::npos);
+    EXPECT_NE(trace.find("\"s5\""), std::string::npos);
+
+    // Oldest first within a thread
+    EXPECT_LT(trace.find("\"s2\""), trace.find("\"s5\""));
+    std::remove(path.c_str());
+}
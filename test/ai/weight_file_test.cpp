@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include "weight_file.hpp"
+#include "dense_layer_fixtures.hpp"
+
+TEST(WeightFileTest, MappedNetworkMatchesInMemoryNetwork) {
+    std::mt19937 rng(13);
+    std::vector<DenseLayer> layers = {randomLayer(500, 256, rng), randomLayer(256, 256, rng), randomLayer(256, 10, rng)};
+    std::string path = "/tmp/weight_file_test.bin";
+    writeWeightFile(path, layers);
+
+    FastMLP in_memory(layers);
+    FastMLP mapped = mapWeightFile(path);
+    ASSERT_EQ(mapped.inputSize(), 500);
+    ASSERT_EQ(mapped.outputSize(), 10);
+
+    std::vector<float> features(500, 0.0f);
+    for (int k = 0; k < 40; k++) features[rng() % 500] = 1.0f;
+    // Same packed bytes, same kernels: results are bit-identical
+    ASSERT_EQ(mapped.predict(features), in_memory.predict(features));
+
+    // Rewriting the file leaves an existing mapping intact
+    writeWeightFile(path, {randomLayer(500, 256, rng), randomLayer(256, 256, rng), randomLayer(256, 10, rng)});
+    ASSERT_EQ(mapped.predict(features), in_memory.predict(features));
+    std::remove(path.c_str());
+}
+
+TEST(WeightFileTest, RejectsCorruptFiles) {
+    std::mt19937 rng(17);
+    std::string path = "/tmp/weight_file_corrupt.bin";
+    writeWeightFile(path, {randomLayer(8, 4, rng)});
+
+    // Truncated
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_THROW(mapWeightFile(path), std::runtime_error);
+
+    // Wrong magic
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(8192, 'x');
+    EXPECT_THROW(mapWeightFile(path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -139,3 +139,33 @@ TEST_F(GameTest, ALL_IN_ACTION) {
     // ASSERT_TRUE(game->getPlayers()[3]->isAllIn());
 }
 
+
+TEST_F(GameTest, CopyIsIndependent) {
+    headsup_game->startHand(0);
+    Game copy = *headsup_game;
+    int player = copy.getCurrentPlayer();
+    int chips = headsup_game->getPlayers()[player]->getChips();
+    int pot = headsup_game->getPots().back()->get_total_amount();
+
+    copy.takeAction(Action(ActionType::RAISE, 40));
+    ASSERT_EQ(copy.getPlayers()[player]->getChips(), chips - 40);
+
+    // The original hand is untouched and plays on by itself
+    ASSERT_EQ(headsup_game->getCurrentPlayer(), player);
+    ASSERT_EQ(headsup_game->getPlayers()[player]->getChips(), chips);
+    ASSERT_EQ(headsup_game->getPots().back()->get_total_amount(), pot);
+    headsup_game->takeAction(Action(ActionType::CALL));
+    ASSERT_EQ(headsup_game->getPlayers()[player]->getChips(), chips - 5);
+    ASSERT_EQ(copy.getPlayers()[player]->getChips(), chips - 40);
+}
+
+TEST_F(GameTest, FoldingToOnePlayerEndsTheHand) {
+    game->startHand(0);
+    // Everyone folds to the big blind
+    for (int i = 0; i < 5; i++) {
+        ASSERT_FALSE(game->isHandComplete());
+        game->takeAction(Action(ActionType::FOLD));
+    }
+    ASSERT_TRUE(game->isHandComplete());
+    ASSERT_EQ(game->getPlayers()[2]->getChips(), 1005);
+}
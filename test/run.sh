@@ -9,4 +9,6 @@
 # ./build/dcgan
 cmake -B build 
 cmake --build build
-./build/engine_tests
\ No newline at end of file
+./build/engine_tests
+./build/deep_cfr_tests
+./build/mccfr_tests
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "feature_reservoir_buffer.hpp"
+#include "concurrent_reservoir_buffer.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures insert throughput of the reservoir buffers under contention from
+// many traversal-like writer threads, with a learner thread sampling batches.
+//
+// Usage: reservoir_contention [max_threads] [adds_per_thread] [capacity]
+
+namespace {
+
+const size_t FEATURE_SIZE = 500;
+const size_t TARGET_SIZE = 10;
+const size_t BATCH_SIZE = 128;
+
+// Baseline: the single-threaded buffer behind one global lock
+class LockedBuffer {
+public:
+    explicit LockedBuffer(size_t capacity) : buffer_(capacity, FEATURE_SIZE, TARGET_SIZE) {}
+
+    void add(const float* features, const float* targets, size_t num_targets, float weight) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.add(features, targets, num_targets, weight);
+    }
+
+    size_t sample(size_t batch_size, float* features_out, float* targets_out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return buffer_.sample(batch_size, features_out, targets_out, nullptr);
+    }
+
+private:
+    std::mutex mutex_;
+    FeatureReservoirBuffer buffer_;
+};
+
+template <typename Buffer>
+double run(Buffer& buffer, int num_threads, size_t adds_per_thread) {
+    std::atomic<bool> done(false);
+    std::atomic<size_t> batches(0);
+
+    // Learner thread sampling concurrently, as in the pipelined trainer
+    std::thread learner([&]() {
+        std::vector<float> features(BATCH_SIZE * FEATURE_SIZE);
+        std::vector<float> targets(BATCH_SIZE * TARGET_SIZE);
+        while (!done.load(std::memory_order_relaxed)) {
+            buffer.sample(BATCH_SIZE, features.data(), targets.data());
+            batches++;
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> writers;
+    for (int t = 0; t < num_threads; t++) {
+        writers.emplace_back([&, t]() {
+            std::vector<float> features(FEATURE_SIZE, static_cast<float>(t));
+            std::vector<float> targets(6, 0.5f);
+            for (size_t i = 0; i < adds_per_thread; i++) {
+                features[0] = static_cast<float>(i);
+                buffer.add(features.data(), targets.data(), targets.size(), 1.0f);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    done = true;
+    learner.join();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(adds_per_thread) * num_threads / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int max_threads = argc > 1 ? std::stoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    size_t adds_per_thread = argc > 2 ? std::stoull(argv[2]) : 200000;
+    size_t capacity = argc > 3 ? std::stoull(argv[3]) : 100000;
+
+    std::cout << "Reservoir insert throughput (adds/sec), capacity " << capacity
+              << ", " << adds_per_thread << " adds per thread" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "global lock"
+              << std::setw(16) << "concurrent" << std::setw(10) << "speedup" << std::endl;
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        LockedBuffer locked(capacity);
+        ConcurrentReservoirBuffer concurrent(capacity, FEATURE_SIZE, TARGET_SIZE);
+
+        double locked_rate = run(locked, threads, adds_per_thread);
+        double concurrent_rate = run(concurrent, threads, adds_per_thread);
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(0) << locked_rate
+                  << std::setw(16) << concurrent_rate
+                  << std::setw(9) << std::setprecision(2) << concurrent_rate / locked_rate << "x" << std::endl;
+        if (threads == max_threads) break;
+        if (threads * 2 > max_threads) threads = max_threads / 2;
+    }
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "../include/poker_server.h"
 #include <iostream>
 #include <signal.h>
+#include "util/trace.hpp"
 
 using namespace poker;
 
@@ -33,9 +34,20 @@ int main(int argc, char* argv[]) {
     if (argc > 4) {
         startingChips = std::stoi(argv[4]);
     }
+    // Optional Chrome trace of message handling, written when the server stops
+    std::string tracePath;
+    if (argc > 5) {
+        tracePath = argv[5];
+    }
     
     // Create and start the poker server
     PokerServer server(port, minPlayers, maxPlayers, startingChips);
+    if (!tracePath.empty()) {
+        if (!Tracer::compiledIn()) {
+            std::cout << "Tracing is compiled out; rebuild with -DPOKERAI_ENABLE_TRACING=ON to record spans" << std::endl;
+        }
+        server.enableTracing(tracePath);
+    }
     
     if (!server.start()) {
         std::cerr << "Failed to start poker server" << std::endl;
@@ -0,0 +1,87 @@
+#include "mccfr_solver.hpp"
+#include "mapped_info_set_table.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Tabular external-sampling MCCFR blueprint training.
+//
+// Usage: mccfr [--iterations N] [--players N] [--threads N] [--capacity INFO_SETS]
+//              [--buckets N] [--samples N] [--interval N] [--linear-until N] [--seed S]
+//              [--table PATH]
+//        mccfr --table PATH --grow INFO_SETS
+//        mccfr --table PATH --compact
+//
+// With --table, regrets live in a memory-mapped file and rerunning resumes training from it.
+// --grow and --compact rebuild such a file offline, with more slots or without the info
+// sets that never accumulated anything.
+
+int main(int argc, char** argv) {
+    try {
+        MCCFRConfig config;
+        int iterations = 100000;
+        size_t grow = 0;
+        bool compact = false;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--iterations" && i + 1 < argc) {
+                iterations = std::stoi(argv[++i]);
+            } else if (arg == "--players" && i + 1 < argc) {
+                config.num_players = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                config.threads = std::stoul(argv[++i]);
+            } else if (arg == "--capacity" && i + 1 < argc) {
+                config.table_capacity = std::stoull(argv[++i]);
+            } else if (arg == "--buckets" && i + 1 < argc) {
+                config.postflop_buckets = std::stoi(argv[++i]);
+            } else if (arg == "--samples" && i + 1 < argc) {
+                config.strength_samples = std::stoi(argv[++i]);
+            } else if (arg == "--interval" && i + 1 < argc) {
+                config.discount_interval = std::stoi(argv[++i]);
+            } else if (arg == "--linear-until" && i + 1 < argc) {
+                config.linear_until = std::stoi(argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                config.seed = std::stoull(argv[++i]);
+            } else if (arg == "--table" && i + 1 < argc) {
+                config.table_path = argv[++i];
+            } else if (arg == "--grow" && i + 1 < argc) {
+                grow = std::stoull(argv[++i]);
+            } else if (arg == "--compact") {
+                compact = true;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return 1;
+            }
+        }
+
+        if (grow > 0 || compact) {
+            if (config.table_path.empty()) {
+                std::cerr << "--grow and --compact need --table" << std::endl;
+                return 1;
+            }
+            auto stats = MappedInfoSetTable::rebuild(config.table_path, config.table_path, grow, compact);
+            std::cout << "Rebuilt " << config.table_path << ": " << stats.kept << " info sets kept, " << stats.dropped
+                      << " dropped, " << stats.capacity << " slots" << std::endl;
+            return 0;
+        }
+
+        MCCFRSolver solver(config);
+        if (solver.iterations() > 0) {
+            std::cout << "Resuming from " << config.table_path << " after " << solver.iterations() << " iterations"
+                      << std::endl;
+        }
+        std::cout << "Training " << config.num_players << "-player MCCFR for " << iterations << " iterations ("
+                  << solver.table().capacity() << " info-set slots)" << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        solver.train(iterations);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Done: " << static_cast<long long>(seconds > 0.0 ? iterations / seconds : 0.0)
+                  << " iterations/sec overall, " << solver.table().size() << " info sets" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "tournament.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Round-robin tournament between saved heads-up models, e.g. every models/iter_N, to see
+// where training plateaus.
+//
+// Usage: tournament [--deals N] [--tables N] [--threads N] [--seed S] [--csv PATH] MODEL_DIR...
+
+int main(int argc, char** argv) {
+    try {
+        TournamentConfig config;
+        std::string csv_path;
+        std::vector<std::string> models;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--deals" && i + 1 < argc) {
+                config.deals = std::stoi(argv[++i]);
+            } else if (arg == "--tables" && i + 1 < argc) {
+                config.tables = std::stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                config.threads = std::stoul(argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                config.seed = std::stoull(argv[++i]);
+            } else if (arg == "--csv" && i + 1 < argc) {
+                csv_path = argv[++i];
+            } else {
+                models.push_back(arg);
+            }
+        }
+        if (models.size() < 2) {
+            std::cerr << "Usage: tournament [--deals N] [--tables N] [--threads N] [--seed S] [--csv PATH] MODEL_DIR..."
+                      << std::endl;
+            return 1;
+        }
+
+        Tournament tournament(models, config);
+        size_t pairs = models.size() * (models.size() - 1) / 2;
+        std::cout << "Playing " << pairs << " pairs x " << 2 * config.deals << " hands on " << config.tables
+                  << " tables each..." << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        TournamentResult result = tournament.run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << result.toString();
+        std::cout << static_cast<long long>(seconds > 0.0 ? pairs * 2.0 * config.deals / seconds : 0.0)
+                  << " hands/sec" << std::endl;
+        if (!csv_path.empty()) {
+            std::ofstream(csv_path) << result.toCsv();
+            std::cout << "Wrote matrix to " << csv_path << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include "engine.hpp"
 #include "deep_cfr.hpp"
 #include "deep_cfr_player.hpp"
+#include "lbr.hpp"
+#include "duplicate_match.hpp"
+#include "util/trace.hpp"
 #include <memory>
 #include <iostream>
 #include <chrono>
@@ -41,6 +44,40 @@ int main(int argc, char** argv) {
         int big_blind = 20;
         int num_hands = 10;
         std::string model_path = "models/latest";
+        ArenaPrecision buffer_precision = ArenaPrecision::FP32;
+        std::string buffer_dir;
+        size_t buffer_capacity = 1000000;
+        bool weighted_reservoir = false;
+        bool concurrent_buffers = false;
+        std::string buffer_snapshot_dir;
+        bool fast_inference = false;
+        size_t inference_batch = 0;
+        std::string quantize;
+        bool quantized_model = false;
+        int train_steps = 1;
+        bool flat_model = false;
+        size_t num_threads = 1;
+        bool fixed_seed = false;
+        uint64_t seed = 0;
+        bool prune = false;
+        float prune_threshold = -0.05f;
+        float prune_probability = 0.95f;
+        int prune_start = 10;
+        TraversalScheme traversal_scheme = TraversalScheme::EXTERNAL;
+        size_t robust_actions = 2;
+        float exploration = 0.6f;
+        bool pipelined = false;
+        std::string sd_cfr_dir;
+        std::string learner_endpoint;
+        std::string worker_endpoint;
+        std::string checkpoint_dir;
+        bool resume = false;
+        std::string metrics_path;
+        std::string trace_path;
+        int lbr_hands = 0;
+        int lbr_runouts = 32;
+        std::string match_model;
+        int match_deals = 10000;
         
         std::cout << "Parsing command line arguments..." << std::endl;
         for (int i = 1; i < argc; i++) {
@@ -69,6 +106,115 @@ int main(int argc, char** argv) {
             } else if (arg == "--hands" && i + 1 < argc) {
                 num_hands = std::stoi(argv[++i]);
                 std::cout << "  Number of hands to play: " << num_hands << std::endl;
+            } else if (arg == "--fp16-buffers") {
+                buffer_precision = ArenaPrecision::FP16;
+                std::cout << "  Storing reservoir samples in fp16" << std::endl;
+            } else if (arg == "--buffer-dir" && i + 1 < argc) {
+                buffer_dir = argv[++i];
+                std::cout << "  Disk-backed reservoir buffers in: " << buffer_dir << std::endl;
+            } else if (arg == "--buffer-capacity" && i + 1 < argc) {
+                buffer_capacity = std::stoull(argv[++i]);
+                std::cout << "  Disk buffer capacity: " << buffer_capacity << std::endl;
+            } else if (arg == "--weighted-reservoir") {
+                weighted_reservoir = true;
+                std::cout << "  Weighted (A-Res) strategy reservoir enabled" << std::endl;
+            } else if (arg == "--concurrent-buffers") {
+                concurrent_buffers = true;
+                std::cout << "  Lock-free reservoir buffers enabled" << std::endl;
+            } else if (arg == "--buffer-snapshots" && i + 1 < argc) {
+                buffer_snapshot_dir = argv[++i];
+                std::cout << "  Reservoir buffer snapshots in: " << buffer_snapshot_dir << std::endl;
+            } else if (arg == "--fast-inference") {
+                fast_inference = true;
+                std::cout << "  SIMD CPU inference enabled" << std::endl;
+            } else if (arg == "--batched-inference" && i + 1 < argc) {
+                inference_batch = std::stoul(argv[++i]);
+                std::cout << "  Batched traversal inference, up to " << inference_batch << " rows" << std::endl;
+            } else if (arg == "--train-steps" && i + 1 < argc) {
+                train_steps = std::stoi(argv[++i]);
+                std::cout << "  SGD steps per network update: " << train_steps << std::endl;
+            } else if (arg == "--threads" && i + 1 < argc) {
+                num_threads = std::stoul(argv[++i]);
+                std::cout << "  Traversal threads: " << num_threads << std::endl;
+            } else if (arg == "--seed" && i + 1 < argc) {
+                fixed_seed = true;
+                seed = std::stoull(argv[++i]);
+                std::cout << "  Seed: " << seed << std::endl;
+            } else if (arg == "--prune") {
+                prune = true;
+                std::cout << "  Regret-based pruning enabled" << std::endl;
+            } else if (arg == "--prune-threshold" && i + 1 < argc) {
+                prune_threshold = std::stof(argv[++i]);
+                std::cout << "  Pruning threshold: " << prune_threshold << std::endl;
+            } else if (arg == "--prune-probability" && i + 1 < argc) {
+                prune_probability = std::stof(argv[++i]);
+                std::cout << "  Pruning probability: " << prune_probability << std::endl;
+            } else if (arg == "--prune-start" && i + 1 < argc) {
+                prune_start = std::stoi(argv[++i]);
+                std::cout << "  Pruning from iteration: " << prune_start << std::endl;
+            } else if (arg == "--traversal" && i + 1 < argc) {
+                std::string scheme = argv[++i];
+                if (scheme == "external") {
+                    traversal_scheme = TraversalScheme::EXTERNAL;
+                } else if (scheme == "outcome") {
+                    traversal_scheme = TraversalScheme::OUTCOME;
+                } else if (scheme == "robust") {
+                    traversal_scheme = TraversalScheme::ROBUST;
+                } else {
+                    throw std::invalid_argument("--traversal expects external, outcome or robust");
+                }
+                std::cout << "  Traversal scheme: " << scheme << std::endl;
+            } else if (arg == "--robust-actions" && i + 1 < argc) {
+                robust_actions = std::stoul(argv[++i]);
+                std::cout << "  Robust sampling actions: " << robust_actions << std::endl;
+            } else if (arg == "--exploration" && i + 1 < argc) {
+                exploration = std::stof(argv[++i]);
+                std::cout << "  Outcome sampling exploration: " << exploration << std::endl;
+            } else if (arg == "--pipelined") {
+                pipelined = true;
+                std::cout << "  Pipelined actor-learner training enabled" << std::endl;
+            } else if (arg == "--sd-cfr" && i + 1 < argc) {
+                sd_cfr_dir = argv[++i];
+                std::cout << "  Single Deep CFR snapshots in: " << sd_cfr_dir << std::endl;
+            } else if (arg == "--checkpoint" && i + 1 < argc) {
+                checkpoint_dir = argv[++i];
+                std::cout << "  Checkpoint directory: " << checkpoint_dir << std::endl;
+            } else if (arg == "--resume") {
+                resume = true;
+                std::cout << "  Resuming from the latest checkpoint" << std::endl;
+            } else if (arg == "--metrics" && i + 1 < argc) {
+                metrics_path = argv[++i];
+                std::cout << "  Metrics log: " << metrics_path << std::endl;
+            } else if (arg == "--trace" && i + 1 < argc) {
+                trace_path = argv[++i];
+                std::cout << "  Chrome trace: " << trace_path << std::endl;
+            } else if (arg == "--lbr" && i + 1 < argc) {
+                lbr_hands = std::stoi(argv[++i]);
+                std::cout << "  Local best response hands: " << lbr_hands << std::endl;
+            } else if (arg == "--lbr-runouts" && i + 1 < argc) {
+                lbr_runouts = std::stoi(argv[++i]);
+                std::cout << "  LBR equity runouts: " << lbr_runouts << std::endl;
+            } else if (arg == "--match" && i + 1 < argc) {
+                match_model = argv[++i];
+                std::cout << "  Duplicate match against: " << match_model << std::endl;
+            } else if (arg == "--deals" && i + 1 < argc) {
+                match_deals = std::stoi(argv[++i]);
+                std::cout << "  Duplicate deals: " << match_deals << std::endl;
+            } else if (arg == "--learner" && i + 1 < argc) {
+                learner_endpoint = argv[++i];
+                std::cout << "  Distributed learner on: " << learner_endpoint << std::endl;
+            } else if (arg == "--worker" && i + 1 < argc) {
+                worker_endpoint = argv[++i];
+                std::cout << "  Distributed worker for learner at: " << worker_endpoint << std::endl;
+            } else if (arg == "--flat-model") {
+                flat_model = true;
+                std::cout << "  Serving the model from mapped flat weight files" << std::endl;
+            } else if (arg == "--quantize" && i + 1 < argc) {
+                quantize = argv[++i];
+                std::cout << "  Quantized strategy network for play: " << quantize << std::endl;
+            } else if (arg == "--quantized-model") {
+                quantized_model = true;
+                std::cout << "  Playing with the saved quantized strategy network" << std::endl;
             } else if (arg == "--model" && i + 1 < argc) {
                 model_path = argv[++i];
                 std::cout << "  Model path: " << model_path << std::endl;
@@ -81,42 +227,167 @@ int main(int argc, char** argv) {
         std::cout << "Creating Deep CFR agent..." << std::endl;
         
         // Create Deep CFR agent
-        auto deep_cfr = std::make_shared<DeepCFR>(num_players, num_traversals);
+        auto deep_cfr = std::make_shared<DeepCFR>(num_players, num_traversals, 2.0f, MAX_ACTIONS, buffer_precision);
+        if (fixed_seed) {
+            deep_cfr->setSeed(seed);
+        }
+        if (!buffer_dir.empty()) {
+            if (!checkpoint_dir.empty()) {
+                throw std::invalid_argument("--checkpoint cannot roll back --buffer-dir buffers; "
+                                            "use in-memory buffers to checkpoint");
+            }
+            deep_cfr->useDiskBuffers(buffer_dir, buffer_capacity);
+        }
+        if (weighted_reservoir) {
+            deep_cfr->useWeightedStrategyReservoir();
+        }
+        if (concurrent_buffers) {
+            if (!buffer_dir.empty() || weighted_reservoir || !buffer_snapshot_dir.empty() || !checkpoint_dir.empty()) {
+                throw std::invalid_argument("--concurrent-buffers cannot be combined with --buffer-dir, "
+                                            "--weighted-reservoir, --buffer-snapshots or --checkpoint");
+            }
+            deep_cfr->useConcurrentBuffers(buffer_capacity);
+        }
+        if (!buffer_snapshot_dir.empty()) {
+            deep_cfr->loadBuffers(buffer_snapshot_dir);
+        }
+        if (fast_inference) {
+            deep_cfr->useFastInference();
+        }
+        if (inference_batch > 0) {
+            deep_cfr->useBatchedInference(inference_batch);
+        }
+        deep_cfr->setTrainingSteps(train_steps);
+        deep_cfr->setNumThreads(num_threads);
+        if (!sd_cfr_dir.empty()) {
+            deep_cfr->useSingleDeepCFR(sd_cfr_dir);
+        }
+        deep_cfr->setTraversalScheme(traversal_scheme, robust_actions, exploration);
+        if (prune) {
+            deep_cfr->enablePruning(prune_threshold, prune_probability, prune_start);
+        }
         
+        // Spans of the whole run, dumped whichever way main leaves this block (the newest per
+        // thread if rings wrap), so evaluation modes that return early are covered too
+        if (!trace_path.empty()) {
+            if (!Tracer::compiledIn()) {
+                std::cout << "Tracing is compiled out; rebuild with -DPOKERAI_ENABLE_TRACING=ON for --trace" << std::endl;
+            }
+            Tracer::setThreadName("main");
+            Tracer::start();
+        }
+        struct TraceDump {
+            std::string path;
+            ~TraceDump() {
+                if (path.empty()) return;
+                Tracer::stop();
+                try {
+                    Tracer::writeChromeTrace(path);
+                    std::cout << "Wrote trace to " << path << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                }
+            }
+        } trace_dump{trace_path};
+
+        // Workers only traverse; the learner trains and saves the model
+        if (!worker_endpoint.empty()) {
+            printSeparator();
+            deep_cfr->runWorker(worker_endpoint);
+            return 0;
+        }
+
         // Train or load the model
-        if (train_mode) {
+        if (train_mode && !learner_endpoint.empty()) {
+            printSeparator();
+            std::cout << "Training Deep CFR for " << num_iterations << " iterations with distributed workers..." << std::endl;
+            printSeparator();
+
+            auto start_time = std::chrono::high_resolution_clock::now();
+            deep_cfr->runLearner(learner_endpoint, num_iterations, 128, 128);
+            auto duration = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - start_time);
+
+            printSeparator();
+            std::cout << "Training completed in " << formatDuration(duration) << std::endl;
+            std::cout << "Saving final model to " << model_path << std::endl;
+            deep_cfr->saveModels(model_path);
+            printSeparator();
+        } else if (train_mode) {
+            // --iterations is the total for the run, so a resumed run trains only what is left
+            int start_iteration = 0;
+            if (resume) {
+                if (checkpoint_dir.empty()) {
+                    throw std::invalid_argument("--resume needs --checkpoint DIR");
+                }
+                if (deep_cfr->loadCheckpoint(checkpoint_dir)) {
+                    start_iteration = deep_cfr->completedIterations();
+                } else {
+                    std::cout << "No checkpoint in " << checkpoint_dir << " yet, starting from scratch" << std::endl;
+                }
+            }
+
             printSeparator();
-            std::cout << "Training Deep CFR for " << num_iterations << " iterations..." << std::endl;
+            std::cout << "Training Deep CFR for iterations " << start_iteration + 1 << " to " << num_iterations << "..." << std::endl;
             printSeparator();
             
+            // Per-iteration JSONL records, with a summary table every 10 iterations
+            std::unique_ptr<MetricsLog> metrics_log;
+            MetricsCounts previous_metrics;
+            if (!metrics_path.empty()) {
+                deep_cfr->enableMetrics();
+                metrics_log = std::make_unique<MetricsLog>(metrics_path);
+            }
+
             auto start_time = std::chrono::high_resolution_clock::now();
             
             // Train with progress updates
-            for (int iter = 0; iter < num_iterations; iter++) {
+            for (int iter = start_iteration; iter < num_iterations; iter++) {
                 auto iter_start = std::chrono::high_resolution_clock::now();
                 
                 std::cout << "Iteration " << iter + 1 << "/" << num_iterations << std::endl;
                 
                 // Perform one iteration of training
-                deep_cfr->train(1, 128, 128);
+                if (pipelined) {
+                    deep_cfr->trainPipelined(1, 128, 128);
+                } else {
+                    deep_cfr->train(1, 128, 128);
+                }
                 
                 auto iter_end = std::chrono::high_resolution_clock::now();
                 auto iter_duration = std::chrono::duration_cast<std::chrono::seconds>(iter_end - iter_start);
                 
                 // Calculate ETA
                 auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(iter_end - start_time);
-                auto avg_iter_time = elapsed.count() / (iter + 1);
+                auto avg_iter_time = elapsed.count() / (iter - start_iteration + 1);
                 auto remaining = std::chrono::seconds(avg_iter_time * (num_iterations - iter - 1));
                 
                 std::cout << "  Iteration completed in " << formatDuration(iter_duration) << std::endl;
                 std::cout << "  Elapsed time: " << formatDuration(elapsed) << std::endl;
                 std::cout << "  Estimated time remaining: " << formatDuration(remaining) << std::endl;
+
+                if (metrics_log) {
+                    MetricsCounts total = deep_cfr->metrics();
+                    double iter_seconds = std::chrono::duration<double>(iter_end - iter_start).count();
+                    metrics_log->write(iter + 1, iter_seconds, total - previous_metrics);
+                    previous_metrics = total;
+                    if ((iter + 1) % 10 == 0 || iter == num_iterations - 1) {
+                        double elapsed_seconds = std::chrono::duration<double>(iter_end - start_time).count();
+                        std::cout << "Metrics since iteration " << start_iteration + 1 << ":" << std::endl
+                                  << formatMetricsTable(total, elapsed_seconds);
+                    }
+                }
                 printSeparator();
                 
                 // Save model periodically
                 if ((iter + 1) % 10 == 0 || iter == num_iterations - 1) {
                     std::cout << "Saving model checkpoint to models/iter_" << (iter + 1) << std::endl;
                     deep_cfr->saveModels("models/iter_" + std::to_string(iter + 1));
+                    if (!buffer_snapshot_dir.empty()) {
+                        deep_cfr->saveBuffers(buffer_snapshot_dir);
+                    }
+                    if (!checkpoint_dir.empty()) {
+                        deep_cfr->saveCheckpoint(checkpoint_dir);
+                    }
                 }
             }
             
@@ -133,9 +404,70 @@ int main(int argc, char** argv) {
         } else {
             // Load the model
             printSeparator();
-            std::cout << "Loading model from " << model_path << std::endl;
-            deep_cfr->loadModels(model_path);
+            if (!sd_cfr_dir.empty()) {
+                std::cout << "Playing from SD-CFR snapshots in " << sd_cfr_dir << std::endl;
+            } else if (flat_model) {
+                std::cout << "Loading model from " << model_path << std::endl;
+                deep_cfr->loadFastModels(model_path);
+            } else {
+                std::cout << "Loading model from " << model_path << std::endl;
+                deep_cfr->loadModels(model_path);
+            }
+            printSeparator();
+        }
+
+        // Quantize for play, calibrating on the strategy buffer (restore it with --buffer-snapshots)
+        if (!quantize.empty()) {
+            if (quantize != "int8" && quantize != "fp16") {
+                throw std::invalid_argument("--quantize expects int8 or fp16");
+            }
+            deep_cfr->quantizeStrategyNet(quantize == "int8" ? QuantizedMLP::Precision::INT8
+                                                             : QuantizedMLP::Precision::FP16);
+            deep_cfr->saveQuantizedStrategyNet(model_path);
+            std::cout << "Saved quantized strategy network to " << model_path << "/strategy_net.qnet" << std::endl;
+            printSeparator();
+        } else if (quantized_model) {
+            // Written by an earlier --quantize run; needs no strategy buffer to calibrate on
+            deep_cfr->loadQuantizedStrategyNet(model_path);
+            std::cout << "Loaded quantized strategy network from " << model_path << std::endl;
+            printSeparator();
+        }
+
+        // Exploitability instead of self-play (heads-up models only)
+        if (lbr_hands > 0) {
+            LbrConfig config;
+            config.hands = lbr_hands;
+            config.starting_chips = starting_chips;
+            config.small_blind = small_blind;
+            config.big_blind = big_blind;
+            config.runouts = lbr_runouts;
+            config.seed = seed;
+            config.threads = num_threads;
+            std::cout << "Evaluating local best response over " << lbr_hands << " hands..." << std::endl;
+            LocalBestResponse(*deep_cfr, config).evaluate();
+            printSeparator();
+            return 0;
+        }
+
+        // Head-to-head against another model, reported as this model's win rate
+        if (!match_model.empty()) {
+            DeepCFR opponent(num_players, num_traversals, 2.0f, MAX_ACTIONS, buffer_precision);
+            if (flat_model) {
+                opponent.loadFastModels(match_model);
+            } else {
+                opponent.loadModels(match_model);
+            }
+            MatchConfig config;
+            config.deals = match_deals;
+            config.starting_chips = starting_chips;
+            config.small_blind = small_blind;
+            config.big_blind = big_blind;
+            config.seed = seed;
+            config.threads = num_threads;
+            std::cout << "Playing " << match_deals << " duplicate deals against " << match_model << "..." << std::endl;
+            DuplicateMatch(*deep_cfr, opponent, config).run();
             printSeparator();
+            return 0;
         }
         
         // Create a game with the specified number of players and settings